@@ -94,6 +94,9 @@ struct CameraDesc {
   float w, h, fov;
   float zNear, zFar;
   uint frame;
+  mat4 unjitteredProjView;
+  mat4 prevProjView;
+  vec2 jitter;
 };
 
 struct Transform {
@@ -133,7 +136,19 @@ struct VkDrawIndexedIndirectCommand {
 
 struct Frustum {
   vec4 planes[6];
+  vec3 eye;
+  float pixelScale;
+  float minPixels;
+  float maxDistance;
+  uint perspective;
+  uint casters;
+  uint mergeInto;
 };
+// values of Frustum.casters, see FrustumCasters.
+const uint FrustumCasters_All = 0;
+const uint FrustumCasters_Static = 1;
+const uint FrustumCasters_Dynamic = 2;
+const uint FrustumCasters_None = 3;
 
 bool isInFrustum(Frustum frustum, vec4 p, float radius) {
   p /= p.w;
@@ -0,0 +1,108 @@
+#ifndef VKG_CULL_DRAW_GROUP_H
+#define VKG_CULL_DRAW_GROUP_H
+
+#include "cull_draw_resources.h"
+#ifdef USE_HIZ
+  #include "hiz.h"
+
+// depth pyramid of an earlier frame in the first phase, and of this frame's depth prepass in the
+// second. Tested for the first frustum only.
+layout(set = 1, binding = 0) uniform sampler2D pyramid;
+// per instance, 1 if the first phase rejected it. The second phase re-tests and clears it.
+layout(set = 1, binding = 1, scalar) buffer RejectedBuf { uint rejected[]; };
+#endif
+
+void main() {
+  uint NX = gl_NumWorkGroups.x * gl_WorkGroupSize.x;
+  uint NY = gl_NumWorkGroups.y * gl_WorkGroupSize.y;
+  uint dispatchId = gl_GlobalInvocationID.z * (NX * NY) + gl_GlobalInvocationID.y * NX +
+                    gl_GlobalInvocationID.x;
+  uint id = dispatchId % totalMeshInstances;
+  uint frustumIdx = dispatchId / totalMeshInstances;
+  if(frustumIdx >= totalFrustums) return;
+#ifdef HIZ_RETEST
+  if(frustumIdx != 0 || rejected[id] == 0) return;
+  rejected[id] = 0;
+#endif
+  Frustum frustum = frustums[frustumIdx];
+
+  MeshInstanceDesc mesh = meshInstances[id];
+
+  if(
+    !mesh.visible || mesh.shadeModel == ShadingModelUnknown ||
+    !allowedGroup[mesh.shadeModel])
+    return;
+  if(frustum.casters != FrustumCasters_All) {
+    bool dynamic = mesh.instance.count > 1 || mesh.primitive.count > 1;
+    if(
+      frustum.casters == FrustumCasters_None ||
+      dynamic != (frustum.casters == FrustumCasters_Dynamic))
+      return;
+  }
+
+  uint primIdx = frameRef(mesh.primitive, frame);
+  PrimitiveDesc prim = primitives[primIdx];
+  AABB aabb = prim.aabb;
+  mat4 model = matrices[id];
+  transformAABB(aabb, model);
+  vec3 center = (aabb.min + aabb.max) / 2;
+  float radius = length(aabb.max - aabb.min) / 2;
+  if(
+    !isInFrustum(frustum, vec4(center, 1), 0) &&
+    !isInFrustum(frustum, vec4(center, 1), radius))
+    return;
+  float dist = distance(center, frustum.eye);
+  if(frustum.maxDistance > 0 && dist - radius > frustum.maxDistance) return;
+  if(frustum.minPixels > 0 && dist > radius) {
+    float pixels = 2 * radius * frustum.pixelScale / (frustum.perspective != 0 ? dist : 1);
+    if(pixels < frustum.minPixels) return;
+  }
+
+  uint shadeModelID = mesh.shadeModel;
+#ifdef USE_HIZ
+  if(frustumIdx == 0) {
+  #ifdef HIZ_RETEST
+    // without a pyramid of this frame every rejected instance is drawn.
+    if(
+      pyramidLevels > 0 &&
+      isOccluded(pyramid, pyramidSize, pyramidLevels, pyramidViewProj, aabb)) {
+      atomicAdd(drawCMDCount[(totalFrustums + frustumIdx) * groupStride + shadeModelID], 1);
+      return;
+    }
+  #else
+    if(isOccluded(pyramid, pyramidSize, pyramidLevels, pyramidViewProj, aabb)) {
+      rejected[id] = 1;
+      return;
+    }
+  #endif
+  }
+#endif
+
+  // merged frustums draw the instance once for all of them, the first one seeing it emits it.
+  if(frustum.mergeInto != nullIdx) {
+    uint viewBit = 1u << (frustumIdx - frustum.mergeInto);
+    uint views = atomicOr(viewMasks[frustum.mergeInto * totalMeshInstances + id], viewBit);
+    if(views != 0) return;
+    frustumIdx = frustum.mergeInto;
+  }
+
+  uint bucketIdx = frustumIdx * bucketStride + primIdx;
+  uint claimed = atomicCompSwap(buckets[bucketIdx].shadeModel, 0, shadeModelID + 1);
+  if(claimed == 0) {
+    uint entry = atomicAdd(activeCount, 1);
+    activeBuckets[entry].x = bucketIdx;
+    buckets[bucketIdx].entry = entry;
+    if(entry % cullMergeGroupSize == 0) atomicAdd(mergeDispatch.x, 1);
+  }
+  if(claimed == 0 || claimed == shadeModelID + 1) {
+    visibleSlots[dispatchId] = atomicAdd(buckets[bucketIdx].count, 1);
+    return;
+  }
+
+  // the primitive is drawn with another shade model, draw this instance on its own.
+  uint slot = atomicAdd(instanceCounts[frustumIdx], 1);
+  instanceIds[frustumIdx * cmdFrustumStride + slot] = id;
+  emitDraw(frustumIdx, shadeModelID, prim, frustumIdx * cmdFrustumStride + slot, 1);
+}
+
+#endif //VKG_CULL_DRAW_GROUP_H
@@ -0,0 +1,87 @@
+#ifndef VKG_CULL_DRAW_RESOURCES_H
+#define VKG_CULL_DRAW_RESOURCES_H
+
+#include "../common.h"
+layout(constant_id = 0) const uint lx = 1;
+layout(constant_id = 1) const uint ly = 1;
+layout(constant_id = 2) const uint lz = 1;
+layout(local_size_x_id = 0, local_size_y_id = 1, local_size_z_id = 2) in;
+
+layout(push_constant) uniform PushConstant {
+  uint totalFrustums;
+  uint totalMeshInstances;
+  uint cmdFrustumStride;
+  uint groupStride;
+  uint frame;
+  uint pyramidLevels;
+  uvec2 pyramidSize;
+  mat4 pyramidViewProj;
+  uint bucketStride;
+};
+
+layout(set = 0, binding = 0, scalar) buffer Frustums { Frustum frustums[]; };
+layout(set = 0, binding = 1, scalar) readonly buffer MeshesBuf {
+  MeshInstanceDesc meshInstances[];
+};
+layout(set = 0, binding = 2, scalar) readonly buffer PrimitiveBuf {
+  PrimitiveDesc primitives[];
+};
+layout(set = 0, binding = 3, std430) readonly buffer TransformBuffer { mat4 matrices[]; };
+layout(set = 0, binding = 4, scalar) buffer DrawIndirectCMDBuffer {
+  VkDrawIndexedIndirectCommand drawCMDs[];
+};
+layout(set = 0, binding = 5, scalar) readonly buffer DrawGroupOffsetBuffer {
+  uint cmdOffsetPerGroup[];
+};
+// draw counts of every frustum followed by the occluded counts of every frustum.
+layout(set = 0, binding = 6, scalar) buffer DrawCountBuffer { uint drawCMDCount[]; };
+layout(set = 0, binding = 7, scalar) buffer AllowedGroupBuf { bool allowedGroup[]; };
+
+// Visible instances are bucketed by (frustum, primitive) so all instances of a primitive are
+// drawn by one command. shadeModel is 0 while the bucket is unclaimed, otherwise the shade
+// model + 1 of the instance that claimed it.
+struct DrawBucket {
+  uint shadeModel;
+  uint count;
+  uint entry;
+};
+const uint cullMergeGroupSize = 64;
+layout(set = 0, binding = 8, scalar) buffer BucketBuf { DrawBucket buckets[]; };
+// dispatch command of the merge, followed by the claimed buckets and their offsets into the
+// instance id list.
+layout(set = 0, binding = 9, scalar) buffer ActiveBucketBuf {
+  uvec3 mergeDispatch;
+  uint activeCount;
+  uvec2 activeBuckets[];
+};
+// per dispatched (frustum, instance), its index in the bucket, or ~0 if it's not merged.
+layout(set = 0, binding = 10, scalar) buffer VisibleSlotBuf { uint visibleSlots[]; };
+// per frustum, the ids of the drawn instances, indexed by gl_InstanceIndex.
+layout(set = 0, binding = 11, scalar) buffer InstanceIdBuf { uint instanceIds[]; };
+layout(set = 0, binding = 12, scalar) buffer InstanceCountBuf { uint instanceCounts[]; };
+// per (frustum, instance), a bit for every frustum merged into it that sees the instance.
+layout(set = 0, binding = 13, scalar) buffer ViewMaskBuf { uint viewMasks[]; };
+
+// the frustum whose draws the instances visible in frustumIdx are emitted to.
+uint drawFrustum(uint frustumIdx) {
+  uint mergeInto = frustums[frustumIdx].mergeInto;
+  return mergeInto == nullIdx ? frustumIdx : mergeInto;
+}
+
+void emitDraw(
+  uint frustumIdx, uint shadeModelID, PrimitiveDesc prim, uint firstInstance,
+  uint instanceCount) {
+  VkDrawIndexedIndirectCommand drawCMD;
+  drawCMD.firstIndex = prim.index.start;
+  drawCMD.indexCount = prim.index.size;
+  drawCMD.vertexOffset = int(prim.position.start);
+  drawCMD.firstInstance = firstInstance;
+  drawCMD.instanceCount = instanceCount;
+
+  uint shadeModelIdx = atomicAdd(drawCMDCount[frustumIdx * groupStride + shadeModelID], 1);
+  uint shadeModelOffset = cmdOffsetPerGroup[shadeModelID];
+  uint cmdIdx = frustumIdx * cmdFrustumStride + shadeModelOffset + shadeModelIdx;
+  drawCMDs[cmdIdx] = drawCMD;
+}
+
+#endif //VKG_CULL_DRAW_RESOURCES_H
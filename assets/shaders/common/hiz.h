@@ -0,0 +1,45 @@
+#ifndef VKG_HIZ_H
+#define VKG_HIZ_H
+
+#include "../common.h"
+
+// Each texel of the depth pyramid holds the farthest depth of the pixels it covers. The box is
+// occluded when its nearest depth is behind every texel of the 2x2 footprint it projects to.
+bool isOccluded(sampler2D pyramid, uvec2 size, uint levels, mat4 viewProj, AABB aabb) {
+  vec3 ndcMin = vec3(1e30), ndcMax = vec3(-1e30);
+  for(int i = 0; i < 8; ++i) {
+    vec3 corner = vec3(
+      (i & 1) != 0 ? aabb.max.x : aabb.min.x, (i & 2) != 0 ? aabb.max.y : aabb.min.y,
+      (i & 4) != 0 ? aabb.max.z : aabb.min.z);
+    vec4 clip = viewProj * vec4(corner, 1);
+    // boxes crossing the near plane are always visible.
+    if(clip.w <= 0) return false;
+    vec3 ndc = clip.xyz / clip.w;
+    ndcMin = min(ndcMin, ndc);
+    ndcMax = max(ndcMax, ndc);
+  }
+  if(ndcMin.z < 0) return false;
+
+  vec2 uvMin = clamp(ndcMin.xy * 0.5 + 0.5, 0, 1);
+  vec2 uvMax = clamp(ndcMax.xy * 0.5 + 0.5, 0, 1);
+  vec2 extent = (uvMax - uvMin) * vec2(size);
+  int level = int(ceil(log2(max(max(extent.x, extent.y), 1))));
+  level = min(level, int(levels) - 1);
+  ivec2 levelSize = max(ivec2(size) >> level, ivec2(1));
+  ivec2 p0 = clamp(ivec2(uvMin * levelSize), ivec2(0), levelSize - 1);
+  ivec2 p1 = clamp(ivec2(uvMax * levelSize), ivec2(0), levelSize - 1);
+  // odd mip sizes fold their last row and column into the neighbour, which can widen the footprint.
+  if(any(greaterThan(p1 - p0, ivec2(1))) && level < int(levels) - 1) {
+    ++level;
+    levelSize = max(ivec2(size) >> level, ivec2(1));
+    p0 = clamp(ivec2(uvMin * levelSize), ivec2(0), levelSize - 1);
+    p1 = clamp(ivec2(uvMax * levelSize), ivec2(0), levelSize - 1);
+  }
+
+  float depth = max(
+    max(texelFetch(pyramid, p0, level).r, texelFetch(pyramid, ivec2(p1.x, p0.y), level).r),
+    max(texelFetch(pyramid, ivec2(p0.x, p1.y), level).r, texelFetch(pyramid, p1, level).r));
+  return ndcMin.z > depth;
+}
+
+#endif //VKG_HIZ_H
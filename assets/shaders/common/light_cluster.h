@@ -0,0 +1,29 @@
+#ifndef VKG_LIGHT_CLUSTER_H
+#define VKG_LIGHT_CLUSTER_H
+
+// The view frustum is split into clusterCountX x clusterCountY screen tiles and clusterCountZ
+// depth slices, exponentially spaced between the camera's near and far planes. Must match
+// LightClusterPass.
+const uint clusterCountX = 16;
+const uint clusterCountY = 9;
+const uint clusterCountZ = 24;
+const uint numClusters = clusterCountX * clusterCountY * clusterCountZ;
+// Each cluster holds its light count followed by up to maxLightsPerCluster light indices.
+const uint maxLightsPerCluster = 127;
+const uint clusterStride = maxLightsPerCluster + 1;
+const uint clusterGroupSize = 64;
+
+uint clusterSlice(float viewDepth, float zNear, float zFar) {
+  float slice = log(max(viewDepth, zNear) / zNear) / log(zFar / zNear) * float(clusterCountZ);
+  return min(uint(max(slice, 0)), clusterCountZ - 1);
+}
+
+// index of the cluster containing the fragment at fragCoord and viewDepth in front of the camera.
+uint clusterIndex(vec2 fragCoord, float viewDepth, vec2 screenSize, float zNear, float zFar) {
+  uvec2 tile = min(uvec2(fragCoord / screenSize * vec2(clusterCountX, clusterCountY)),
+                   uvec2(clusterCountX - 1, clusterCountY - 1));
+  uint slice = clusterSlice(viewDepth, zNear, zFar);
+  return (slice * clusterCountY + tile.y) * clusterCountX + tile.x;
+}
+
+#endif //VKG_LIGHT_CLUSTER_H
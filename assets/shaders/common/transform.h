@@ -0,0 +1,58 @@
+#ifndef VKG_TRANSFORM_H
+#define VKG_TRANSFORM_H
+
+#include "../common.h"
+layout(constant_id = 0) const uint lx = 1;
+layout(constant_id = 1) const uint ly = 1;
+layout(constant_id = 2) const uint lz = 1;
+layout(local_size_x_id = 0, local_size_y_id = 1, local_size_z_id = 2) in;
+
+// the slots are only used with the descriptor heap.
+layout(push_constant) uniform PushConstant {
+  uint totalMeshInstances;
+  uint frame;
+  uint meshInstanceSlot;
+  uint transformSlot;
+  uint matrixSlot;
+};
+
+#ifdef USE_DESCRIPTOR_HEAP
+// buffers are slots of the descriptor heap's storage buffer binding.
+layout(set = 0, binding = 0, scalar) buffer MeshesBuffer {
+  MeshInstanceDesc meshInstances[];
+} meshInstanceBufs[];
+layout(set = 0, binding = 0, scalar) buffer TransformBuffer {
+  Transform transforms[];
+} transformBufs[];
+layout(set = 0, binding = 0, std430) buffer TransformMatrixBuffer {
+  mat4 matrices[];
+} matrixBufs[];
+  #define MESH_INSTANCES meshInstanceBufs[meshInstanceSlot].meshInstances
+  #define TRANSFORMS transformBufs[transformSlot].transforms
+  #define MATRICES matrixBufs[matrixSlot].matrices
+#else
+layout(set = 0, binding = 0, scalar) buffer MeshesBuffer {
+  MeshInstanceDesc meshInstances[];
+};
+layout(set = 0, binding = 1, scalar) buffer TransformBuffer { Transform transforms[]; };
+layout(set = 0, binding = 2, std430) buffer TransformMatrixBuffer { mat4 matrices[]; };
+  #define MESH_INSTANCES meshInstances
+  #define TRANSFORMS transforms
+  #define MATRICES matrices
+#endif
+
+void main() {
+  uint NX = gl_NumWorkGroups.x * gl_WorkGroupSize.x;
+  uint NY = gl_NumWorkGroups.y * gl_WorkGroupSize.y;
+  uint id = gl_GlobalInvocationID.z * (NX * NY) + gl_GlobalInvocationID.y * NX +
+            gl_GlobalInvocationID.x;
+
+  if(id >= totalMeshInstances) return;
+
+  MeshInstanceDesc mesh = MESH_INSTANCES[id];
+  mat4 t =
+    toMatrix(TRANSFORMS[frameRef(mesh.instance, frame)]) * toMatrix(TRANSFORMS[mesh.node]);
+  MATRICES[id] = t;
+}
+
+#endif //VKG_TRANSFORM_H
@@ -12,9 +12,10 @@ layout(constant_id = 0) const uint numCascades = 1;
 layout(push_constant) uniform CascadedIndex { uint cascadeIndex; };
 layout(set = 0, binding = 0, scalar) buffer Cascades { CascadeDesc cascades[]; };
 layout(set = 0, binding = 1, std430) buffer TransformMatrixBuffer { mat4 matrices[]; };
+layout(set = 0, binding = 2, std430) readonly buffer InstanceIdBuf { uint instanceIds[]; };
 
 void main() {
-  mat4 model = matrices[gl_InstanceIndex];
+  mat4 model = matrices[instanceIds[gl_InstanceIndex]];
   vec4 pos = model * vec4(inPos, 1.0);
   pos = pos / pos.w;
   gl_Position = cascades[cascadeIndex].lightViewProj * pos;
@@ -0,0 +1,34 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+#extension GL_EXT_scalar_block_layout : enable
+#extension GL_EXT_multiview : enable
+
+#include "../deferred_common.h"
+
+layout(location = 0) in vec3 inPos;
+layout(location = 1) in vec3 inNormal;
+layout(location = 2) in vec2 inUV0;
+
+// Every cascade is a view of the render pass. Instances are drawn once for all cascades and
+// dropped by the cascades that didn't see them in the cull.
+layout(push_constant) uniform CascadedIndex {
+  uint cascadeIndex;
+  uint viewMaskOffset;
+};
+layout(set = 0, binding = 0, scalar) buffer Cascades { CascadeDesc cascades[]; };
+layout(set = 0, binding = 1, std430) buffer TransformMatrixBuffer { mat4 matrices[]; };
+layout(set = 0, binding = 2, std430) readonly buffer InstanceIdBuf { uint instanceIds[]; };
+layout(set = 0, binding = 3, std430) readonly buffer ViewMaskBuf { uint viewMasks[]; };
+
+void main() {
+  uint id = instanceIds[gl_InstanceIndex];
+  if((viewMasks[viewMaskOffset + id] & (1u << gl_ViewIndex)) == 0) {
+    // outside of the clip volume, the whole triangle is clipped.
+    gl_Position = vec4(2, 2, 2, 1);
+    return;
+  }
+  mat4 model = matrices[id];
+  vec4 pos = model * vec4(inPos, 1.0);
+  pos = pos / pos.w;
+  gl_Position = cascades[gl_ViewIndex].lightViewProj * pos;
+}
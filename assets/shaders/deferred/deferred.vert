@@ -10,12 +10,18 @@ layout(location = 0) out vec3 outWorldPos;
 layout(location = 1) out vec3 outNormal;
 layout(location = 2) out vec2 outUV0;
 layout(location = 3) out flat uint outMaterialID;
+layout(location = 4) out vec4 outClipPos;
+layout(location = 5) out vec4 outPrevClipPos;
 
 layout(push_constant) uniform PushConstant { uint frame; };
 
+// the depth prepass computes the same positions, see depth_prepass.vert.
+invariant gl_Position;
+
 void main() {
-  MeshInstanceDesc mesh = meshInstances[gl_InstanceIndex];
-  mat4 model = matrices[gl_InstanceIndex];
+  uint instance = instanceIds[gl_InstanceIndex];
+  MeshInstanceDesc mesh = meshInstances[instance];
+  mat4 model = matrices[instance];
   vec4 pos = model * vec4(inPos, 1.0);
   pos = pos / pos.w;
   outWorldPos = pos.xyz;
@@ -23,4 +29,8 @@ void main() {
   outUV0 = inUV0;
   outMaterialID = frameRef(mesh.material, frame);
   gl_Position = camera.projView * pos;
+  // without the jitter, so a still surface has no velocity.
+  outClipPos = camera.unjitteredProjView * pos;
+  vec4 prevPos = prevMatrices[instance] * vec4(inPos, 1.0);
+  outPrevClipPos = camera.prevProjView * (prevPos / prevPos.w);
 }
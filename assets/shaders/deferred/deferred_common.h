@@ -13,4 +13,9 @@ struct ShadowMapSetting {
   uint numCascades;
 };
 
+/** screen uv offset from where the surface was in the previous frame to where it is now. */
+vec2 velocity(vec4 clipPos, vec4 prevClipPos) {
+  return (clipPos.xy / clipPos.w - prevClipPos.xy / prevClipPos.w) * 0.5;
+}
+
 #endif //VKG_DEFERRED_COMMON_H
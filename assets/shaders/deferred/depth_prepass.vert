@@ -0,0 +1,22 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+#extension GL_EXT_scalar_block_layout : enable
+
+#include "deferred_common.h"
+
+// Depth of the instances visible in the first phase of the occlusion cull, the depth pyramid of
+// the second phase is built from it. The gbuffer pass loads it, so positions must match deferred.vert.
+layout(location = 0) in vec3 inPos;
+
+layout(set = 0, binding = 0, scalar) readonly buffer Camera { CameraDesc camera; };
+layout(set = 0, binding = 1, std430) readonly buffer TransformBuf { mat4 matrices[]; };
+layout(set = 0, binding = 2, std430) readonly buffer InstanceIdBuf { uint instanceIds[]; };
+
+invariant gl_Position;
+
+void main() {
+  mat4 model = matrices[instanceIds[gl_InstanceIndex]];
+  vec4 pos = model * vec4(inPos, 1.0);
+  pos = pos / pos.w;
+  gl_Position = camera.projView * pos;
+}
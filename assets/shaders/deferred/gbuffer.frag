@@ -6,11 +6,14 @@ layout(location = 0) in vec3 inWorldPos;
 layout(location = 1) in vec3 inNormal;
 layout(location = 2) in vec2 inUV0;
 layout(location = 3) in flat uint inMaterialID;
+layout(location = 4) in vec4 inClipPos;
+layout(location = 5) in vec4 inPrevClipPos;
 
 layout(location = 0) out vec4 outNormal;
 layout(location = 1) out vec4 outDiffuse;
 layout(location = 2) out vec4 outSpecular;
 layout(location = 3) out vec4 outEmissive;
+layout(location = 4) out vec2 outVelocity;
 
 vec3 computeNormal(vec3 sampledNormal) {
   vec3 pos_dx = dFdx(inWorldPos);
@@ -108,4 +111,5 @@ void main() {
   outDiffuse = vec4(diffuseColor, ao);
   outSpecular = vec4(specularColor, perceptualRoughness);
   outEmissive.rgb = emissive;
+  outVelocity = velocity(inClipPos, inPrevClipPos);
 }
\ No newline at end of file
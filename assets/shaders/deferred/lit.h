@@ -4,16 +4,16 @@
 #include "../math.h"
 #define SUBPASS_GBUFFER
 #include "resources.h"
-#ifdef USE_ATMOSPHERE
-  #include "../atmosphere/lighting.h"
-#endif
-#ifdef USE_SHADOW_MAP
-  #include "csm/csm.h"
-#endif
+#include "../common/light_cluster.h"
+#include "../atmosphere/lighting.h"
+#include "csm/csm.h"
 #include "../brdf.h"
 #include "../punctual_light.h"
 #include "../tonemap.h"
 
+layout(constant_id = 1) const bool useAtmosphere = false;
+layout(constant_id = 2) const bool useShadowMap = false;
+
 layout(location = 0) in vec2 inUV;
 layout(location = 0) out vec4 outColor;
 
@@ -42,12 +42,11 @@ vec3 view_ray(CameraDesc cam) {
 }
 
 vec3 shadeBackground(CameraDesc cam) {
-#ifdef USE_ATMOSPHERE
-  vec3 view_direction = view_ray(cam);
-  return skyBackground(cam.eye.xyz, view_direction);
-#else
+  if(useAtmosphere) {
+    vec3 view_direction = view_ray(cam);
+    return skyBackground(cam.eye.xyz, view_direction);
+  }
   return vec3(0);
-#endif
 }
 
 PointInfo unpack() {
@@ -101,26 +100,25 @@ void main() {
     vec3 view = normalize(camera.eye.xyz - p.position);
 
     vec3 F = vec3(0);
-    for(int i = 0; i < lighting.numLights; ++i) {
-      LightDesc light = lights[i];
+    float viewDepth = -(camera.view * vec4(p.position, 1)).z;
+    uint cluster = clusterStride * clusterIndex(gl_FragCoord.xy, viewDepth, vec2(camera.w, camera.h),
+                                                camera.zNear, camera.zFar);
+    uint numClusterLights = lightClusters[cluster];
+    for(uint i = 0; i < numClusterLights; ++i) {
+      LightDesc light = lights[lightClusters[cluster + 1 + i]];
       vec3 rayDir = normalize(light.location - p.position);
       color += brdf(rayDir, materialInfo, p.normal, view, F) *
                pointLightRadiance(light, p.position, p.normal);
     }
 
-#ifdef USE_ATMOSPHERE
-    if(p.useSky) {
+    if(useAtmosphere && p.useSky) {
       vec3 rayDir = sun_direction.xyz;
-  #ifdef USE_SHADOW_MAP
-      bool shadowed = shadowTrace(camera, p.position);
-  #else
       bool shadowed = false;
-  #endif
+      if(useShadowMap) shadowed = shadowTrace(camera, p.position);
       vec3 directLight = brdf(rayDir, materialInfo, p.normal, view, F) *
                          atmosphereLight(p.position, p.normal, camera.eye.xyz);
       color += directLight * (shadowed ? 0.01 : 1);
     }
-#endif
 
     color = color * p.ao;
     color += p.emissive;
@@ -1,5 +0,0 @@
-#version 450
-#extension GL_GOOGLE_include_directive : require
-#define USE_ATMOSPHERE
-#include "lit.h"
-
@@ -1,6 +0,0 @@
-#version 450
-#extension GL_GOOGLE_include_directive : require
-#define USE_ATMOSPHERE
-#define USE_SHADOW_MAP
-#include "lit.h"
-
@@ -1,4 +0,0 @@
-#version 450
-#extension GL_GOOGLE_include_directive : require
-#include "lit.h"
-
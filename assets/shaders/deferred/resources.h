@@ -18,6 +18,9 @@ layout(set = 0, binding = 4) uniform sampler2D textures[maxNumTextures];
 
 layout(set = 0, binding = 5) uniform LightingUBO { LightingDesc lighting; };
 layout(set = 0, binding = 6, std430) readonly buffer LightsBuffer { LightDesc lights[]; };
+layout(set = 0, binding = 7, std430) readonly buffer InstanceIdBuf { uint instanceIds[]; };
+layout(set = 0, binding = 8, std430) readonly buffer LightClusterBuf { uint lightClusters[]; };
+layout(set = 0, binding = 9, std430) readonly buffer PrevTransformBuf { mat4 prevMatrices[]; };
 
 #ifdef SUBPASS_GBUFFER
   #ifdef MULTISAMPLE
@@ -42,12 +45,11 @@ layout(set = 2, binding = 0, input_attachment_index = 0) uniform subpassInput te
 layout(set = 2, binding = 1, input_attachment_index = 1) uniform subpassInput texWeights;
 #endif
 
-#ifdef USE_ATMOSPHERE
+#ifdef SUBPASS_GBUFFER
+  // the lighting is toggled by the specialization constants of lit.h, the sets are always bound.
   #define ATMOSPHERE_SET 3
   #include "../atmosphere/resources.h"
-#endif
 
-#ifdef USE_SHADOW_MAP
 layout(set = 4, binding = 0) uniform ShadowMapSettingUBO {
   ShadowMapSetting shadowMapSeting;
 };
@@ -8,8 +8,11 @@ layout(location = 0) in vec3 inWorldPos;
 layout(location = 1) in vec3 inNormal;
 layout(location = 2) in vec2 inUV0;
 layout(location = 3) in flat uint inMaterialID;
+layout(location = 4) in vec4 inClipPos;
+layout(location = 5) in vec4 inPrevClipPos;
 
 layout(location = 0) out vec4 outColor;
+layout(location = 1) out vec2 outVelocity;
 
 void main() {
   MaterialDesc material = materials[inMaterialID];
@@ -18,4 +21,5 @@ void main() {
                   vec4(1, 1, 1, 1);
   albedo = material.baseColorFactor.rgba * albedo;
   outColor = albedo;
+  outVelocity = velocity(inClipPos, inPrevClipPos);
 }
\ No newline at end of file
@@ -13,8 +13,9 @@ layout(location = 2) out float outDepth;
 layout(push_constant) uniform PushConstant { uint frame; };
 
 void main() {
-  MeshInstanceDesc mesh = meshInstances[gl_InstanceIndex];
-  mat4 model = matrices[gl_InstanceIndex];
+  uint instance = instanceIds[gl_InstanceIndex];
+  MeshInstanceDesc mesh = meshInstances[instance];
+  mat4 model = matrices[instance];
   vec4 pos = model * vec4(inPos, 1.0);
   pos = pos / pos.w;
   outUV0 = inUV0;
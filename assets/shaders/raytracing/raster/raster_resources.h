@@ -22,5 +22,6 @@ layout(set = 0, binding = 5, scalar) readonly buffer MaterialBuf {
   MaterialDesc materials[];
 };
 layout(set = 0, binding = 6) uniform sampler2D textures[maxNumTextures];
+layout(set = 0, binding = 7, std430) readonly buffer InstanceIdBuf { uint instanceIds[]; };
 
 #endif //VKG_RASTER_RESOURCES_H
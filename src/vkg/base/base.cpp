@@ -1,18 +1,25 @@
 #include "base.hpp"
 #include <iostream>
 #include "vkg/util/syntactic_sugar.hpp"
+#include "vkg/util/trace_recorder.hpp"
 
 VULKAN_HPP_DEFAULT_DISPATCH_LOADER_DYNAMIC_STORAGE
 
 namespace vkg {
 
-Base::Base(const WindowConfig &windowConfig, const FeatureConfig &featureConfig): featureConfig_{featureConfig} {
-    window_ = std::make_unique<Window>(windowConfig);
+Base::Base(const WindowConfig &windowConfig, const FeatureConfig &featureConfig)
+    : windowConfig_{windowConfig}, featureConfig_{featureConfig} {
+    if(!featureConfig_.headless) window_ = std::make_unique<Window>(windowConfig);
     instance = std::make_unique<Instance>(featureConfig_);
-    window_->createSurface(instance->vkInstance());
+    vk::SurfaceKHR surface;
+    if(window_) {
+        window_->createSurface(instance->vkInstance());
+        surface = window_->vkSurface();
+    }
     createDebugUtils();
-    device_ = std::make_unique<Device>(*instance, window_->vkSurface(), featureConfig_);
-    swapchain_ = std::make_unique<Swapchain>(*device_, window_->vkSurface(), featureConfig_);
+    device_ = std::make_unique<Device>(*instance, surface, featureConfig_);
+    swapchain_ = surface ? std::make_unique<Swapchain>(*device_, surface, featureConfig_) :
+                           std::make_unique<Swapchain>(*device_, featureConfig_);
     createSyncObjects();
     createCommandBuffers();
     Base::resize();
@@ -77,7 +84,9 @@ auto Base::createCommandBuffers() -> void {
 
 auto Base::resize() -> void {
     device_->vkDevice().waitIdle();
-    swapchain_->resize(window_->width(), window_->height(), featureConfig_.vsync);
+    auto width = window_ ? window_->width() : windowConfig_.width;
+    auto height = window_ ? window_->height() : windowConfig_.height;
+    swapchain_->resize(width, height, featureConfig_.vsync);
     //empty cb for syncReverse
     for(auto i = 0u, numFrames = uint32_t(device_->queues().size()); i < numFrames; ++i) {
         cmdBuffers[i].begin({vk::CommandBufferUsageFlagBits::eSimultaneousUse});
@@ -90,12 +99,14 @@ void Base::onFrame(uint32_t imageIndex, float elapsed) {
 
     auto image = swapchain_->image(imageIndex);
     image::setLayout(
-        cb, image, vk::ImageLayout::eUndefined, vk::ImageLayout::ePresentSrcKHR, vk::AccessFlagBits::eTransferWrite,
+        cb, image, vk::ImageLayout::eUndefined, swapchain_->presentLayout(), vk::AccessFlagBits::eTransferWrite,
         vk::AccessFlagBits::eMemoryRead);
 }
 
 void Base::loop(const std::function<void(uint32_t, double)> &updater) {
-    onInit();
+    errorIf(featureConfig_.headless, "headless renderer has no window to loop on, use renderFrame instead");
+    if(!initialized) onInit();
+    initialized = true;
     auto start = std::chrono::high_resolution_clock::now();
     while(!window_->windowShouldClose()) {
         window_->pollEvents();
@@ -110,14 +121,33 @@ void Base::loop(const std::function<void(uint32_t, double)> &updater) {
 
         fpsMeter_.update(elapsed);
         //    syncSemaphore(elapsed, updater);
-        syncTimeline(elapsed, updater);
+        {
+            TraceScope trace("frame", "frame");
+            syncTimeline(elapsed, updater);
+        }
+        TraceRecorder::instance().endFrame();
     }
 
     device_->vkDevice().waitIdle();
     window_->terminate();
 }
 
-auto Base::window() -> Window & { return *window_; }
+auto Base::renderFrame(double elapsedMs, const std::function<void(uint32_t, double)> &updater) -> uint32_t {
+    if(!initialized) onInit();
+    initialized = true;
+    fpsMeter_.update(elapsedMs);
+    {
+        TraceScope trace("frame", "frame");
+        syncTimeline(elapsedMs, updater);
+    }
+    TraceRecorder::instance().endFrame();
+    return lastImageIndex;
+}
+
+auto Base::window() -> Window & {
+    errorIf(!window_, "headless renderer has no window");
+    return *window_;
+}
 void Base::loop(Updater updater, void *data) {
     loop([&](uint32_t frameIdx, double elapsed) { updater(frameIdx, elapsed, data); });
 }
@@ -183,24 +213,39 @@ auto Base::syncTimeline(double elapsed, const std::function<void(uint32_t, doubl
 
     vk::SemaphoreWaitInfo waitInfo{{}, 1, sync.semaphore.operator->(), &sync.waitValue};
 
-    dev.waitSemaphores(waitInfo, UINT64_MAX);
+    {
+        TraceScope trace("wait semaphore", "frame");
+        dev.waitSemaphores(waitInfo, UINT64_MAX);
+    }
+    device_->checkMemoryBudget();
 
     /**
      * imageIndex is the index of available swapchain image. frameIndex is the ring index of frame.
      * we should depend on frameIndex to ring index our buffers and render into imageIndex swapchain image.
      */
     uint32_t imageIndex = 0;
-    try {
-        auto result = swapchain_->acquireNextImage(*sync.wsiImageAvailable, imageIndex);
-        if(result == vk::Result::eSuboptimalKHR) resize();
-    } catch(const vk::OutOfDateKHRError &) { resize(); }
+    auto headless = swapchain_->headless();
+    {
+        TraceScope trace("acquire", "frame");
+        try {
+            auto result = swapchain_->acquireNextImage(*sync.wsiImageAvailable, imageIndex);
+            if(result == vk::Result::eSuboptimalKHR) resize();
+        } catch(const vk::OutOfDateKHRError &) { resize(); }
+    }
 
+    lastImageIndex = imageIndex;
     auto cb = cmdBuffers[frameIndex];
 
     cb.begin({vk::CommandBufferUsageFlagBits::eSimultaneousUse});
 
-    updater(frameIndex, elapsed);
-    onFrame(imageIndex, float(elapsed));
+    {
+        TraceScope trace("updater", "frame");
+        updater(frameIndex, elapsed);
+    }
+    {
+        TraceScope trace("onFrame", "frame");
+        onFrame(imageIndex, float(elapsed));
+    }
 
     cb.end();
 
@@ -210,13 +255,31 @@ auto Base::syncTimeline(double elapsed, const std::function<void(uint32_t, doubl
     sync.waitValue = renderFinishedValue;
 
     vk::SubmitInfo submit;
-    std::vector<vk::PipelineStageFlags> waitStages{
-        vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eColorAttachmentOutput};
-    std::vector<vk::Semaphore> waitSemaphores{sync.semaphore.get(), sync.wsiImageAvailable.get()};
-    std::array<uint64_t, 2> waitValues{lastRenderFinishedValue, 0};
-
-    std::vector<vk::Semaphore> signalSemaphores{sync.semaphore.get(), sync.wsiReadyToPresent.get()};
-    std::array<uint64_t, 2> signalValues{renderFinishedValue, 0};
+    std::vector<vk::PipelineStageFlags> waitStages{vk::PipelineStageFlagBits::eAllCommands};
+    std::vector<vk::Semaphore> waitSemaphores{sync.semaphore.get()};
+    std::vector<uint64_t> waitValues{lastRenderFinishedValue};
+    // offscreen images are acquired without the presentation engine, so there is nothing to wait for.
+    if(!headless) {
+        waitStages.emplace_back(vk::PipelineStageFlagBits::eColorAttachmentOutput);
+        waitSemaphores.push_back(sync.wsiImageAvailable.get());
+        waitValues.push_back(0);
+    }
+    for(auto &wait: frameWaits) {
+        waitStages.push_back(wait.stage);
+        waitSemaphores.push_back(wait.semaphore);
+        waitValues.push_back(wait.value);
+    }
+    frameWaits.clear();
+    std::vector<vk::CommandBuffer> cbs{cb};
+    cbs.insert(cbs.end(), frameCmdBuffers.begin(), frameCmdBuffers.end());
+    frameCmdBuffers.clear();
+
+    std::vector<vk::Semaphore> signalSemaphores{sync.semaphore.get()};
+    std::vector<uint64_t> signalValues{renderFinishedValue};
+    if(!headless) {
+        signalSemaphores.push_back(sync.wsiReadyToPresent.get());
+        signalValues.push_back(0);
+    }
 
     vk::TimelineSemaphoreSubmitInfo timelineInfo;
     timelineInfo.waitSemaphoreValueCount = uint32_t(waitValues.size());
@@ -230,16 +293,31 @@ auto Base::syncTimeline(double elapsed, const std::function<void(uint32_t, doubl
     submit.pWaitDstStageMask = waitStages.data();
     submit.signalSemaphoreCount = uint32_t(signalSemaphores.size());
     submit.pSignalSemaphores = signalSemaphores.data();
-    submit.commandBufferCount = 1;
-    submit.pCommandBuffers = &cb;
-    device_->queues()[frameIndex].submit(submit, nullptr);
+    submit.commandBufferCount = uint32_t(cbs.size());
+    submit.pCommandBuffers = cbs.data();
+    {
+        TraceScope trace("submit", "frame");
+        device_->queues()[frameIndex].submit(submit, nullptr);
+    }
 
-    try {
-        auto result = swapchain_->present(frameIndex, imageIndex, *sync.wsiReadyToPresent);
-        if(result == vk::Result::eSuboptimalKHR) resize();
-    } catch(const vk::OutOfDateKHRError &) { resize(); }
+    if(!headless) {
+        TraceScope trace("present", "frame");
+        try {
+            auto result = swapchain_->present(frameIndex, imageIndex, *sync.wsiReadyToPresent);
+            if(result == vk::Result::eSuboptimalKHR) resize();
+        } catch(const vk::OutOfDateKHRError &) { resize(); }
+    }
 
     frameIndex = (frameIndex + 1) % featureConfig_.numFrames;
 }
 auto Base::fpsMeter() -> FPSMeter & { return fpsMeter_; }
+auto Base::frameTimeline() const -> SemaphoreWait {
+    auto &sync = timelineSyncs[frameIndex];
+    return {*sync.semaphore, sync.waitValue + 1, vk::PipelineStageFlagBits::eAllCommands};
+}
+auto Base::previousFrameTimeline() const -> SemaphoreWait {
+    auto numFrames = uint32_t(timelineSyncs.size());
+    auto &sync = timelineSyncs[(frameIndex + numFrames - 1) % numFrames];
+    return {*sync.semaphore, sync.waitValue, vk::PipelineStageFlagBits::eAllCommands};
+}
 }
\ No newline at end of file
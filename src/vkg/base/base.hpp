@@ -17,6 +17,7 @@
 #include "pipeline/descriptor_def.hpp"
 #include "pipeline/descriptor_macro.hpp"
 #include "pipeline/descriptor_pool.hpp"
+#include "pipeline/descriptor_heap.hpp"
 #include "pipeline/pipeline.hpp"
 #include "pipeline/pipeline_def.hpp"
 #include "pipeline/pipeline_macro.hpp"
@@ -24,6 +25,8 @@
 #include "pipeline/compute_pipeline_maker.hpp"
 #include "pipeline/raytracing_pipeline.hpp"
 #include "pipeline/pipeline_query.hpp"
+#include "pipeline/shader_reflection.hpp"
+#include "pipeline/shader_variants.hpp"
 
 namespace vkg {
 typedef void (*Updater)(uint32_t frameIdx, double elapsedMs, void *data);
@@ -35,6 +38,13 @@ public:
     void loop(const std::function<void(uint32_t frameIdx, double elapsedMs)> &updater = [](uint32_t, float) {});
     void loop(Updater updater, void *data);
     void loop(CallFrameUpdater &updater);
+    /**
+     * render a single frame. This is how frames are driven in headless mode, where `loop` is unavailable.
+     * @return the index of the swapchain image the frame was rendered into.
+     */
+    auto renderFrame(
+        double elapsedMs = 0, const std::function<void(uint32_t frameIdx, double elapsedMs)> &updater =
+                                  [](uint32_t, double) {}) -> uint32_t;
 
     auto window() -> Window &;
     auto featureConfig() const -> const FeatureConfig &;
@@ -43,6 +53,14 @@ public:
     auto swapchain() -> Swapchain &;
 
     auto fpsMeter() -> FPSMeter &;
+    /**
+     * timeline semaphore and value signalled once the frame being recorded by `onFrame` finishes.
+     */
+    auto frameTimeline() const -> SemaphoreWait;
+    /**
+     * timeline semaphore and value signalled once the frame submitted before the one being recorded finishes.
+     */
+    auto previousFrameTimeline() const -> SemaphoreWait;
 
 protected:
     auto syncSemaphore(double elapsed, const std::function<void(uint32_t, double)> &updater) -> void;
@@ -55,6 +73,7 @@ protected:
     auto createSyncObjects() -> void;
     auto createCommandBuffers() -> void;
 
+    WindowConfig windowConfig_;
     FeatureConfig featureConfig_;
 
     std::unique_ptr<Instance> instance;
@@ -84,6 +103,16 @@ protected:
     std::vector<TimelineSync> timelineSyncs;
 
     uint32_t frameIndex{0};
+    uint32_t lastImageIndex{0};
+    bool initialized{false};
+    /**
+     * additional semaphores the frame's submission waits on, filled by `onFrame`.
+     */
+    std::vector<SemaphoreWait> frameWaits;
+    /**
+     * additional command buffers submitted in order after the frame's command buffer, filled by `onFrame`.
+     */
+    std::vector<vk::CommandBuffer> frameCmdBuffers;
 
     FPSMeter fpsMeter_;
 };
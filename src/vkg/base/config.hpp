@@ -11,5 +11,29 @@ struct FeatureConfig {
     bool vsync{false};
     uint32_t numFrames{1};
     bool rayTrace{false};
+    /**
+     * run compute passes that declare QueueType::eCompute on a dedicated compute queue family if the
+     * device has one.
+     */
+    bool asyncCompute{false};
+    /**
+     * number of threads recording the frame graph. Independent passes are recorded in parallel
+     * when greater than 1.
+     */
+    uint32_t recordThreads{1};
+    /**
+     * render into offscreen images of `WindowConfig`'s size without creating a window or surface.
+     * Frames are driven by `Base::renderFrame` instead of `Base::loop`.
+     */
+    bool headless{false};
+    /**
+     * file the device's pipeline cache is loaded from and saved to. Empty keeps the cache in memory only.
+     */
+    std::string pipelineCachePath;
+    /**
+     * directory the precomputed atmosphere LUTs are loaded from and saved to, one file per set of
+     * atmosphere parameters. Empty precomputes them on every run.
+     */
+    std::string atmosphereCacheDir;
 };
 }
\ No newline at end of file
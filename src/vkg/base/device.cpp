@@ -2,7 +2,12 @@
 #include <string>
 #include <set>
 #include <queue>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
 #include "vkg/util/syntactic_sugar.hpp"
+#include "pipeline/descriptor_heap.hpp"
 
 namespace vkg {
 
@@ -77,8 +82,9 @@ void Device::findQueueFamily() {
 
     uint32_t gfxIdx = 0;
     for(; gfxIdx < queueFamilies.size(); gfxIdx++)
-        if(auto &family = queueFamilies[gfxIdx]; physicalDevice_.getSurfaceSupportKHR(gfxIdx, surface) &&
-                                                 (family.queueFlags & desiredFlag) && family.queueCount >= queueCount) {
+        if(auto &family = queueFamilies[gfxIdx];
+           (!surface || physicalDevice_.getSurfaceSupportKHR(gfxIdx, surface)) &&
+           (family.queueFlags & desiredFlag) && family.queueCount >= queueCount) {
             break;
         }
 
@@ -89,6 +95,26 @@ void Device::findQueueFamily() {
     queueFamily_ = gfxIdx;
 }
 
+/**
+ * A family with compute but without graphics is usually backed by separate hardware queues that
+ * can overlap with rasterization.
+ */
+void Device::findComputeQueueFamily() {
+    auto queueFamilies = physicalDevice_.getQueueFamilyProperties();
+    using Flag = vk::QueueFlagBits;
+
+    for(auto idx = 0u; idx < queueFamilies.size(); idx++)
+        if(auto &family = queueFamilies[idx]; (family.queueFlags & Flag::eCompute) &&
+                                              !(family.queueFlags & Flag::eGraphics) &&
+                                              family.queueCount >= queueCount) {
+            debugLog("Compute Queue Family: ", idx);
+            computeQueueFamily_ = idx;
+            supported_.asyncCompute = true;
+            return;
+        }
+    debugLog("no dedicated compute queue family, async compute disabled");
+}
+
 void checkDeviceExtensionSupport(const vk::PhysicalDevice &device, std::vector<const char *> &requiredExtensions) {
     std::set<std::string> availableExtensions;
     for(auto extension: device.enumerateDeviceExtensionProperties())
@@ -100,14 +126,16 @@ void checkDeviceExtensionSupport(const vk::PhysicalDevice &device, std::vector<c
 }
 
 Device::Device(Instance &instance, vk::SurfaceKHR surface, const FeatureConfig &featureConfig)
-    : instance{instance}, surface{surface} {
+    : instance{instance}, surface{surface}, pipelineCachePath{featureConfig.pipelineCachePath} {
     auto physicalDevices = instance.vkInstance().enumeratePhysicalDevices();
     physicalDevice_ = chooseBestPerformantGPU(physicalDevices);
 
     limits_ = physicalDevice_.getProperties().limits;
     memProps_ = physicalDevice_.getMemoryProperties();
 
-    std::vector<const char *> deviceExtensions{VK_KHR_SWAPCHAIN_EXTENSION_NAME};
+    std::vector<const char *> deviceExtensions;
+    // headless devices have no surface to present to.
+    if(surface) deviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
 
     auto features2 = physicalDevice_.getFeatures2();
     auto *pNext = &features2.pNext;
@@ -118,11 +146,31 @@ Device::Device(Instance &instance, vk::SurfaceKHR surface, const FeatureConfig &
     *pNext = &features12;
     pNext = &features12.pNext;
 
+    // only multiview is enabled, used to render every shadow cascade in one pass.
+    auto multiview = physicalDevice_.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan11Features>()
+                         .get<vk::PhysicalDeviceVulkan11Features>()
+                         .multiview;
+    vk::PhysicalDeviceVulkan11Features features11;
+    features11.multiview = multiview;
+    *pNext = &features11;
+    pNext = &features11.pNext;
+    supported_.multiview = multiview;
+    if(multiview)
+        multiviewProperties_ =
+            physicalDevice_.getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceMultiviewProperties>()
+                .get<vk::PhysicalDeviceMultiviewProperties>();
+
     errorIf(!features12.scalarBlockLayout, "required feature scalarBlockLayout not supported!");
     errorIf(!features12.drawIndirectCount, "required feature drawIndirectCount not supported!");
     errorIf(!features12.timelineSemaphore, "required feature timelineSemaphore not supported!");
+    errorIf(!features12.hostQueryReset, "required feature hostQueryReset not supported!");
 
     supported_.samplerAnisotropy = features2.features.samplerAnisotropy;
+    supported_.descriptorIndexing =
+        features12.descriptorIndexing && features12.runtimeDescriptorArray &&
+        features12.descriptorBindingPartiallyBound && features12.descriptorBindingUpdateUnusedWhilePending &&
+        features12.descriptorBindingStorageBufferUpdateAfterBind &&
+        features12.descriptorBindingSampledImageUpdateAfterBind;
 #if defined(USE_DEBUG_PRINTF)
     deviceExtensions.push_back(VK_KHR_SHADER_NON_SEMANTIC_INFO_EXTENSION_NAME);
     errorIf(
@@ -133,6 +181,24 @@ Device::Device(Instance &instance, vk::SurfaceKHR surface, const FeatureConfig &
     deviceExtensions.push_back(VK_KHR_DEDICATED_ALLOCATION_EXTENSION_NAME);
     deviceExtensions.push_back(VK_KHR_GET_MEMORY_REQUIREMENTS_2_EXTENSION_NAME);
 
+    // used to place GPU timestamps on the CPU timeline of traces.
+    for(auto extension: physicalDevice_.enumerateDeviceExtensionProperties())
+        if(std::string{(const char *)extension.extensionName} == VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME) {
+            auto domains = physicalDevice_.getCalibrateableTimeDomainsEXT();
+            if(std::find(domains.begin(), domains.end(), vk::TimeDomainEXT::eDevice) == domains.end()) break;
+            deviceExtensions.push_back(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+            supported_.calibratedTimestamps = true;
+            break;
+        }
+
+    // lets VMA report the heap budgets of the driver instead of estimating them from the heap sizes.
+    for(auto extension: physicalDevice_.enumerateDeviceExtensionProperties())
+        if(std::string{(const char *)extension.extensionName} == VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) {
+            deviceExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+            supported_.memoryBudget = true;
+            break;
+        }
+
     if(featureConfig.rayTrace) {
         append(
             deviceExtensions, {
@@ -166,10 +232,14 @@ Device::Device(Instance &instance, vk::SurfaceKHR surface, const FeatureConfig &
     queueCount = featureConfig.numFrames;
 
     findQueueFamily();
+    computeQueueFamily_ = queueFamily_;
+    if(featureConfig.asyncCompute) findComputeQueueFamily();
 
     std::vector<float> priorities(queueCount);
 
     std::vector<vk::DeviceQueueCreateInfo> queueCreateInfos{{{}, queueFamily_, queueCount, priorities.data()}};
+    if(supported_.asyncCompute)
+        queueCreateInfos.emplace_back(vk::DeviceQueueCreateFlags{}, computeQueueFamily_, queueCount, priorities.data());
 
     vk::DeviceCreateInfo deviceInfo;
     deviceInfo.pNext = &features2;
@@ -188,14 +258,144 @@ Device::Device(Instance &instance, vk::SurfaceKHR surface, const FeatureConfig &
     cmdPool_ = device_->createCommandPoolUnique(
         vk::CommandPoolCreateInfo{{vk::CommandPoolCreateFlagBits::eResetCommandBuffer}, queueFamily_});
 
+    if(supported_.asyncCompute) {
+        computeQueues_.resize(queueCount);
+        for(uint32_t idx = 0u; idx < queueCount; ++idx)
+            computeQueues_[idx] = device_->getQueue(computeQueueFamily_, idx);
+        computeCmdPool_ = device_->createCommandPoolUnique(
+            vk::CommandPoolCreateInfo{{vk::CommandPoolCreateFlagBits::eResetCommandBuffer}, computeQueueFamily_});
+    }
+
     VULKAN_HPP_DEFAULT_DISPATCHER.init(*device_);
 
     createAllocator();
+    createPipelineCache();
+}
+
+Device::~Device() { savePipelineCache(); }
+
+void Device::createPipelineCache() {
+    std::vector<char> data;
+    if(!pipelineCachePath.empty()) {
+        std::ifstream file(pipelineCachePath, std::ios::ate | std::ios::binary);
+        if(file.good()) {
+            data.resize(size_t(file.tellg()));
+            file.seekg(0, std::ios::beg);
+            file.read(data.data(), std::streamsize(data.size()));
+        }
+    }
+    // the driver is supposed to reject foreign data itself, but not all of them do.
+    if(!data.empty()) {
+        auto properties = physicalDevice_.getProperties();
+        VkPipelineCacheHeaderVersionOne header{};
+        auto valid = data.size() >= sizeof(header);
+        if(valid) {
+            std::memcpy(&header, data.data(), sizeof(header));
+            valid = header.headerSize >= sizeof(header) &&
+                    header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+                    header.vendorID == properties.vendorID && header.deviceID == properties.deviceID &&
+                    std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+        }
+        if(!valid) {
+            debugLog("pipeline cache ", pipelineCachePath, " was created by another driver or device, ignored");
+            data.clear();
+        }
+    }
+    pipelineCache_ = device_->createPipelineCacheUnique({{}, data.size(), data.data()});
+    debugLog("pipeline cache: loaded ", data.size(), " bytes");
+}
+
+auto Device::pipelineCache() -> vk::PipelineCache { return *pipelineCache_; }
+
+auto Device::SamplerInfoHash::operator()(const vk::SamplerCreateInfo &info) const -> size_t {
+    size_t seed = 0;
+    auto combine = [&](auto v) { seed ^= std::hash<decltype(v)>{}(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2); };
+    combine(uint32_t(info.flags));
+    combine(info.magFilter);
+    combine(info.minFilter);
+    combine(info.mipmapMode);
+    combine(info.addressModeU);
+    combine(info.addressModeV);
+    combine(info.addressModeW);
+    combine(info.mipLodBias);
+    combine(info.anisotropyEnable);
+    combine(info.maxAnisotropy);
+    combine(info.compareEnable);
+    combine(info.compareOp);
+    combine(info.minLod);
+    combine(info.maxLod);
+    combine(info.borderColor);
+    combine(info.unnormalizedCoordinates);
+    combine(info.pNext);
+    return seed;
+}
+
+auto Device::sampler(const vk::SamplerCreateInfo &info) -> std::shared_ptr<vk::UniqueSampler> {
+    std::scoped_lock lock{samplerMutex};
+    auto &cached = samplers[info];
+    if(auto sampler = cached.lock()) return sampler;
+    auto sampler = std::shared_ptr<vk::UniqueSampler>(
+        new vk::UniqueSampler(device_->createSamplerUnique(info)), [this](vk::UniqueSampler *ptr) {
+            evictDescriptors(**ptr);
+            delete ptr;
+        });
+    cached = sampler;
+    return sampler;
+}
+
+auto Device::numSamplers() -> uint32_t {
+    std::scoped_lock lock{samplerMutex};
+    std::erase_if(samplers, [](auto &entry) { return entry.second.expired(); });
+    return uint32_t(samplers.size());
+}
+
+auto Device::descriptorHeap() -> DescriptorHeap & {
+    std::scoped_lock lock{heapMutex};
+    if(!descriptorHeap_) {
+        errorIf(!supported_.descriptorIndexing, "descriptor heap requires update-after-bind descriptor indexing!");
+        descriptorHeap_ = std::make_unique<DescriptorHeap>(*device_, DescriptorHeapConfig{});
+    }
+    return *descriptorHeap_;
+}
+
+auto Device::evictDescriptors(vk::Buffer buffer) -> void {
+    std::scoped_lock lock{heapMutex};
+    if(descriptorHeap_) descriptorHeap_->evict(buffer);
+}
+
+auto Device::evictDescriptors(vk::ImageView imageView) -> void {
+    std::scoped_lock lock{heapMutex};
+    if(descriptorHeap_) descriptorHeap_->evict(imageView);
+}
+
+auto Device::evictDescriptors(vk::Sampler sampler) -> void {
+    std::scoped_lock lock{heapMutex};
+    if(descriptorHeap_) descriptorHeap_->evict(sampler);
+}
+
+auto Device::savePipelineCache() -> void {
+    if(pipelineCachePath.empty() || !pipelineCache_) return;
+    auto data = device_->getPipelineCacheData(*pipelineCache_);
+    // write to a temporary file first so an interrupted save never leaves a truncated cache behind.
+    auto tmpPath = pipelineCachePath + ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        if(!file.good()) {
+            debugLog("failed to write pipeline cache ", tmpPath);
+            return;
+        }
+        file.write(reinterpret_cast<const char *>(data.data()), std::streamsize(data.size()));
+    }
+    std::remove(pipelineCachePath.c_str());
+    std::rename(tmpPath.c_str(), pipelineCachePath.c_str());
+    debugLog("pipeline cache: saved ", data.size(), " bytes to ", pipelineCachePath);
 }
 
 void Device::createAllocator() {
     VmaAllocatorCreateInfo createInfo{};
     createInfo.flags = VMA_ALLOCATOR_CREATE_KHR_DEDICATED_ALLOCATION_BIT;
+    if(supported_.memoryBudget) createInfo.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+    createInfo.instance = VkInstance(instance.vkInstance());
     createInfo.physicalDevice = VkPhysicalDevice(physicalDevice_);
     createInfo.device = VkDevice(*device_);
     auto &dispatcher = VULKAN_HPP_DEFAULT_DISPATCHER;
@@ -231,7 +431,66 @@ void Device::createAllocator() {
     errorIf(result != VK_SUCCESS, "failed to create Allocator");
 }
 
+auto Device::memoryTracker() -> MemoryTracker & { return memoryTracker_; }
+
+auto Device::heapStats() -> std::vector<MemoryHeapStats> {
+    std::vector<VmaBudget> budgets(memProps_.memoryHeapCount);
+    vmaGetHeapBudgets(*allocator_, budgets.data());
+    std::vector<MemoryHeapStats> heaps;
+    for(auto i = 0u; i < budgets.size(); ++i) {
+        auto &b = budgets[i];
+        heaps.push_back({
+            .deviceLocal = bool(memProps_.memoryHeaps[i].flags & vk::MemoryHeapFlagBits::eDeviceLocal),
+            .budget = b.budget,
+            .usage = b.usage,
+            .blockBytes = b.statistics.blockBytes,
+            .allocationBytes = b.statistics.allocationBytes,
+            .allocationCount = b.statistics.allocationCount,
+        });
+    }
+    return heaps;
+}
+
+auto Device::memoryReport() -> MemoryReport {
+    MemoryReport report;
+    report.heaps = heapStats();
+    memoryTracker_.collect(report);
+    return report;
+}
+
+auto Device::setMemoryBudgetCallback(MemoryBudgetCallback callback, float threshold) -> void {
+    std::scoped_lock lock{budgetMutex};
+    budgetCallback = std::move(callback);
+    budgetThreshold = threshold;
+    overBudget.clear();
+}
+
+auto Device::checkMemoryBudget() -> void {
+    vmaSetCurrentFrameIndex(*allocator_, ++memoryFrame);
+    auto heaps = heapStats();
+    // the callback runs unlocked so that it may free resources or replace itself.
+    MemoryBudgetCallback callback;
+    std::vector<uint32_t> crossed;
+    {
+        std::scoped_lock lock{budgetMutex};
+        callback = budgetCallback;
+        overBudget.resize(heaps.size());
+        for(auto i = 0u; i < heaps.size(); ++i) {
+            auto &heap = heaps[i];
+            auto over = heap.budget > 0 && double(heap.usage) > double(heap.budget) * budgetThreshold;
+            if(over && !overBudget[i]) crossed.push_back(i);
+            overBudget[i] = over;
+        }
+    }
+    for(auto i: crossed) {
+        auto &heap = heaps[i];
+        debugLog("memory heap ", i, " uses ", heap.usage, " of its ", heap.budget, " bytes budget");
+        if(callback) callback(i, heap);
+    }
+}
+
 void Device::execSync(const std::function<void(vk::CommandBuffer)> &func, uint32_t queueIdx, uint64_t timeout) {
+    std::scoped_lock lock{execMutex};
     executeImmediately(*device_, *cmdPool_, queues_[queueIdx], func, timeout);
 }
 
@@ -246,6 +505,24 @@ auto Device::multiviewProperties() -> const vk::PhysicalDeviceMultiviewPropertie
 auto Device::queues() -> std::span<vk::Queue> { return queues_; }
 auto Device::cmdPool() -> vk::CommandPool { return *cmdPool_; }
 auto Device::queueFamiliy() const -> uint32_t { return queueFamily_; }
+auto Device::computeQueueFamily() const -> uint32_t { return computeQueueFamily_; }
+auto Device::computeQueues() -> std::span<vk::Queue> {
+    if(!supported_.asyncCompute) return queues_;
+    return computeQueues_;
+}
+auto Device::computeCmdPool() -> vk::CommandPool {
+    if(!supported_.asyncCompute) return *cmdPool_;
+    return *computeCmdPool_;
+}
+auto Device::gpuTimestamp() -> uint64_t {
+    if(!supported_.calibratedTimestamps) return 0;
+    vk::CalibratedTimestampInfoEXT info{vk::TimeDomainEXT::eDevice};
+    uint64_t timestamp{0}, maxDeviation{0};
+    VULKAN_HPP_DEFAULT_DISPATCHER.vkGetCalibratedTimestampsEXT(
+        VkDevice(*device_), 1, reinterpret_cast<const VkCalibratedTimestampInfoEXT *>(&info), &timestamp,
+        &maxDeviation);
+    return timestamp;
+}
 auto Device::supported() const -> const Device::SupportedExtension & { return supported_; }
 
 }
\ No newline at end of file
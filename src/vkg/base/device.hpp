@@ -4,10 +4,22 @@
 #include <tuple>
 #include <functional>
 #include "instance.hpp"
+#include "memory_report.hpp"
 #include <span>
+#include <mutex>
+#include <memory>
+#include <unordered_map>
 
 namespace vkg {
 
+class DescriptorHeap;
+
+struct SemaphoreWait {
+    vk::Semaphore semaphore;
+    uint64_t value{0};
+    vk::PipelineStageFlags stage;
+};
+
 class Device {
 public:
     struct SupportedExtension {
@@ -16,9 +28,13 @@ public:
         bool externalSync{false};
         bool timelineSemaphore{false};
         bool samplerAnisotropy{false};
+        bool asyncCompute{false};
+        bool calibratedTimestamps{false};
+        bool memoryBudget{false};
     };
 
     Device(Instance &instance, vk::SurfaceKHR surface, const FeatureConfig &featureConfig);
+    ~Device();
 
     void execSync(
         const std::function<void(vk::CommandBuffer cb)> &func, uint32_t queueIdx,
@@ -37,6 +53,52 @@ public:
     auto queueFamiliy() const -> uint32_t;
     auto queues() -> std::span<vk::Queue>;
     auto cmdPool() -> vk::CommandPool;
+    /**
+     * dedicated compute queue family. Same as `queueFamiliy()` if async compute is not supported.
+     */
+    auto computeQueueFamily() const -> uint32_t;
+    auto computeQueues() -> std::span<vk::Queue>;
+    auto computeCmdPool() -> vk::CommandPool;
+    /**
+     * current value of the device's timestamp clock, or 0 if calibrated timestamps aren't supported.
+     */
+    auto gpuTimestamp() -> uint64_t;
+    /**
+     * pipeline cache shared by all pipeline makers. It is loaded from `FeatureConfig::pipelineCachePath`
+     * if the file was written by the same driver and device, and saved back when the device is destroyed.
+     */
+    auto pipelineCache() -> vk::PipelineCache;
+    auto savePipelineCache() -> void;
+    /**
+     * bindless descriptor set shared by all passes, created on first use. Requires the update-after-bind
+     * descriptor indexing features, see `SupportedExtension::descriptorIndexing`; passes fall back to
+     * their own descriptor sets without them.
+     */
+    auto descriptorHeap() -> DescriptorHeap &;
+    /** frees the descriptor heap slots of a resource being destroyed. Does nothing if the heap doesn't exist. */
+    auto evictDescriptors(vk::Buffer buffer) -> void;
+    auto evictDescriptors(vk::ImageView imageView) -> void;
+    auto evictDescriptors(vk::Sampler sampler) -> void;
+    /**
+     * sampler created with `info`, shared by every caller asking for the same parameters while it is
+     * in use. Drivers allow only a few thousand samplers, far fewer than a scene's textures.
+     */
+    auto sampler(const vk::SamplerCreateInfo &info) -> std::shared_ptr<vk::UniqueSampler>;
+    auto numSamplers() -> uint32_t;
+    /** named allocations of buffers, textures and transient heaps. */
+    auto memoryTracker() -> MemoryTracker &;
+    /**
+     * VMA statistics and budget of every memory heap, and the memory used by each tracked resource and
+     * category.
+     */
+    auto memoryReport() -> MemoryReport;
+    /**
+     * `callback` is called from `checkMemoryBudget` when a heap's usage goes above `threshold` of its
+     * budget, and again only after it dropped below.
+     */
+    auto setMemoryBudgetCallback(MemoryBudgetCallback callback, float threshold = 0.9f) -> void;
+    /** refresh the heap budgets and check them against the threshold. Called by `Base` every frame. */
+    auto checkMemoryBudget() -> void;
 
     void name(vk::Buffer object, const std::string &markerName);
     void name(vk::Image object, const std::string &markerName);
@@ -65,6 +127,25 @@ private:
 
     SupportedExtension supported_;
 
+    std::string pipelineCachePath;
+    vk::UniquePipelineCache pipelineCache_;
+    /** execSync may be called from passes compiled in parallel. */
+    std::mutex execMutex;
+    std::unique_ptr<DescriptorHeap> descriptorHeap_;
+    std::mutex heapMutex;
+    struct SamplerInfoHash {
+        auto operator()(const vk::SamplerCreateInfo &info) const -> size_t;
+    };
+    std::unordered_map<vk::SamplerCreateInfo, std::weak_ptr<vk::UniqueSampler>, SamplerInfoHash> samplers;
+    std::mutex samplerMutex;
+
+    MemoryTracker memoryTracker_;
+    uint32_t memoryFrame{0};
+    MemoryBudgetCallback budgetCallback;
+    float budgetThreshold{0.9f};
+    std::vector<bool> overBudget;
+    std::mutex budgetMutex;
+
     vk::PhysicalDeviceRayTracingPropertiesNV rtProperties_;
     vk::PhysicalDeviceMultiviewProperties multiviewProperties_;
 
@@ -73,8 +154,15 @@ private:
     std::vector<vk::Queue> queues_;
     vk::UniqueCommandPool cmdPool_;
 
+    uint32_t computeQueueFamily_{VK_QUEUE_FAMILY_IGNORED};
+    std::vector<vk::Queue> computeQueues_;
+    vk::UniqueCommandPool computeCmdPool_;
+
 private:
     void findQueueFamily();
+    void findComputeQueueFamily();
     void createAllocator();
+    void createPipelineCache();
+    auto heapStats() -> std::vector<MemoryHeapStats>;
 };
 }
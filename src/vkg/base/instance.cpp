@@ -17,8 +17,10 @@ Instance::Instance(FeatureConfig featureConfig) {
     for(auto extension: vk::enumerateInstanceExtensionProperties())
         allExtensions.insert(std::string((const char *)extension.extensionName));
     std::unordered_set<std::string> enabledExtensions;
-    auto winRequired = Window::requiredExtensions();
-    enabledExtensions.insert(winRequired.begin(), winRequired.end());
+    if(!featureConfig.headless) {
+        auto winRequired = Window::requiredExtensions();
+        enabledExtensions.insert(winRequired.begin(), winRequired.end());
+    }
 
     std::vector<const char *> layers;
     if(allExtensions.contains(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME)) {
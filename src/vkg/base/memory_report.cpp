@@ -0,0 +1,48 @@
+#include "memory_report.hpp"
+#include <algorithm>
+
+namespace vkg {
+auto memoryCategory(const vk::BufferCreateInfo &info, VmaMemoryUsage memoryUsage) -> MemoryCategory {
+    using vkBU = vk::BufferUsageFlagBits;
+    if(info.usage & (vkBU::eVertexBuffer | vkBU::eIndexBuffer | vkBU::eRayTracingNV)) return MemoryCategory::eGeometry;
+    if(memoryUsage == VMA_MEMORY_USAGE_GPU_TO_CPU) return MemoryCategory::eStaging;
+    if(info.usage & (vkBU::eUniformBuffer | vkBU::eStorageBuffer | vkBU::eIndirectBuffer | vkBU::eUniformTexelBuffer |
+                     vkBU::eStorageTexelBuffer))
+        return MemoryCategory::eDescriptors;
+    return MemoryCategory::eStaging;
+}
+
+auto memoryCategory(const vk::ImageCreateInfo &info) -> MemoryCategory {
+    using vkIU = vk::ImageUsageFlagBits;
+    if(info.usage & (vkIU::eColorAttachment | vkIU::eDepthStencilAttachment | vkIU::eInputAttachment))
+        return MemoryCategory::eRenderTargets;
+    return MemoryCategory::eTextures;
+}
+
+auto MemoryTracker::add(const std::string &name, MemoryCategory category, vk::DeviceSize bytes) -> void {
+    std::scoped_lock lock{mutex};
+    auto &entry = entries[{name, category}];
+    entry.bytes += bytes;
+    ++entry.count;
+}
+
+auto MemoryTracker::remove(const std::string &name, MemoryCategory category, vk::DeviceSize bytes) -> void {
+    std::scoped_lock lock{mutex};
+    auto it = entries.find({name, category});
+    if(it == entries.end()) return;
+    it->second.bytes -= std::min(it->second.bytes, bytes);
+    if(--it->second.count == 0) entries.erase(it);
+}
+
+auto MemoryTracker::collect(MemoryReport &report) const -> void {
+    std::scoped_lock lock{mutex};
+    report.categories.fill(0);
+    report.resources.clear();
+    report.resources.reserve(entries.size());
+    for(auto &[key, entry]: entries) {
+        report.categories[uint32_t(key.second)] += entry.bytes;
+        report.resources.push_back({key.first, key.second, entry.bytes, entry.count});
+    }
+    std::sort(report.resources.begin(), report.resources.end(), [](auto &a, auto &b) { return a.bytes > b.bytes; });
+}
+}
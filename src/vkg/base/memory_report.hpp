@@ -0,0 +1,77 @@
+#pragma once
+#include "vk_headers.hpp"
+#include <array>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace vkg {
+enum class MemoryCategory : uint32_t {
+    /** vertex, index and acceleration structure buffers. */
+    eGeometry,
+    /** uniform, storage and indirect buffers read through descriptors. */
+    eDescriptors,
+    /** sampled and storage images. */
+    eTextures,
+    /** attachments and the frame graph's transient heaps. */
+    eRenderTargets,
+    /** host visible buffers used for uploads and readbacks. */
+    eStaging,
+};
+constexpr uint32_t numMemoryCategories = 5;
+
+struct MemoryHeapStats {
+    bool deviceLocal{false};
+    /** bytes of this heap the process may use, as reported by `VK_EXT_memory_budget` if supported. */
+    vk::DeviceSize budget{0};
+    /** bytes of this heap used by the process, including other allocators. */
+    vk::DeviceSize usage{0};
+    /** bytes of the device memory blocks VMA allocated and of the allocations in them. */
+    vk::DeviceSize blockBytes{0};
+    vk::DeviceSize allocationBytes{0};
+    uint32_t allocationCount{0};
+};
+
+/** resources with the same name and category are summed up, e.g. the per frame copies of a buffer. */
+struct MemoryResourceStats {
+    std::string name;
+    MemoryCategory category{MemoryCategory::eDescriptors};
+    vk::DeviceSize bytes{0};
+    uint32_t count{0};
+};
+
+struct MemoryReport {
+    std::vector<MemoryHeapStats> heaps;
+    std::array<vk::DeviceSize, numMemoryCategories> categories{};
+    /** sorted by size, largest first. */
+    std::vector<MemoryResourceStats> resources;
+};
+
+/** called once when a heap's usage exceeds the threshold fraction of its budget. */
+using MemoryBudgetCallback = std::function<void(uint32_t heapIndex, const MemoryHeapStats &heap)>;
+
+auto memoryCategory(const vk::BufferCreateInfo &info, VmaMemoryUsage memoryUsage) -> MemoryCategory;
+auto memoryCategory(const vk::ImageCreateInfo &info) -> MemoryCategory;
+
+/**
+ * Bytes allocated by every named `Buffer`, `Texture` and transient heap that owns its memory. Aliased
+ * resources are accounted for by the heap they are bound to.
+ */
+class MemoryTracker {
+public:
+    auto add(const std::string &name, MemoryCategory category, vk::DeviceSize bytes) -> void;
+    auto remove(const std::string &name, MemoryCategory category, vk::DeviceSize bytes) -> void;
+    /** fills the categories and resources of `report`. */
+    auto collect(MemoryReport &report) const -> void;
+
+private:
+    struct Entry {
+        vk::DeviceSize bytes{0};
+        uint32_t count{0};
+    };
+    std::map<std::pair<std::string, MemoryCategory>, Entry> entries;
+    mutable std::mutex mutex;
+};
+}
@@ -17,6 +17,7 @@ auto ComputePipelineMaker::createUnique(vk::PipelineCache pipelineCache) -> vk::
     vk::ComputePipelineCreateInfo pipelineInfo;
     pipelineInfo.stage = stage;
     pipelineInfo.layout = layout_;
+    if(!pipelineCache) pipelineCache = device.pipelineCache();
     return device.vkDevice().createComputePipelineUnique(pipelineCache, pipelineInfo);
 }
 }
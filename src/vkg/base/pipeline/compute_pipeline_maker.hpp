@@ -13,6 +13,9 @@ public:
     explicit ComputePipelineMaker(Device &device);
     auto layout(vk::PipelineLayout layout) -> ComputePipelineMaker &;
     auto shader(Shader &&shader) -> ComputePipelineMaker &;
+    /**
+     * create the pipeline through `pipelineCache`, or the device's pipeline cache if null.
+     */
     auto createUnique(vk::PipelineCache pipelineCache = {}) -> vk::UniquePipeline;
 
 private:
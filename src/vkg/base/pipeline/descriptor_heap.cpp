@@ -0,0 +1,119 @@
+#include "descriptor_heap.hpp"
+#include "vkg/util/syntactic_sugar.hpp"
+#include <array>
+
+namespace vkg {
+namespace {
+/**
+ * the slot of `key`, and whether it was newly assigned and so needs to be written. Freed slots are
+ * reused first, their resources were destroyed so no pending work can still use them.
+ */
+template<typename Slots>
+auto slotOf(Slots &table, const typename Slots::Key &key, uint32_t max, const char *kind)
+    -> std::pair<uint32_t, bool> {
+    auto [it, inserted] = table.slots.try_emplace(key, 0);
+    if(!inserted) return {it->second, false};
+    if(!table.freed.empty()) {
+        it->second = table.freed.back();
+        table.freed.pop_back();
+    } else {
+        errorIf(table.next >= max, "descriptor heap is out of ", kind, " slots: ", max);
+        it->second = table.next++;
+    }
+    return {it->second, true};
+}
+
+template<typename Slots, typename Pred>
+auto evictIf(Slots &table, Pred pred) -> void {
+    std::erase_if(table.slots, [&](auto &entry) {
+        if(!pred(entry.first)) return false;
+        table.freed.push_back(entry.second);
+        return true;
+    });
+}
+}
+
+DescriptorHeap::DescriptorHeap(vk::Device device, const DescriptorHeapConfig &config)
+    : device{device}, config{config} {
+    using vkDT = vk::DescriptorType;
+    using vkFlag = vk::DescriptorBindingFlagBits;
+    // a slot is only written when assigned and is freed when its resource is destroyed, which the owner only
+    // does once no pending frame uses it. So a slot reused for another resource is no longer in use.
+    vk::DescriptorBindingFlags flags =
+        vkFlag::ePartiallyBound | vkFlag::eUpdateAfterBind | vkFlag::eUpdateUnusedWhilePending;
+    auto stages = vk::ShaderStageFlagBits::eAll;
+    layoutMaker.binding(stages, 0, vkDT::eStorageBuffer, config.maxBuffers, flags)
+        .binding(stages, 1, vkDT::eCombinedImageSampler, config.maxTextures, flags)
+        .binding(stages, 2, vkDT::eSampler, config.maxSamplers, flags);
+    setLayout_ = layoutMaker.createUnique(device);
+
+    std::array<vk::DescriptorPoolSize, 3> poolSizes{
+        vk::DescriptorPoolSize{vkDT::eStorageBuffer, config.maxBuffers},
+        vk::DescriptorPoolSize{vkDT::eCombinedImageSampler, config.maxTextures},
+        vk::DescriptorPoolSize{vkDT::eSampler, config.maxSamplers},
+    };
+    pool = device.createDescriptorPoolUnique(
+        {vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind, 1, uint32_t(poolSizes.size()), poolSizes.data()});
+    set_ = DescriptorSetMaker().layout(*setLayout_).create(device, *pool)[0];
+}
+
+auto DescriptorHeap::buffer(const BufferInfo &info) -> uint32_t {
+    std::scoped_lock lock{mutex};
+    auto [slot, added] = slotOf(buffers, {VkBuffer(info.buffer), info.offset, info.size}, config.maxBuffers, "buffer");
+    if(added) {
+        vk::DescriptorBufferInfo bufferInfo{info.buffer, info.offset, info.size};
+        device.updateDescriptorSets(
+            vk::WriteDescriptorSet{set_, 0, slot, 1, vk::DescriptorType::eStorageBuffer, nullptr, &bufferInfo},
+            nullptr);
+        ++numWrites_;
+    }
+    return slot;
+}
+
+auto DescriptorHeap::texture(const vk::DescriptorImageInfo &info) -> uint32_t {
+    std::scoped_lock lock{mutex};
+    auto [slot, added] = slotOf(
+        textures, {VkSampler(info.sampler), VkImageView(info.imageView), info.imageLayout}, config.maxTextures,
+        "texture");
+    if(added) {
+        device.updateDescriptorSets(
+            vk::WriteDescriptorSet{set_, 1, slot, 1, vk::DescriptorType::eCombinedImageSampler, &info}, nullptr);
+        ++numWrites_;
+    }
+    return slot;
+}
+
+auto DescriptorHeap::sampler(vk::Sampler sampler) -> uint32_t {
+    std::scoped_lock lock{mutex};
+    auto [slot, added] = slotOf(samplers, VkSampler(sampler), config.maxSamplers, "sampler");
+    if(added) {
+        vk::DescriptorImageInfo info{sampler};
+        device.updateDescriptorSets(
+            vk::WriteDescriptorSet{set_, 2, slot, 1, vk::DescriptorType::eSampler, &info}, nullptr);
+        ++numWrites_;
+    }
+    return slot;
+}
+
+auto DescriptorHeap::evict(vk::Buffer buffer) -> void {
+    std::scoped_lock lock{mutex};
+    evictIf(buffers, [&](auto &key) { return std::get<0>(key) == VkBuffer(buffer); });
+}
+
+auto DescriptorHeap::evict(vk::ImageView imageView) -> void {
+    std::scoped_lock lock{mutex};
+    evictIf(textures, [&](auto &key) { return std::get<1>(key) == VkImageView(imageView); });
+}
+
+auto DescriptorHeap::evict(vk::Sampler sampler) -> void {
+    std::scoped_lock lock{mutex};
+    evictIf(samplers, [&](auto &key) { return key == VkSampler(sampler); });
+}
+
+auto DescriptorHeap::setLayout() const -> vk::DescriptorSetLayout { return *setLayout_; }
+auto DescriptorHeap::set() const -> vk::DescriptorSet { return set_; }
+auto DescriptorHeap::numWrites() const -> uint64_t {
+    std::scoped_lock lock{mutex};
+    return numWrites_;
+}
+}
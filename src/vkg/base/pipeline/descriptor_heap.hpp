@@ -0,0 +1,65 @@
+#pragma once
+#include "descriptors.hpp"
+#include "vkg/base/resource/buffer.hpp"
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+namespace vkg {
+struct DescriptorHeapConfig {
+    uint32_t maxBuffers{4096};
+    uint32_t maxTextures{4096};
+    uint32_t maxSamplers{256};
+};
+
+/**
+ * One update-after-bind descriptor set shared by all passes, holding storage buffers (binding 0),
+ * combined image samplers (binding 1) and samplers (binding 2). A resource gets a stable slot the
+ * first time it is seen and is written only then, so passes bind the heap and push the slots
+ * instead of rewriting their own sets every frame. Slots are freed when their resource is destroyed,
+ * see `Device::evictDescriptors`, and reused by resources seen later.
+ *
+ * Shaders alias the buffer binding with whatever block types they need, e.g.
+ * `layout(set = 0, binding = 0) buffer Matrices { mat4 m[]; } matrices[];`.
+ */
+class DescriptorHeap {
+public:
+    DescriptorHeap(vk::Device device, const DescriptorHeapConfig &config);
+
+    /** slot of the buffer range, thread safe. */
+    auto buffer(const BufferInfo &info) -> uint32_t;
+    auto texture(const vk::DescriptorImageInfo &info) -> uint32_t;
+    auto sampler(vk::Sampler sampler) -> uint32_t;
+    /** free the slots of every range of the buffer. */
+    auto evict(vk::Buffer buffer) -> void;
+    /** free the slots of every texture using the image view. */
+    auto evict(vk::ImageView imageView) -> void;
+    auto evict(vk::Sampler sampler) -> void;
+
+    auto setLayout() const -> vk::DescriptorSetLayout;
+    auto set() const -> vk::DescriptorSet;
+    /** number of descriptors written since the heap was created. */
+    auto numWrites() const -> uint64_t;
+
+private:
+    vk::Device device;
+    DescriptorHeapConfig config;
+    DescriptorSetLayoutMaker layoutMaker;
+    vk::UniqueDescriptorSetLayout setLayout_;
+    vk::UniqueDescriptorPool pool;
+    vk::DescriptorSet set_;
+
+    template<typename K>
+    struct Slots {
+        using Key = K;
+        std::map<Key, uint32_t> slots;
+        std::vector<uint32_t> freed;
+        uint32_t next{0};
+    };
+    mutable std::mutex mutex;
+    Slots<std::tuple<VkBuffer, vk::DeviceSize, vk::DeviceSize>> buffers;
+    Slots<std::tuple<VkSampler, VkImageView, vk::ImageLayout>> textures;
+    Slots<VkSampler> samplers;
+    uint64_t numWrites_{0};
+};
+}
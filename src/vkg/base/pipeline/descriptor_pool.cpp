@@ -4,7 +4,7 @@ namespace vkg {
 
 auto DescriptorPoolMaker::pipelineLayout(const PipelineLayoutDef &def, uint32_t num) -> DescriptorPoolMaker & {
     for(auto setDef: def.layoutDef().allSetLayoutDefs())
-        add(*setDef, num);
+        if(setDef) add(*setDef, num);
     _numSets += def.numSets() * num;
     return *this;
 }
@@ -16,6 +16,7 @@ auto DescriptorPoolMaker::setLayout(const DescriptorSetDef &def, uint32_t num) -
 }
 
 void DescriptorPoolMaker::add(const DescriptorSetLayoutMaker &setDef, uint32_t num) {
+    updateAfterBind = updateAfterBind || setDef.isUpdateAfterBind();
     for(auto &binding: setDef.bindings())
         switch(binding.descriptorType) {
             case vk::DescriptorType::eSampler: _numSampler += binding.descriptorCount * num; break;
@@ -66,7 +67,9 @@ auto DescriptorPoolMaker::createUnique(vk::Device device) -> vk::UniqueDescripto
         poolSizes.emplace_back(vk::DescriptorType::eInlineUniformBlockEXT, _numInlineUniformBlock);
     if(_numAccelerationStructure > 0)
         poolSizes.emplace_back(vk::DescriptorType::eAccelerationStructureNV, _numAccelerationStructure);
-    vk::DescriptorPoolCreateInfo descriptorPoolInfo{{}, _numSets, (uint32_t)poolSizes.size(), poolSizes.data()};
+    vk::DescriptorPoolCreateFlags flags;
+    if(updateAfterBind) flags = vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind;
+    vk::DescriptorPoolCreateInfo descriptorPoolInfo{flags, _numSets, (uint32_t)poolSizes.size(), poolSizes.data()};
     return device.createDescriptorPoolUnique(descriptorPoolInfo);
 }
 }
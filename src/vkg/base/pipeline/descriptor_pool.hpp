@@ -17,5 +17,6 @@ private:
         _numUniformDynamic{0}, _numStorageBufferDynamic{0}, _numInputAttachment{0}, _numInlineUniformBlock{0},
         _numAccelerationStructure{0};
     uint32_t _numSets{0};
+    bool updateAfterBind{false};
 };
 }
\ No newline at end of file
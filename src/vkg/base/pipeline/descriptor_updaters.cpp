@@ -7,6 +7,12 @@ DescriptorUpdater::DescriptorUpdater(
     : layoutMaker{layoutMaker}, setUpdater{setUpdater}, binding{binding} {}
 
 auto DescriptorUpdater::descriptorCount() -> uint32_t & { return layoutMaker.descriptorCount(binding); }
+auto DescriptorUpdater::array(uint32_t maxCount, bool partiallyBound) -> void {
+    layoutMaker.descriptorCount(binding) = maxCount;
+    if(partiallyBound)
+        layoutMaker.bindingFlag(binding) |=
+            vk::DescriptorBindingFlagBits::ePartiallyBound | vk::DescriptorBindingFlagBits::eUpdateAfterBind;
+}
 
 BufferUpdater::BufferUpdater(
     DescriptorSetLayoutMaker &layoutMaker, DescriptorSetUpdater &setUpdater, uint32_t binding,
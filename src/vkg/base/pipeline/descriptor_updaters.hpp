@@ -10,6 +10,12 @@ public:
     const uint32_t binding;
 
     auto descriptorCount() -> uint32_t &;
+    /**
+     * makes the binding an array of `maxCount` descriptors. With `partiallyBound` the array is also
+     * partially bound and update-after-bind, so only the elements written so far need to be valid
+     * and the set can be extended one element at a time.
+     */
+    auto array(uint32_t maxCount, bool partiallyBound) -> void;
 
 protected:
     DescriptorSetLayoutMaker &layoutMaker;
@@ -1,5 +1,6 @@
 #include "descriptors.hpp"
 #include "vkg/util/syntactic_sugar.hpp"
+#include <algorithm>
 
 namespace vkg {
 auto DescriptorSetLayoutMaker::binding(
@@ -7,8 +8,6 @@ auto DescriptorSetLayoutMaker::binding(
     vk::DescriptorBindingFlags bindingFlag, const vk::Sampler *pImmutableSamplers) -> DescriptorSetLayoutMaker & {
     _bindings.emplace_back(binding, descriptorType, descriptorCount, stageFlags, pImmutableSamplers);
     bindingFlags.push_back(bindingFlag);
-    useDescriptorIndexing = bool(bindingFlag);
-    if(bindingFlag & vk::DescriptorBindingFlagBits::eUpdateAfterBind) updateAfterBind = true;
     errorIf(
         variableDescriptorBinding >= 0 && binding >= uint32_t(variableDescriptorBinding),
         "variable descriptor binding should be the largest binding!");
@@ -22,6 +21,11 @@ auto DescriptorSetLayoutMaker::binding(
 auto DescriptorSetLayoutMaker::bindings() const -> const std::vector<vk::DescriptorSetLayoutBinding> & {
     return _bindings;
 }
+auto DescriptorSetLayoutMaker::isUpdateAfterBind() const -> bool {
+    for(auto flag: bindingFlags)
+        if(flag & vk::DescriptorBindingFlagBits::eUpdateAfterBind) return true;
+    return false;
+}
 auto DescriptorSetLayoutMaker::variableDescriptorCount() -> uint32_t {
     return variableDescriptorBinding == -1 ? 0 : _bindings[variableDescriptorBinding].descriptorCount;
 }
@@ -31,12 +35,13 @@ auto DescriptorSetLayoutMaker::createUnique(vk::Device device) -> vk::UniqueDesc
     layoutCreateInfo.bindingCount = uint32_t(_bindings.size());
     layoutCreateInfo.pBindings = _bindings.data();
     vk::DescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsCreateInfo;
+    auto useDescriptorIndexing = std::any_of(bindingFlags.begin(), bindingFlags.end(), [](auto f) { return bool(f); });
     if(useDescriptorIndexing) {
         bindingFlagsCreateInfo.bindingCount = uint32_t(bindingFlags.size());
         bindingFlagsCreateInfo.pBindingFlags = bindingFlags.data();
         layoutCreateInfo.pNext = &bindingFlagsCreateInfo;
     }
-    if(updateAfterBind) layoutCreateInfo.flags = vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPool;
+    if(isUpdateAfterBind()) layoutCreateInfo.flags = vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPool;
     return device.createDescriptorSetLayoutUnique(layoutCreateInfo);
 }
 
@@ -61,6 +66,9 @@ auto DescriptorSetLayoutMaker::setAutoBindingIndex(uint32_t binding) -> Descript
 auto DescriptorSetLayoutMaker::descriptorCount(uint32_t binding) -> uint32_t & {
     return _bindings[binding].descriptorCount;
 }
+auto DescriptorSetLayoutMaker::bindingFlag(uint32_t binding) -> vk::DescriptorBindingFlags & {
+    return bindingFlags[binding];
+}
 
 auto DescriptorSetMaker::layout(vk::DescriptorSetLayout layout, uint32_t variableDescriptorCount)
     -> DescriptorSetMaker & {
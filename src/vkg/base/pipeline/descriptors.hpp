@@ -11,6 +11,7 @@ public:
         const vk::Sampler *pImmutableSamplers = nullptr) -> DescriptorSetLayoutMaker &;
 
     auto bindings() const -> const std::vector<vk::DescriptorSetLayoutBinding> &;
+    auto isUpdateAfterBind() const -> bool;
     auto variableDescriptorCount() -> uint32_t;
 
     auto createUnique(vk::Device device) -> vk::UniqueDescriptorSetLayout;
@@ -25,12 +26,11 @@ public:
     auto setAutoBindingIndex(uint32_t binding) -> DescriptorSetLayoutMaker &;
 
     auto descriptorCount(uint32_t binding) -> uint32_t &;
+    auto bindingFlag(uint32_t binding) -> vk::DescriptorBindingFlags &;
 
 private:
     std::vector<vk::DescriptorSetLayoutBinding> _bindings;
     std::vector<vk::DescriptorBindingFlags> bindingFlags;
-    bool useDescriptorIndexing{false};
-    bool updateAfterBind{false};
     int variableDescriptorBinding{-1};
     uint32_t autoBinding_{0};
 };
@@ -2,7 +2,7 @@
 #include "shaders.hpp"
 
 namespace vkg {
-GraphicsPipelineMaker::GraphicsPipelineMaker(vk::Device device): device(device) {}
+GraphicsPipelineMaker::GraphicsPipelineMaker(Device &device): device(device) {}
 
 auto GraphicsPipelineMaker::vertexInput(std::initializer_list<VertexInputBinding> bindings) -> GraphicsPipelineMaker & {
     for(const auto &binding: bindings) {
@@ -261,7 +261,7 @@ auto GraphicsPipelineMaker::createUnique(vk::PipelineCache pipelineCache) -> vk:
         const vk::SpecializationInfo *pSpecializationInfo{nullptr};
         specializations.push_back(shader.specializationInfo());
         pSpecializationInfo = &specializations.back();
-        shader.make(device);
+        shader.make(device.vkDevice());
         stages.push_back(
             vk::PipelineShaderStageCreateInfo{{}, stage, shader.shaderModule(), "main", pSpecializationInfo});
     }
@@ -295,7 +295,8 @@ auto GraphicsPipelineMaker::createUnique(vk::PipelineCache pipelineCache) -> vk:
         _renderPass,
         _subpass};
 
-    return device.createGraphicsPipelineUnique(pipelineCache, pipelineInfo);
+    if(!pipelineCache) pipelineCache = device.pipelineCache();
+    return device.vkDevice().createGraphicsPipelineUnique(pipelineCache, pipelineInfo);
 }
 
 }
\ No newline at end of file
@@ -40,7 +40,7 @@ class GraphicsPipelineMaker: SpecializationMaker {
     friend class BlendColorAttachmentMaker;
 
 public:
-    explicit GraphicsPipelineMaker(vk::Device device);
+    explicit GraphicsPipelineMaker(Device &device);
     auto vertexInput(std::initializer_list<VertexInputBinding> bindings) -> GraphicsPipelineMaker &;
     auto vertexInputAuto(std::initializer_list<VertexInputAutoBinding> bindings) -> GraphicsPipelineMaker &;
     auto vertexInputBinding(const vk::VertexInputBindingDescription &binding) -> GraphicsPipelineMaker &;
@@ -96,10 +96,13 @@ public:
 
     auto clearShader(vk::ShaderStageFlagBits shaderStage) -> GraphicsPipelineMaker &;
 
+    /**
+     * create the pipeline through `pipelineCache`, or the device's pipeline cache if null.
+     */
     auto createUnique(vk::PipelineCache pipelineCache = {}) -> vk::UniquePipeline;
 
 private:
-    vk::Device device;
+    Device &device;
 
     std::map<vk::ShaderStageFlagBits, Shader> shaders;
     std::vector<vk::VertexInputBindingDescription> _vertexBindings;
@@ -72,7 +72,8 @@ auto RayTracingPipelineMaker::createUnique(
                                             maxRecursionDepth_,
                                             pipelineLayout};
 
-    vk::UniquePipeline pipeline = device.vkDevice().createRayTracingPipelineNVUnique(pipelineCache, info);
+    vk::UniquePipeline pipeline = device.vkDevice().createRayTracingPipelineNVUnique(
+        pipelineCache ? pipelineCache : device.pipelineCache(), info);
 
     auto shaderGroupHandleSize = device.rayTracingProperties().shaderGroupHandleSize;
     auto shaderGroupBaseAlignment = device.rayTracingProperties().shaderGroupBaseAlignment;
@@ -0,0 +1,165 @@
+#include "shader_reflection.hpp"
+#include "vkg/util/syntactic_sugar.hpp"
+#include <algorithm>
+#include <cstring>
+#include <spirv_cross.hpp>
+
+namespace vkg {
+namespace {
+auto specializedValue(
+    const spirv_cross::Compiler &compiler, uint32_t id, const vk::SpecializationInfo &sp) -> uint32_t {
+    if(compiler.has_decoration(id, spv::DecorationSpecId)) {
+        auto constantID = compiler.get_decoration(id, spv::DecorationSpecId);
+        for(auto i = 0u; i < sp.mapEntryCount; ++i) {
+            auto &entry = sp.pMapEntries[i];
+            if(entry.constantID != constantID) continue;
+            uint32_t value{0};
+            auto *data = static_cast<const std::byte *>(sp.pData) + entry.offset;
+            std::memcpy(&value, data, std::min(entry.size, sizeof(value)));
+            return value;
+        }
+    }
+    return compiler.get_constant(id).scalar();
+}
+
+auto arrayCount(
+    const spirv_cross::Compiler &compiler, const spirv_cross::SPIRType &type, const vk::SpecializationInfo &sp)
+    -> uint32_t {
+    uint32_t count{1};
+    for(auto i = 0u; i < type.array.size(); ++i)
+        count *= type.array_size_literal[i] ? type.array[i] : specializedValue(compiler, type.array[i], sp);
+    return count;
+}
+}
+
+auto ShaderReflection::add(
+    vk::ShaderStageFlagBits stage, std::span<const uint32_t> opcodes, const vk::SpecializationInfo &sp)
+    -> ShaderReflection & {
+    spirv_cross::Compiler compiler{opcodes.data(), opcodes.size()};
+    auto resources = compiler.get_shader_resources();
+
+    auto addBindings = [&](const auto &list, auto typeOf) {
+        for(auto &r: list) {
+            auto &type = compiler.get_type(r.type_id);
+            ReflectedBinding binding{
+                .set = compiler.get_decoration(r.id, spv::DecorationDescriptorSet),
+                .binding = compiler.get_decoration(r.id, spv::DecorationBinding),
+                .type = typeOf(type),
+                .count = arrayCount(compiler, type, sp),
+                .stages = stage,
+            };
+            auto [it, inserted] = bindings_.try_emplace({binding.set, binding.binding}, binding);
+            if(inserted) continue;
+            auto &existing = it->second;
+            errorIf(
+                existing.type != binding.type || existing.count != binding.count, "set ", binding.set, " binding ",
+                binding.binding, " is declared differently across stages");
+            existing.stages |= stage;
+        }
+    };
+    using vkDT = vk::DescriptorType;
+    auto fixed = [](vkDT type) { return [type](const spirv_cross::SPIRType &) { return type; }; };
+    auto image = [](vkDT image, vkDT texel) {
+        return [=](const spirv_cross::SPIRType &type) { return type.image.dim == spv::DimBuffer ? texel : image; };
+    };
+    addBindings(resources.uniform_buffers, fixed(vkDT::eUniformBuffer));
+    addBindings(resources.storage_buffers, fixed(vkDT::eStorageBuffer));
+    addBindings(resources.sampled_images, image(vkDT::eCombinedImageSampler, vkDT::eUniformTexelBuffer));
+    addBindings(resources.separate_images, image(vkDT::eSampledImage, vkDT::eUniformTexelBuffer));
+    addBindings(resources.storage_images, image(vkDT::eStorageImage, vkDT::eStorageTexelBuffer));
+    addBindings(resources.separate_samplers, fixed(vkDT::eSampler));
+    addBindings(resources.subpass_inputs, fixed(vkDT::eInputAttachment));
+    addBindings(resources.acceleration_structures, fixed(vkDT::eAccelerationStructureNV));
+
+    for(auto &r: resources.push_constant_buffers) {
+        auto size = uint32_t(compiler.get_declared_struct_size(compiler.get_type(r.base_type_id)));
+        auto offset = size;
+        for(auto &range: compiler.get_active_buffer_ranges(r.id))
+            offset = std::min(offset, uint32_t(range.offset));
+        if(offset == size) offset = 0;
+        if(!pushConstant) pushConstant = vk::PushConstantRange{stage, offset, size - offset};
+        else {
+            auto end = std::max(pushConstant->offset + pushConstant->size, size);
+            pushConstant->stageFlags |= stage;
+            pushConstant->offset = std::min(pushConstant->offset, offset);
+            pushConstant->size = end - pushConstant->offset;
+        }
+    }
+
+    for(auto &c: compiler.get_specialization_constants()) {
+        auto &name = compiler.get_name(c.id);
+        if(!name.empty()) constants[name] = c.constant_id;
+    }
+    return *this;
+}
+
+auto ShaderReflection::numSets() const -> uint32_t {
+    return bindings_.empty() ? 0 : bindings_.rbegin()->first.first + 1;
+}
+
+auto ShaderReflection::bindings(uint32_t set) const -> std::vector<ReflectedBinding> {
+    std::vector<ReflectedBinding> result;
+    for(auto &[key, binding]: bindings_)
+        if(key.first == set) result.push_back(binding);
+    return result;
+}
+
+auto ShaderReflection::pushConstants() const -> std::vector<vk::PushConstantRange> {
+    if(!pushConstant) return {};
+    return {*pushConstant};
+}
+
+auto ShaderReflection::constantID(const std::string &name) const -> std::optional<uint32_t> {
+    auto it = constants.find(name);
+    if(it == constants.end()) return std::nullopt;
+    return it->second;
+}
+
+ReflectedPipelineLayoutDef::ReflectedPipelineLayoutDef(const ShaderReflection &reflection) {
+    sets.resize(reflection.numSets());
+    for(auto i = 0u; i < sets.size(); ++i)
+        sets[i] = reflection.bindings(i);
+    for(auto &range: reflection.pushConstants())
+        layoutMaker.pushConstant(range);
+}
+
+auto ReflectedPipelineLayoutDef::descriptorCount(uint32_t set, uint32_t binding, uint32_t count)
+    -> ReflectedPipelineLayoutDef & {
+    for(auto &b: sets.at(set))
+        if(b.binding == binding) b.count = count;
+    return *this;
+}
+
+auto ReflectedPipelineLayoutDef::bindingFlags(uint32_t set, uint32_t binding, vk::DescriptorBindingFlags flag)
+    -> ReflectedPipelineLayoutDef & {
+    flags[{set, binding}] = flag;
+    return *this;
+}
+
+auto ReflectedPipelineLayoutDef::init(vk::Device device) -> void {
+    device_ = device;
+    setMakers.resize(sets.size());
+    for(auto i = 0u; i < sets.size(); ++i) {
+        for(auto &b: sets[i]) {
+            errorIf(b.count == 0, "set ", i, " binding ", b.binding, " is a runtime array without descriptor count");
+            auto it = flags.find({i, b.binding});
+            auto flag = it == flags.end() ? vk::DescriptorBindingFlags{} : it->second;
+            setMakers[i].binding(b.stages, b.binding, b.type, b.count, flag);
+        }
+        setLayouts.push_back(setMakers[i].createUnique(device));
+        layoutMaker.update(layoutMaker.add({}), *setLayouts[i], setMakers[i]);
+    }
+    pipelineLayout = layoutMaker.createUnique(device);
+}
+
+auto ReflectedPipelineLayoutDef::setLayout(uint32_t set) const -> vk::DescriptorSetLayout {
+    return *setLayouts.at(set);
+}
+
+auto ReflectedPipelineLayoutDef::createSet(vk::DescriptorPool pool, uint32_t set) -> vk::DescriptorSet {
+    errorIf(!device_, "device is null, call init() first");
+    return DescriptorSetMaker()
+        .layout(*setLayouts.at(set), setMakers[set].variableDescriptorCount())
+        .create(device_, pool)[0];
+}
+}
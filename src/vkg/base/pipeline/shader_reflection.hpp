@@ -0,0 +1,66 @@
+#pragma once
+#include "pipeline_def.hpp"
+#include <map>
+#include <optional>
+#include <span>
+#include <string>
+
+namespace vkg {
+struct ReflectedBinding {
+    uint32_t set{0};
+    uint32_t binding{0};
+    vk::DescriptorType type{vk::DescriptorType::eUniformBuffer};
+    /** 0 for runtime sized arrays, see `ReflectedPipelineLayoutDef::descriptorCount`. */
+    uint32_t count{1};
+    vk::ShaderStageFlags stages;
+};
+
+/**
+ * Descriptor bindings, push constant ranges and named specialization constants read from the
+ * SPIR-V of every stage of a pipeline. Array sizes given by specialization constants are resolved
+ * with the values the pipeline is going to be specialized with.
+ */
+class ShaderReflection {
+public:
+    auto add(
+        vk::ShaderStageFlagBits stage, std::span<const uint32_t> opcodes, const vk::SpecializationInfo &sp = {})
+        -> ShaderReflection &;
+
+    auto numSets() const -> uint32_t;
+    auto bindings(uint32_t set) const -> std::vector<ReflectedBinding>;
+    /** the push constant blocks of all stages merged into one range. */
+    auto pushConstants() const -> std::vector<vk::PushConstantRange>;
+    /** constant_id of the specialization constant named `name`. */
+    auto constantID(const std::string &name) const -> std::optional<uint32_t>;
+
+private:
+    std::map<std::pair<uint32_t, uint32_t>, ReflectedBinding> bindings_;
+    std::map<std::string, uint32_t> constants;
+    std::optional<vk::PushConstantRange> pushConstant;
+};
+
+/**
+ * A `PipelineLayoutDef` built from `ShaderReflection` instead of `__set__` and `__push_constant__`
+ * declarations, so `DescriptorPoolMaker::pipelineLayout` works with it unchanged.
+ */
+class ReflectedPipelineLayoutDef: public PipelineLayoutDef {
+public:
+    explicit ReflectedPipelineLayoutDef(const ShaderReflection &reflection);
+
+    /** the count of a runtime sized array binding, must be set before `init`. */
+    auto descriptorCount(uint32_t set, uint32_t binding, uint32_t count) -> ReflectedPipelineLayoutDef &;
+    auto bindingFlags(uint32_t set, uint32_t binding, vk::DescriptorBindingFlags flags)
+        -> ReflectedPipelineLayoutDef &;
+
+    auto init(vk::Device device) -> void;
+    auto setLayout(uint32_t set) const -> vk::DescriptorSetLayout;
+    auto createSet(vk::DescriptorPool pool, uint32_t set) -> vk::DescriptorSet;
+
+private:
+    vk::Device device_;
+    std::vector<std::vector<ReflectedBinding>> sets;
+    std::map<std::pair<uint32_t, uint32_t>, vk::DescriptorBindingFlags> flags;
+    std::vector<DescriptorSetLayoutMaker> setMakers;
+    std::vector<vk::UniqueDescriptorSetLayout> setLayouts;
+};
+}
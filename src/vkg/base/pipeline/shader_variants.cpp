@@ -0,0 +1,40 @@
+#include "shader_variants.hpp"
+#include "shader_reflection.hpp"
+#include "vkg/util/syntactic_sugar.hpp"
+
+namespace vkg {
+ShaderVariants::ShaderVariants(std::span<const uint32_t> opcodes, const std::vector<std::string> &features)
+    : opcodes{opcodes} {
+    errorIf(features.size() > 32, "at most 32 features are supported");
+    ShaderReflection reflection;
+    reflection.add(vk::ShaderStageFlagBits::eAll, opcodes);
+    for(auto &feature: features) {
+        auto id = reflection.constantID(feature);
+        errorIf(!id, "shader has no specialization constant named ", feature);
+        featureIDs.push_back(*id);
+    }
+}
+
+auto ShaderVariants::numFeatures() const -> uint32_t { return uint32_t(featureIDs.size()); }
+
+auto PipelineVariants::factory(Factory factory) -> void {
+    std::scoped_lock lock{mutex};
+    factory_ = std::move(factory);
+    pipelines.clear();
+}
+
+auto PipelineVariants::get(uint32_t mask) -> vk::Pipeline {
+    std::scoped_lock lock{mutex};
+    auto &pipeline = pipelines[mask];
+    if(!pipeline) {
+        errorIf(!factory_, "pipeline variants have no factory");
+        pipeline = factory_(mask);
+    }
+    return *pipeline;
+}
+
+auto PipelineVariants::size() -> uint32_t {
+    std::scoped_lock lock{mutex};
+    return uint32_t(pipelines.size());
+}
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include "shaders.hpp"
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace vkg {
+/**
+ * Feature permutations of one shader, each feature a `bool` specialization constant looked up by
+ * name, so a new feature is a constant in the shader rather than another shader file.
+ */
+class ShaderVariants {
+public:
+    ShaderVariants(std::span<const uint32_t> opcodes, const std::vector<std::string> &features);
+
+    /**
+     * the shader with feature `i` enabled when bit `i` of `mask` is set. `spValues` specialize
+     * constant_id 0, 1, ... like `Shader` does and must not overlap the feature constants.
+     */
+    template<typename... Args>
+    auto shader(uint32_t mask, Args &&...spValues) const -> Shader {
+        Shader result{opcodes, std::forward<Args>(spValues)...};
+        for(auto i = 0u; i < featureIDs.size(); ++i)
+            result.constant(featureIDs[i], vk::Bool32((mask >> i) & 1u));
+        return result;
+    }
+
+    auto numFeatures() const -> uint32_t;
+
+private:
+    std::span<const uint32_t> opcodes;
+    std::vector<uint32_t> featureIDs;
+};
+
+/** Pipelines of the variants of one pipeline, each created the first time it is used. */
+class PipelineVariants {
+public:
+    using Factory = std::function<vk::UniquePipeline(uint32_t mask)>;
+
+    auto factory(Factory factory) -> void;
+    /** thread safe, so variants may be requested while recording in parallel. */
+    auto get(uint32_t mask) -> vk::Pipeline;
+    auto size() -> uint32_t;
+
+private:
+    Factory factory_;
+    std::mutex mutex;
+    std::unordered_map<uint32_t, vk::UniquePipeline> pipelines;
+};
+}
@@ -14,6 +14,12 @@ public:
         sp_(std::forward<Args>(spValues)...);
         specializationInfo_ = {uint32_t(spentries.size()), spentries.data(), spdata.size(), spdata.data()};
     }
+    /** adds a specialization constant with an explicit constant_id instead of the next position. */
+    template<typename T>
+    auto constant(uint32_t constantID, T value) {
+        entry(constantID, value);
+        specializationInfo_ = {uint32_t(spentries.size()), spentries.data(), spdata.size(), spdata.data()};
+    }
     auto specializationInfo() const -> vk::SpecializationInfo;
 
 private:
@@ -24,9 +30,11 @@ private:
         sp_(rest...);
     }
     template<typename T>
-    auto sp_(T &&data) {
+    auto sp_(T &&data) { entry(uint32_t(spentries.size()), data); }
+    template<typename T>
+    auto entry(uint32_t constantID, T data) {
         auto size = sizeof(T);
-        spentries.emplace_back(spentries.size(), spoffset, size);
+        spentries.emplace_back(constantID, spoffset, size);
         auto *p = reinterpret_cast<std::byte *>(&data);
         spdata.reserve(spdata.size() + size);
         for(size_t i = 0; i < size; i++)
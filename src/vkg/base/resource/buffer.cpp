@@ -1,11 +1,32 @@
 #include "buffer.hpp"
 #include "vkg/util/syntactic_sugar.hpp"
+#include <array>
 
 namespace vkg {
+namespace {
+/**
+ * buffers are accessed by both the graphics and the async compute queue families, often by passes that
+ * don't declare their accesses to the frame graph. Sharing them concurrently avoids queue family ownership
+ * transfers, which only matter for the compression of images.
+ */
+auto shareWithCompute(Device &device, vk::BufferCreateInfo &info, std::array<uint32_t, 2> &families) -> void {
+    if(!device.supported().asyncCompute || device.computeQueueFamily() == device.queueFamiliy()) return;
+    families = {device.queueFamiliy(), device.computeQueueFamily()};
+    info.sharingMode = vk::SharingMode::eConcurrent;
+    info.queueFamilyIndexCount = uint32_t(families.size());
+    info.pQueueFamilyIndices = families.data();
+}
+}
+
 Buffer::Buffer(Device &device, vk::BufferCreateInfo info, VmaAllocationCreateInfo allocInfo, const std::string &name) {
+    std::array<uint32_t, 2> families{};
+    shareWithCompute(device, info, families);
     this->info = info;
+    this->info.pQueueFamilyIndices = nullptr;
     vmaBuffer = UniquePtr(new VmaBuffer{device}, [=](VmaBuffer *ptr) {
         debugLog("deallocate buffer:", name, " ", VkBuffer(ptr->buffer));
+        ptr->vkezDevice.memoryTracker().remove(name, ptr->category, ptr->trackedBytes);
+        ptr->vkezDevice.evictDescriptors(ptr->buffer);
         vmaDestroyBuffer(ptr->vkezDevice.allocator(), VkBuffer(ptr->buffer), ptr->allocation);
         delete ptr;
     });
@@ -13,6 +34,9 @@ Buffer::Buffer(Device &device, vk::BufferCreateInfo info, VmaAllocationCreateInf
         device.allocator(), (VkBufferCreateInfo *)&info, &allocInfo, reinterpret_cast<VkBuffer *>(&(vmaBuffer->buffer)),
         &vmaBuffer->allocation, &alloc);
     errorIf(result != VK_SUCCESS, "failed to allocate buffer!");
+    vmaBuffer->category = memoryCategory(info, allocInfo.usage);
+    vmaBuffer->trackedBytes = alloc.size;
+    device.memoryTracker().add(name, vmaBuffer->category, alloc.size);
     debugLog(
         "allocate buffer:", name, " ", VkBuffer(vmaBuffer->buffer), "[", alloc.deviceMemory, "+", alloc.offset, "]");
     VkMemoryPropertyFlags memFlags;
@@ -22,6 +46,20 @@ Buffer::Buffer(Device &device, vk::BufferCreateInfo info, VmaAllocationCreateInf
     }
     device.name(bufferInfo().buffer, name);
 }
+Buffer::Buffer(Device &device, vk::BufferCreateInfo info, const std::string &name) {
+    std::array<uint32_t, 2> families{};
+    shareWithCompute(device, info, families);
+    this->info = info;
+    this->info.pQueueFamilyIndices = nullptr;
+    vmaBuffer = UniquePtr(new VmaBuffer{device}, [=](VmaBuffer *ptr) {
+        debugLog("destroy aliased buffer:", name, " ", VkBuffer(ptr->buffer));
+        ptr->vkezDevice.evictDescriptors(ptr->buffer);
+        vmaDestroyBuffer(ptr->vkezDevice.allocator(), VkBuffer(ptr->buffer), nullptr);
+        delete ptr;
+    });
+    vmaBuffer->buffer = device.vkDevice().createBuffer(info);
+    device.name(bufferInfo().buffer, name);
+}
 
 void Buffer::barrier(
     vk::CommandBuffer &cb, vk::AccessFlags srcAccessMask, vk::AccessFlags dstAccessMask,
@@ -37,4 +75,16 @@ auto Buffer::devMem() const -> std::pair<vk::DeviceMemory, vk::DeviceSize> {
     return {vk::DeviceMemory{alloc.deviceMemory}, alloc.offset};
 }
 auto Buffer::size() const -> vk::DeviceSize { return info.size; }
+auto Buffer::memoryRequirements() const -> vk::MemoryRequirements {
+    return device().vkDevice().getBufferMemoryRequirements(vmaBuffer->buffer);
+}
+auto Buffer::bind(VmaAllocation memory, vk::DeviceSize offset) -> void {
+    errorIf(vmaBuffer->allocation != nullptr, "buffer already owns its memory");
+    auto result = vmaBindBufferMemory2(device().allocator(), memory, offset, VkBuffer(vmaBuffer->buffer), nullptr);
+    errorIf(result != VK_SUCCESS, "failed to bind buffer memory!");
+    vmaGetAllocationInfo(device().allocator(), memory, &alloc);
+    debugLog("bind buffer: ", VkBuffer(vmaBuffer->buffer), "[", alloc.deviceMemory, "+", alloc.offset + offset, "]");
+    alloc.offset += offset;
+    alloc.size = info.size;
+}
 }
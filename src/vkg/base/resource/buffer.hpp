@@ -11,6 +11,11 @@ struct BufferInfo {
 class Buffer {
 public:
     Buffer(Device &device, vk::BufferCreateInfo info, VmaAllocationCreateInfo allocInfo, const std::string &name = "");
+    /**
+     * Create the buffer without backing memory. Memory is provided later by `bind`, which lets
+     * multiple buffers alias the same allocation.
+     */
+    Buffer(Device &device, vk::BufferCreateInfo info, const std::string &name = "");
 
     void barrier(
         vk::CommandBuffer &cb, vk::AccessFlags srcAccessMask, vk::AccessFlags dstAccessMask,
@@ -29,12 +34,16 @@ public:
     auto device() const -> Device &;
     auto devMem() const -> std::pair<vk::DeviceMemory, vk::DeviceSize>;
     auto size() const -> vk::DeviceSize;
+    auto memoryRequirements() const -> vk::MemoryRequirements;
+    auto bind(VmaAllocation memory, vk::DeviceSize offset) -> void;
 
 private:
     struct VmaBuffer {
         Device &vkezDevice;
         VmaAllocation allocation{nullptr};
         vk::Buffer buffer{nullptr};
+        MemoryCategory category{MemoryCategory::eDescriptors};
+        vk::DeviceSize trackedBytes{0};
     };
 
     using UniquePtr = std::unique_ptr<VmaBuffer, std::function<void(VmaBuffer *)>>;
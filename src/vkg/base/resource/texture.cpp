@@ -7,6 +7,9 @@ Texture::Texture(Device &device, vk::ImageCreateInfo info, VmaAllocationCreateIn
     this->info = info;
     vmaImage = UniquePtr(new VmaImage{device}, [=](VmaImage *ptr) {
         debugLog("deallocate image:", name, " ", VkImage(ptr->image));
+        ptr->vkezDevice.memoryTracker().remove(name, ptr->category, ptr->trackedBytes);
+        if(ptr->imageView) ptr->vkezDevice.evictDescriptors(*ptr->imageView);
+        ptr->imageView.reset();
         vmaDestroyImage(ptr->vkezDevice.allocator(), VkImage(ptr->image), ptr->allocation);
         delete ptr;
     });
@@ -14,6 +17,9 @@ Texture::Texture(Device &device, vk::ImageCreateInfo info, VmaAllocationCreateIn
         device.allocator(), reinterpret_cast<VkImageCreateInfo *>(&info), &allocInfo,
         reinterpret_cast<VkImage *>(&(vmaImage->image)), &vmaImage->allocation, &alloc);
     errorIf(result != VK_SUCCESS, "failed to allocate image!");
+    vmaImage->category = memoryCategory(info);
+    vmaImage->trackedBytes = alloc.size;
+    device.memoryTracker().add(name, vmaImage->category, alloc.size);
     debugLog("allocate image: ", name, " ", VkImage(vmaImage->image), "[", alloc.deviceMemory, "+", alloc.offset, "]");
     VkMemoryPropertyFlags memFlags;
     vmaGetMemoryTypeProperties(device.allocator(), alloc.memoryType, &memFlags);
@@ -22,6 +28,19 @@ Texture::Texture(Device &device, vk::ImageCreateInfo info, VmaAllocationCreateIn
     }
     device.name(image(), name);
 }
+Texture::Texture(Device &device, vk::ImageCreateInfo info, const std::string &name) {
+    currentLayout = info.initialLayout;
+    this->info = info;
+    vmaImage = UniquePtr(new VmaImage{device}, [=](VmaImage *ptr) {
+        debugLog("destroy aliased image:", name, " ", VkImage(ptr->image));
+        if(ptr->imageView) ptr->vkezDevice.evictDescriptors(*ptr->imageView);
+        ptr->imageView.reset();
+        vmaDestroyImage(ptr->vkezDevice.allocator(), VkImage(ptr->image), nullptr);
+        delete ptr;
+    });
+    vmaImage->image = device.vkDevice().createImage(info);
+    device.name(image(), name);
+}
 
 auto Texture::barrier(
     vk::ImageLayout newLayout, const vk::AccessFlags &dstAccess, vk::PipelineStageFlagBits dstStage,
@@ -43,7 +62,9 @@ void Texture::setImageView(vk::ImageViewType viewType, const vk::ImageAspectFlag
         {aspectMask, 0, info.mipLevels, 0, info.arrayLayers}};
     viewType_ = viewType;
     aspect_ = aspectMask;
-    imageView_ = vmaImage->vkezDevice.vkDevice().createImageViewUnique(viewCreateInfo);
+    auto &view = vmaImage->imageView;
+    if(view) vmaImage->vkezDevice.evictDescriptors(*view);
+    view = vmaImage->vkezDevice.vkDevice().createImageViewUnique(viewCreateInfo);
 }
 auto Texture::createLayerImageView(uint32_t layer) -> vk::UniqueImageView {
     vk::ImageViewCreateInfo viewCreateInfo{
@@ -56,12 +77,23 @@ auto Texture::createLayerImageView(uint32_t layer) -> vk::UniqueImageView {
     return vmaImage->vkezDevice.vkDevice().createImageViewUnique(viewCreateInfo);
 }
 auto Texture::setSampler(const vk::SamplerCreateInfo &samplerCreateInfo) -> void {
-    sampler_ = device().vkDevice().createSamplerUnique(samplerCreateInfo);
+    sampler_ = device().sampler(samplerCreateInfo);
+}
+auto Texture::memoryRequirements() const -> vk::MemoryRequirements {
+    return device().vkDevice().getImageMemoryRequirements(vmaImage->image);
+}
+auto Texture::bind(VmaAllocation memory, vk::DeviceSize offset) -> void {
+    errorIf(vmaImage->allocation != nullptr, "image already owns its memory");
+    auto result = vmaBindImageMemory2(device().allocator(), memory, offset, VkImage(vmaImage->image), nullptr);
+    errorIf(result != VK_SUCCESS, "failed to bind image memory!");
+    vmaGetAllocationInfo(device().allocator(), memory, &alloc);
+    debugLog("bind image: ", VkImage(vmaImage->image), "[", alloc.deviceMemory, "+", alloc.offset + offset, "]");
+    alloc.offset += offset;
 }
 auto Texture::image() const -> vk::Image { return vmaImage->image; }
 auto Texture::format() const -> vk::Format { return info.format; }
-auto Texture::sampler() const -> vk::Sampler { return *sampler_; }
-auto Texture::imageView() const -> vk::ImageView { return *imageView_; }
+auto Texture::sampler() const -> vk::Sampler { return sampler_ ? **sampler_ : vk::Sampler{}; }
+auto Texture::imageView() const -> vk::ImageView { return *vmaImage->imageView; }
 auto Texture::device() const -> Device & { return vmaImage->vkezDevice; }
 auto Texture::extent() const -> vk::Extent3D { return info.extent; }
 auto Texture::layout() const -> vk::ImageLayout { return currentLayout; }
@@ -6,6 +6,11 @@ namespace vkg {
 class Texture {
 public:
     Texture(Device &device, vk::ImageCreateInfo info, VmaAllocationCreateInfo allocInfo, const std::string &name = "");
+    /**
+     * Create the image without backing memory. Memory is provided later by `bind`, which lets
+     * multiple textures alias the same allocation.
+     */
+    Texture(Device &device, vk::ImageCreateInfo info, const std::string &name = "");
 
     template<class T = void>
     T *ptr() {
@@ -21,6 +26,8 @@ public:
     auto createLayerImageView(uint32_t layer) -> vk::UniqueImageView;
     auto recordLayout(vk::ImageLayout layout, vk::AccessFlags access, vk::PipelineStageFlags stage) -> void;
     auto setSampler(const vk::SamplerCreateInfo &samplerCreateInfo) -> void;
+    auto memoryRequirements() const -> vk::MemoryRequirements;
+    auto bind(VmaAllocation memory, vk::DeviceSize offset) -> void;
 
     auto device() const -> Device &;
     auto mipLevels() const -> uint32_t;
@@ -40,6 +47,10 @@ private:
         Device &vkezDevice;
         VmaAllocation allocation{nullptr};
         vk::Image image{nullptr};
+        MemoryCategory category{MemoryCategory::eTextures};
+        vk::DeviceSize trackedBytes{0};
+        /** destroyed with the image, after its descriptor heap slots are freed. */
+        vk::UniqueImageView imageView;
     };
 
     using UniquePtr = std::unique_ptr<VmaImage, std::function<void(VmaImage *)>>;
@@ -50,8 +61,8 @@ private:
     vk::ImageViewType viewType_;
     vk::ImageAspectFlags aspect_;
 
-    vk::UniqueImageView imageView_;
-    vk::UniqueSampler sampler_;
+    /** shared with every texture using the same sampler parameters, see `Device::sampler`. */
+    std::shared_ptr<vk::UniqueSampler> sampler_;
 
     vk::ImageLayout currentLayout;
     vk::AccessFlags srcAccess;
@@ -18,6 +18,20 @@ auto choosePresentMode(const std::vector<vk::PresentModeKHR> &presentModes, bool
     return modes.contains(preferredMode) ? preferredMode : *modes.begin();
 }
 
+auto supportsStorage(vk::PhysicalDevice physicalDevice, vk::Format format) -> bool {
+    auto features = physicalDevice.getFormatProperties(format).optimalTilingFeatures;
+    return bool(features & vk::FormatFeatureFlagBits::eStorageImage);
+}
+
+/**
+ * B8G8R8A8 isn't required to support storage images, offscreen images use R8G8B8A8 instead when it
+ * doesn't as they are never presented.
+ */
+auto chooseOffscreenFormat(vk::PhysicalDevice physicalDevice) -> vk::Format {
+    if(supportsStorage(physicalDevice, vk::Format::eB8G8R8A8Unorm)) return vk::Format::eB8G8R8A8Unorm;
+    return vk::Format::eR8G8B8A8Unorm;
+}
+
 auto chooseExtent(uint32_t width, uint32_t height, const vk::SurfaceCapabilitiesKHR &capabilities) -> vk::Extent2D {
     if(capabilities.currentExtent.width != std::numeric_limits<uint32_t>::max()) return capabilities.currentExtent;
     vk::Extent2D extent;
@@ -43,7 +57,40 @@ Swapchain::Swapchain(Device &device, vk::SurfaceKHR surface, const FeatureConfig
     auto cap = physicalDevice.getSurfaceCapabilitiesKHR(surface);
     imageCount_ = std::clamp(2u, cap.minImageCount, cap.maxImageCount);
 }
+Swapchain::Swapchain(Device &device, const FeatureConfig &featureConfig)
+    : device{device},
+      physicalDevice{device.physicalDevice()},
+      vkDevice{device.vkDevice()},
+      presentQueues{device.queues()},
+      presentMode{vk::PresentModeKHR::eImmediate},
+      surfaceFormat{chooseOffscreenFormat(device.physicalDevice()), vk::ColorSpaceKHR::eSrgbNonlinear},
+      imageCount_{featureConfig.numFrames} {}
+
 auto Swapchain::resize(uint32_t width, uint32_t height, bool vsync) -> void {
+    if(headless()) {
+        extent_ = vk::Extent2D{width, height};
+        images.resize(imageCount_);
+        imageViews.clear();
+        offscreenImages.resize(imageCount_);
+        usage_ = vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eStorage |
+                 vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst |
+                 vk::ImageUsageFlagBits::eTransferSrc;
+        for(auto i = 0u; i < imageCount_; i++) {
+            offscreenImages[i] = image::make2DTex(
+                toString("offscreen_", i), device, width, height, usage_, surfaceFormat.format);
+            images[i] = offscreenImages[i]->image();
+            device.execSync(
+                [&](vk::CommandBuffer cb) {
+                    image::setLayout(
+                        cb, images[i], vk::ImageLayout::eUndefined, presentLayout(),
+                        vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eMemoryRead);
+                },
+                0);
+        }
+        nextImage = 0;
+        version_++;
+        return;
+    }
     auto cap = physicalDevice.getSurfaceCapabilitiesKHR(surface);
     extent_ = chooseExtent(width, height, cap);
     auto presentModes = physicalDevice.getSurfacePresentModesKHR(surface);
@@ -56,9 +103,15 @@ auto Swapchain::resize(uint32_t width, uint32_t height, bool vsync) -> void {
     info.imageColorSpace = surfaceFormat.colorSpace;
     info.imageExtent = extent_;
     info.imageArrayLayers = 1;
-    info.imageUsage = vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eStorage |
-                      vk::ImageUsageFlagBits::eTransferDst;
+    info.imageUsage = vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferDst;
+    if(supportsStorage(physicalDevice, surfaceFormat.format) &&
+       (cap.supportedUsageFlags & vk::ImageUsageFlagBits::eStorage))
+        info.imageUsage |= vk::ImageUsageFlagBits::eStorage;
+    // frame readback copies or samples the presented image.
+    info.imageUsage |=
+        cap.supportedUsageFlags & (vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eSampled);
     info.imageSharingMode = vk::SharingMode::eExclusive;
+    usage_ = info.imageUsage;
 
     info.preTransform = cap.currentTransform;
     info.compositeAlpha = vk::CompositeAlphaFlagBitsKHR::eOpaque;
@@ -81,7 +134,7 @@ auto Swapchain::resize(uint32_t width, uint32_t height, bool vsync) -> void {
         device.execSync(
             [&](vk::CommandBuffer cb) {
                 image::setLayout(
-                    cb, images[i], vk::ImageLayout::eUndefined, vk::ImageLayout::ePresentSrcKHR,
+                    cb, images[i], vk::ImageLayout::eUndefined, presentLayout(),
                     vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eMemoryRead);
             },
             0);
@@ -90,11 +143,17 @@ auto Swapchain::resize(uint32_t width, uint32_t height, bool vsync) -> void {
 }
 
 auto Swapchain::acquireNextImage(vk::Semaphore imageAvailable, uint32_t &imageIndex) -> vk::Result {
+    if(headless()) {
+        imageIndex = nextImage;
+        nextImage = (nextImage + 1) % imageCount_;
+        return vk::Result::eSuccess;
+    }
     return vkDevice.acquireNextImageKHR(
         *swapchain, std::numeric_limits<uint64_t>::max(), imageAvailable, vk::Fence(), &imageIndex);
 }
 
 auto Swapchain::present(uint32_t frameIdx, uint32_t imageIdx, vk::Semaphore renderFinished) -> vk::Result {
+    if(headless()) return vk::Result::eSuccess;
     vk::PresentInfoKHR presentInfo;
     presentInfo.waitSemaphoreCount = 1;
     presentInfo.pWaitSemaphores = &renderFinished;
@@ -106,10 +165,17 @@ auto Swapchain::present(uint32_t frameIdx, uint32_t imageIdx, vk::Semaphore rend
 }
 auto Swapchain::imageCount() const -> uint32_t { return imageCount_; }
 auto Swapchain::image(uint32_t index) const -> vk::Image { return images[index]; }
-auto Swapchain::imageView(uint32_t index) const -> vk::ImageView { return *imageViews[index]; }
+auto Swapchain::imageView(uint32_t index) const -> vk::ImageView {
+    return headless() ? offscreenImages[index]->imageView() : *imageViews[index];
+}
 auto Swapchain::format() const -> vk::Format { return surfaceFormat.format; }
+auto Swapchain::usage() const -> vk::ImageUsageFlags { return usage_; }
 auto Swapchain::imageExtent() const -> vk::Extent2D { return extent_; }
 auto Swapchain::width() const -> uint32_t { return extent_.width; }
 auto Swapchain::height() const -> uint32_t { return extent_.height; }
 auto Swapchain::version() const -> uint64_t { return version_; }
+auto Swapchain::headless() const -> bool { return !surface; }
+auto Swapchain::presentLayout() const -> vk::ImageLayout {
+    return headless() ? vk::ImageLayout::eTransferSrcOptimal : vk::ImageLayout::ePresentSrcKHR;
+}
 }
\ No newline at end of file
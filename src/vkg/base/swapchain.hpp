@@ -3,11 +3,18 @@
 #include <vector>
 #include "vk_headers.hpp"
 #include "device.hpp"
+#include "resource/texture.hpp"
 
 namespace vkg {
 class Swapchain {
 public:
     Swapchain(Device &device, vk::SurfaceKHR surface, const FeatureConfig &featureConfig);
+    /**
+     * offscreen swapchain for headless rendering. Images are plain textures usable as transfer sources,
+     * acquired in turn, and presenting does nothing. They are B8G8R8A8Unorm, or R8G8B8A8Unorm if the
+     * former can't be used as a storage image.
+     */
+    Swapchain(Device &device, const FeatureConfig &featureConfig);
     auto resize(uint32_t width, uint32_t height, bool vsync) -> void;
 
     auto acquireNextImage(vk::Semaphore imageAvailable, uint32_t &imageIndex) -> vk::Result;
@@ -20,7 +27,15 @@ public:
     auto width() const -> uint32_t;
     auto height() const -> uint32_t;
     auto format() const -> vk::Format;
+    /** usage the images are created with, depends on what the surface supports. */
+    auto usage() const -> vk::ImageUsageFlags;
     auto version() const -> uint64_t;
+    auto headless() const -> bool;
+    /**
+     * layout images are left in after the frame: ePresentSrcKHR, or eTransferSrcOptimal when headless
+     * so they can be read back.
+     */
+    auto presentLayout() const -> vk::ImageLayout;
 
 private:
     Device &device;
@@ -36,10 +51,14 @@ private:
     vk::UniqueSwapchainKHR swapchain;
 
     vk::Extent2D extent_;
+    vk::ImageUsageFlags usage_;
     uint32_t imageCount_;
     std::vector<vk::Image> images;
     std::vector<vk::UniqueImageView> imageViews;
 
     uint64_t version_{0};
+
+    std::vector<std::unique_ptr<Texture>> offscreenImages;
+    uint32_t nextImage{0};
 };
 }
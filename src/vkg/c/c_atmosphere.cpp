@@ -48,6 +48,10 @@ double AtmosphereGetSunAngularRadius(CAtmosphereSetting *atmosphere) {
     auto *atmospher_ = reinterpret_cast<AtmosphereSetting *>(atmosphere);
     return atmospher_->sunAngularRadius();
 }
+void AtmosphereSetSunAngularRadius(CAtmosphereSetting *atmosphere, double sunAngularRadius) {
+    auto *atmospher_ = reinterpret_cast<AtmosphereSetting *>(atmosphere);
+    atmospher_->setSunAngularRadius(sunAngularRadius);
+}
 double AtmosphereGetSunSolidAngle(CAtmosphereSetting *atmosphere) {
     auto *atmospher_ = reinterpret_cast<AtmosphereSetting *>(atmosphere);
     return atmospher_->sunSolidAngle();
@@ -60,3 +64,23 @@ double AtmosphereGetBottomRadius(CAtmosphereSetting *atmosphere) {
     auto *atmospher_ = reinterpret_cast<AtmosphereSetting *>(atmosphere);
     return atmospher_->bottomRadius();
 }
+void AtmosphereSetBottomRadius(CAtmosphereSetting *atmosphere, double bottomRadius) {
+    auto *atmospher_ = reinterpret_cast<AtmosphereSetting *>(atmosphere);
+    atmospher_->setBottomRadius(bottomRadius);
+}
+double AtmosphereGetTopRadius(CAtmosphereSetting *atmosphere) {
+    auto *atmospher_ = reinterpret_cast<AtmosphereSetting *>(atmosphere);
+    return atmospher_->topRadius();
+}
+void AtmosphereSetTopRadius(CAtmosphereSetting *atmosphere, double topRadius) {
+    auto *atmospher_ = reinterpret_cast<AtmosphereSetting *>(atmosphere);
+    atmospher_->setTopRadius(topRadius);
+}
+uint32_t AtmosphereGetPrecomputeStepsPerFrame(CAtmosphereSetting *atmosphere) {
+    auto *atmospher_ = reinterpret_cast<AtmosphereSetting *>(atmosphere);
+    return atmospher_->precomputeStepsPerFrame();
+}
+void AtmosphereSetPrecomputeStepsPerFrame(CAtmosphereSetting *atmosphere, uint32_t steps) {
+    auto *atmospher_ = reinterpret_cast<AtmosphereSetting *>(atmosphere);
+    atmospher_->setPrecomputeStepsPerFrame(steps);
+}
@@ -28,9 +28,16 @@ float AtmosphereGetExposure(CAtmosphereSetting *atmosphere);
 void AtmosphereSetExposure(CAtmosphereSetting *atmosphere, float exposure);
 
 double AtmosphereGetSunAngularRadius(CAtmosphereSetting *atmosphere);
+void AtmosphereSetSunAngularRadius(CAtmosphereSetting *atmosphere, double sunAngularRadius);
 double AtmosphereGetSunSolidAngle(CAtmosphereSetting *atmosphere);
 double AtmosphereGetLengthUnitInMeters(CAtmosphereSetting *atmosphere);
 double AtmosphereGetBottomRadius(CAtmosphereSetting *atmosphere);
+void AtmosphereSetBottomRadius(CAtmosphereSetting *atmosphere, double bottomRadius);
+double AtmosphereGetTopRadius(CAtmosphereSetting *atmosphere);
+void AtmosphereSetTopRadius(CAtmosphereSetting *atmosphere, double topRadius);
+
+uint32_t AtmosphereGetPrecomputeStepsPerFrame(CAtmosphereSetting *atmosphere);
+void AtmosphereSetPrecomputeStepsPerFrame(CAtmosphereSetting *atmosphere, uint32_t steps);
 
 #ifdef __cplusplus
 }
@@ -46,6 +46,22 @@ void CameraSetZFar(CCamera *camera, float zFar) {
     auto *cam = reinterpret_cast<Camera *>(camera);
     cam->setZFar(zFar);
 }
+float CameraGetCullMinPixels(CCamera *camera) {
+    auto *cam = reinterpret_cast<Camera *>(camera);
+    return cam->cullMinPixels();
+}
+void CameraSetCullMinPixels(CCamera *camera, float minPixels) {
+    auto *cam = reinterpret_cast<Camera *>(camera);
+    cam->setCullMinPixels(minPixels);
+}
+float CameraGetCullMaxDistance(CCamera *camera) {
+    auto *cam = reinterpret_cast<Camera *>(camera);
+    return cam->cullMaxDistance();
+}
+void CameraSetCullMaxDistance(CCamera *camera, float maxDistance) {
+    auto *cam = reinterpret_cast<Camera *>(camera);
+    cam->setCullMaxDistance(maxDistance);
+}
 float CameraGetFov(CCamera *camera) {
     auto *cam = reinterpret_cast<Camera *>(camera);
     return cam->fov();
@@ -19,6 +19,10 @@ float CameraGetZNear(CCamera *camera);
 void CameraSetZNear(CCamera *camera, float zNear);
 float CameraGetZFar(CCamera *camera);
 void CameraSetZFar(CCamera *camera, float zFar);
+float CameraGetCullMinPixels(CCamera *camera);
+void CameraSetCullMinPixels(CCamera *camera, float minPixels);
+float CameraGetCullMaxDistance(CCamera *camera);
+void CameraSetCullMaxDistance(CCamera *camera, float maxDistance);
 float CameraGetFov(CCamera *camera);
 uint32_t CameraGetWidth(CCamera *camera);
 uint32_t CameraGetHeight(CCamera *camera);
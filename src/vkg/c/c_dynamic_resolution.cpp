@@ -0,0 +1,47 @@
+#include "c_dynamic_resolution.h"
+#include "vkg/render/model/dynamic_resolution.hpp"
+using namespace vkg;
+bool DynamicResolutionIsEnabled(CDynamicResolutionSetting *dynamicResolution) {
+    auto *dynamicResolution_ = reinterpret_cast<DynamicResolutionSetting *>(dynamicResolution);
+    return dynamicResolution_->isEnabled();
+}
+void DynamicResolutionEnable(CDynamicResolutionSetting *dynamicResolution, bool enabled) {
+    auto *dynamicResolution_ = reinterpret_cast<DynamicResolutionSetting *>(dynamicResolution);
+    dynamicResolution_->enable(enabled);
+}
+float DynamicResolutionGetTargetFrameTime(CDynamicResolutionSetting *dynamicResolution) {
+    auto *dynamicResolution_ = reinterpret_cast<DynamicResolutionSetting *>(dynamicResolution);
+    return dynamicResolution_->targetFrameTime();
+}
+void DynamicResolutionSetTargetFrameTime(CDynamicResolutionSetting *dynamicResolution, float frameTime) {
+    auto *dynamicResolution_ = reinterpret_cast<DynamicResolutionSetting *>(dynamicResolution);
+    dynamicResolution_->setTargetFrameTime(frameTime);
+}
+float DynamicResolutionGetMinScale(CDynamicResolutionSetting *dynamicResolution) {
+    auto *dynamicResolution_ = reinterpret_cast<DynamicResolutionSetting *>(dynamicResolution);
+    return dynamicResolution_->minScale();
+}
+void DynamicResolutionSetMinScale(CDynamicResolutionSetting *dynamicResolution, float minScale) {
+    auto *dynamicResolution_ = reinterpret_cast<DynamicResolutionSetting *>(dynamicResolution);
+    dynamicResolution_->setMinScale(minScale);
+}
+float DynamicResolutionGetMaxScale(CDynamicResolutionSetting *dynamicResolution) {
+    auto *dynamicResolution_ = reinterpret_cast<DynamicResolutionSetting *>(dynamicResolution);
+    return dynamicResolution_->maxScale();
+}
+void DynamicResolutionSetMaxScale(CDynamicResolutionSetting *dynamicResolution, float maxScale) {
+    auto *dynamicResolution_ = reinterpret_cast<DynamicResolutionSetting *>(dynamicResolution);
+    dynamicResolution_->setMaxScale(maxScale);
+}
+float DynamicResolutionGetSharpness(CDynamicResolutionSetting *dynamicResolution) {
+    auto *dynamicResolution_ = reinterpret_cast<DynamicResolutionSetting *>(dynamicResolution);
+    return dynamicResolution_->sharpness();
+}
+void DynamicResolutionSetSharpness(CDynamicResolutionSetting *dynamicResolution, float sharpness) {
+    auto *dynamicResolution_ = reinterpret_cast<DynamicResolutionSetting *>(dynamicResolution);
+    dynamicResolution_->setSharpness(sharpness);
+}
+float DynamicResolutionGetScale(CDynamicResolutionSetting *dynamicResolution) {
+    auto *dynamicResolution_ = reinterpret_cast<DynamicResolutionSetting *>(dynamicResolution);
+    return dynamicResolution_->scale();
+}
@@ -0,0 +1,34 @@
+#ifndef VKG_C_DYNAMIC_RESOLUTION_H
+#define VKG_C_DYNAMIC_RESOLUTION_H
+
+#ifdef __cplusplus
+extern "C" {
+#else
+    #include <stdbool.h>
+#endif
+
+struct CDynamicResolutionSetting;
+typedef struct CDynamicResolutionSetting CDynamicResolutionSetting;
+
+bool DynamicResolutionIsEnabled(CDynamicResolutionSetting *dynamicResolution);
+void DynamicResolutionEnable(CDynamicResolutionSetting *dynamicResolution, bool enabled);
+
+float DynamicResolutionGetTargetFrameTime(CDynamicResolutionSetting *dynamicResolution);
+void DynamicResolutionSetTargetFrameTime(CDynamicResolutionSetting *dynamicResolution, float frameTime);
+
+float DynamicResolutionGetMinScale(CDynamicResolutionSetting *dynamicResolution);
+void DynamicResolutionSetMinScale(CDynamicResolutionSetting *dynamicResolution, float minScale);
+
+float DynamicResolutionGetMaxScale(CDynamicResolutionSetting *dynamicResolution);
+void DynamicResolutionSetMaxScale(CDynamicResolutionSetting *dynamicResolution, float maxScale);
+
+float DynamicResolutionGetSharpness(CDynamicResolutionSetting *dynamicResolution);
+void DynamicResolutionSetSharpness(CDynamicResolutionSetting *dynamicResolution, float sharpness);
+
+float DynamicResolutionGetScale(CDynamicResolutionSetting *dynamicResolution);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //VKG_C_DYNAMIC_RESOLUTION_H
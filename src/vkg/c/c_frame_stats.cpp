@@ -0,0 +1,24 @@
+#include "c_frame_stats.h"
+#include "vkg/render/graph/frame_stats.hpp"
+#include <cstring>
+using namespace vkg;
+void DeleteFrameStats(CFrameStats *frameStats) { delete reinterpret_cast<FrameStats *>(frameStats); }
+uint32_t FrameStatsNumPasses(CFrameStats *frameStats) {
+    auto *frameStats_ = reinterpret_cast<FrameStats *>(frameStats);
+    return uint32_t(frameStats_->passes.size());
+}
+uint32_t FrameStatsGetPassNameLength(CFrameStats *frameStats, uint32_t passIdx) {
+    auto *frameStats_ = reinterpret_cast<FrameStats *>(frameStats);
+    return uint32_t(frameStats_->passes.at(passIdx).name.size());
+}
+void FrameStatsGetPassName(CFrameStats *frameStats, uint32_t passIdx, char *buf) {
+    auto *frameStats_ = reinterpret_cast<FrameStats *>(frameStats);
+    auto &name = frameStats_->passes.at(passIdx).name;
+    memcpy(buf, name.c_str(), name.size());
+}
+void FrameStatsGetPass(CFrameStats *frameStats, uint32_t passIdx, CPassStats *passStats) {
+    auto *frameStats_ = reinterpret_cast<FrameStats *>(frameStats);
+    auto &pass = frameStats_->passes.at(passIdx);
+    auto convert = [](const TimingStats &timing) { return CTimingStats{timing.min, timing.avg, timing.p99}; };
+    *passStats = {convert(pass.gpu), convert(pass.cpuCompile), convert(pass.cpuExecute)};
+}
@@ -0,0 +1,31 @@
+#ifndef VKG_C_FRAME_STATS_H
+#define VKG_C_FRAME_STATS_H
+
+#include <cstdint>
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct CFrameStats;
+typedef struct CFrameStats CFrameStats;
+
+typedef struct {
+    double min, avg, p99;
+} CTimingStats;
+
+typedef struct {
+    CTimingStats gpu;
+    CTimingStats cpuCompile;
+    CTimingStats cpuExecute;
+} CPassStats;
+
+void DeleteFrameStats(CFrameStats *frameStats);
+uint32_t FrameStatsNumPasses(CFrameStats *frameStats);
+uint32_t FrameStatsGetPassNameLength(CFrameStats *frameStats, uint32_t passIdx);
+void FrameStatsGetPassName(CFrameStats *frameStats, uint32_t passIdx, char *buf);
+void FrameStatsGetPass(CFrameStats *frameStats, uint32_t passIdx, CPassStats *passStats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif //VKG_C_FRAME_STATS_H
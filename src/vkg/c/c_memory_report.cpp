@@ -0,0 +1,44 @@
+#include "c_memory_report.h"
+#include "vkg/base/memory_report.hpp"
+#include "vkg/util/syntactic_sugar.hpp"
+#include <cstring>
+using namespace vkg;
+void DeleteMemoryReport(CMemoryReport *report) { delete reinterpret_cast<MemoryReport *>(report); }
+uint32_t MemoryReportNumHeaps(CMemoryReport *report) {
+    auto *report_ = reinterpret_cast<MemoryReport *>(report);
+    return uint32_t(report_->heaps.size());
+}
+void MemoryReportGetHeap(CMemoryReport *report, uint32_t heapIdx, CMemoryHeapStats *heap) {
+    auto *report_ = reinterpret_cast<MemoryReport *>(report);
+    auto &heap_ = report_->heaps.at(heapIdx);
+    *heap = {
+        .deviceLocal = heap_.deviceLocal,
+        .budget = heap_.budget,
+        .usage = heap_.usage,
+        .blockBytes = heap_.blockBytes,
+        .allocationBytes = heap_.allocationBytes,
+        .allocationCount = heap_.allocationCount,
+    };
+}
+uint64_t MemoryReportGetCategoryBytes(CMemoryReport *report, uint32_t category) {
+    auto *report_ = reinterpret_cast<MemoryReport *>(report);
+    return report_->categories.at(category);
+}
+uint32_t MemoryReportNumResources(CMemoryReport *report) {
+    auto *report_ = reinterpret_cast<MemoryReport *>(report);
+    return uint32_t(report_->resources.size());
+}
+uint32_t MemoryReportGetResourceNameLength(CMemoryReport *report, uint32_t resourceIdx) {
+    auto *report_ = reinterpret_cast<MemoryReport *>(report);
+    return uint32_t(report_->resources.at(resourceIdx).name.size());
+}
+void MemoryReportGetResourceName(CMemoryReport *report, uint32_t resourceIdx, char *buf) {
+    auto *report_ = reinterpret_cast<MemoryReport *>(report);
+    auto &name = report_->resources.at(resourceIdx).name;
+    memcpy(buf, name.c_str(), name.size());
+}
+void MemoryReportGetResource(CMemoryReport *report, uint32_t resourceIdx, CMemoryResourceStats *resource) {
+    auto *report_ = reinterpret_cast<MemoryReport *>(report);
+    auto &resource_ = report_->resources.at(resourceIdx);
+    *resource = {value(resource_.category), resource_.bytes, resource_.count};
+}
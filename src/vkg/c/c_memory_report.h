@@ -0,0 +1,42 @@
+#ifndef VKG_C_MEMORY_REPORT_H
+#define VKG_C_MEMORY_REPORT_H
+
+#include <cstdint>
+#ifdef __cplusplus
+extern "C" {
+#else
+    #include <stdbool.h>
+#endif
+
+struct CMemoryReport;
+typedef struct CMemoryReport CMemoryReport;
+
+typedef struct {
+    bool deviceLocal;
+    uint64_t budget;
+    uint64_t usage;
+    uint64_t blockBytes;
+    uint64_t allocationBytes;
+    uint32_t allocationCount;
+} CMemoryHeapStats;
+
+/** 0: geometry, 1: descriptors, 2: textures, 3: render targets, 4: staging */
+typedef struct {
+    uint32_t category;
+    uint64_t bytes;
+    uint32_t count;
+} CMemoryResourceStats;
+
+void DeleteMemoryReport(CMemoryReport *report);
+uint32_t MemoryReportNumHeaps(CMemoryReport *report);
+void MemoryReportGetHeap(CMemoryReport *report, uint32_t heapIdx, CMemoryHeapStats *heap);
+uint64_t MemoryReportGetCategoryBytes(CMemoryReport *report, uint32_t category);
+uint32_t MemoryReportNumResources(CMemoryReport *report);
+uint32_t MemoryReportGetResourceNameLength(CMemoryReport *report, uint32_t resourceIdx);
+void MemoryReportGetResourceName(CMemoryReport *report, uint32_t resourceIdx, char *buf);
+void MemoryReportGetResource(CMemoryReport *report, uint32_t resourceIdx, CMemoryResourceStats *resource);
+
+#ifdef __cplusplus
+}
+#endif
+#endif //VKG_C_MEMORY_REPORT_H
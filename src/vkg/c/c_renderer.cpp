@@ -12,6 +12,11 @@ CRenderer *NewRenderer(CWindowConfig windowConfig, CFeatureConfig featureConfig)
         .vsync = featureConfig.vsync,
         .numFrames = featureConfig.numFrames,
         .rayTrace = featureConfig.rayTrace,
+        .asyncCompute = featureConfig.asyncCompute,
+        .recordThreads = featureConfig.recordThreads,
+        .headless = featureConfig.headless,
+        .pipelineCachePath = featureConfig.pipelineCachePath ? featureConfig.pipelineCachePath : "",
+        .atmosphereCacheDir = featureConfig.atmosphereCacheDir ? featureConfig.atmosphereCacheDir : "",
     };
     return reinterpret_cast<CRenderer *>(new Renderer{windowConfig_, featureConfig_});
 }
@@ -25,6 +30,10 @@ void RendererLoopUpdater(CRenderer *renderer, CCallFrameUpdater *updater) {
     auto *updater_ = reinterpret_cast<CallFrameUpdater *>(updater);
     renderer_->loop(*updater_);
 }
+uint32_t RendererRenderFrame(CRenderer *renderer, double elapsedMs) {
+    auto *renderer_ = reinterpret_cast<Renderer *>(renderer);
+    return renderer_->renderFrame(elapsedMs);
+}
 
 CWindow *RendererGetWindow(CRenderer *renderer) {
     auto *renderer_ = reinterpret_cast<Renderer *>(renderer);
@@ -36,6 +45,53 @@ CScene *RendererAddScene(CRenderer *renderer, CSceneConfig sceneConfig, char *na
     auto sceneConfig_ = *(SceneConfig *)&sceneConfig;
     return reinterpret_cast<CScene *>(&renderer_->addScene(sceneConfig_, std::string{nameBuf, size}));
 }
+CFrameStats *RendererGetFrameStats(CRenderer *renderer) {
+    auto *renderer_ = reinterpret_cast<Renderer *>(renderer);
+    return reinterpret_cast<CFrameStats *>(new FrameStats{renderer_->frameStats()});
+}
+CMemoryReport *RendererGetMemoryReport(CRenderer *renderer) {
+    auto *renderer_ = reinterpret_cast<Renderer *>(renderer);
+    return reinterpret_cast<CMemoryReport *>(new MemoryReport{renderer_->device().memoryReport()});
+}
+void RendererSetMemoryBudgetCallback(
+    CRenderer *renderer, float threshold, CMemoryBudgetCallback callback, void *data) {
+    auto *renderer_ = reinterpret_cast<Renderer *>(renderer);
+    renderer_->device().setMemoryBudgetCallback(
+        [=](uint32_t heapIdx, const MemoryHeapStats &heap) {
+            CMemoryHeapStats heap_{
+                .deviceLocal = heap.deviceLocal,
+                .budget = heap.budget,
+                .usage = heap.usage,
+                .blockBytes = heap.blockBytes,
+                .allocationBytes = heap.allocationBytes,
+                .allocationCount = heap.allocationCount,
+            };
+            callback(heapIdx, &heap_, data);
+        },
+        threshold);
+}
+void RendererSetFrameReadback(
+    CRenderer *renderer, uint32_t format, uint32_t numSlots, CReadbackCallback callback, void *data) {
+    auto *renderer_ = reinterpret_cast<Renderer *>(renderer);
+    renderer_->setFrameReadback({
+        .format = static_cast<ReadbackFormat>(format),
+        .numSlots = numSlots,
+        .callback =
+            [=](const ReadbackFrame &frame) {
+                CReadbackFrame frame_{
+                    .frame = frame.frame,
+                    .dropped = frame.dropped,
+                    .format = value(frame.format),
+                    .width = frame.extent.width,
+                    .height = frame.extent.height,
+                    .stride = frame.stride,
+                    .data = reinterpret_cast<const uint8_t *>(frame.data.data()),
+                    .size = frame.data.size(),
+                };
+                callback(&frame_, data);
+            },
+    });
+}
 CFPSMeter *RenderGetFPSMeter(CRenderer *renderer) {
     auto *renderer_ = reinterpret_cast<Renderer *>(renderer);
     return reinterpret_cast<CFPSMeter *>(&renderer_->fpsMeter());
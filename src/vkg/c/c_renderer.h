@@ -3,6 +3,9 @@
 #include "c_scene.h"
 #include "c_window.h"
 #include "c_fpsmeter.h"
+#include "c_frame_stats.h"
+#include "c_memory_report.h"
+#include "c_trace.h"
 #include <cstdint>
 #ifdef __cplusplus
 extern "C" {
@@ -20,6 +23,11 @@ typedef struct {
     bool vsync;
     uint32_t numFrames;
     bool rayTrace;
+    bool asyncCompute;
+    uint32_t recordThreads;
+    bool headless;
+    const char *pipelineCachePath;
+    const char *atmosphereCacheDir;
 } CFeatureConfig;
 
 struct CRenderer;
@@ -34,12 +42,45 @@ void RendererLoopFuncPtr(CRenderer *renderer, CUpdater updater, void *data);
 struct CCallFrameUpdater;
 typedef struct CCallFrameUpdater CCallFrameUpdater;
 void RendererLoopUpdater(CRenderer *renderer, CCallFrameUpdater *updater);
+uint32_t RendererRenderFrame(CRenderer *renderer, double elapsedMs);
 
 CWindow *RendererGetWindow(CRenderer *renderer);
 
 CScene *RendererAddScene(CRenderer *renderer, CSceneConfig sceneConfig, char *nameBuf, uint32_t size);
 
 CFPSMeter *RenderGetFPSMeter(CRenderer *renderer);
+/**
+ * snapshot of per pass timings, should be released by DeleteFrameStats.
+ */
+CFrameStats *RendererGetFrameStats(CRenderer *renderer);
+
+/**
+ * snapshot of the memory heaps and of every named resource, should be released by DeleteMemoryReport.
+ */
+CMemoryReport *RendererGetMemoryReport(CRenderer *renderer);
+typedef void (*CMemoryBudgetCallback)(uint32_t heapIdx, const CMemoryHeapStats *heap, void *data);
+/**
+ * called on the render thread when a heap's usage goes above `threshold` of its budget.
+ */
+void RendererSetMemoryBudgetCallback(
+    CRenderer *renderer, float threshold, CMemoryBudgetCallback callback, void *data);
+
+typedef struct {
+    uint64_t frame;
+    uint64_t dropped;
+    /** 0: the swapchain's color format, 1: NV12, 2: I420 */
+    uint32_t format;
+    uint32_t width, height;
+    uint32_t stride;
+    const uint8_t *data;
+    uint64_t size;
+} CReadbackFrame;
+typedef void (*CReadbackCallback)(const CReadbackFrame *frame, void *data);
+/**
+ * capture presented frames, the callback is called on a readback thread. Must be set before the first frame.
+ */
+void RendererSetFrameReadback(
+    CRenderer *renderer, uint32_t format, uint32_t numSlots, CReadbackCallback callback, void *data);
 
 #ifdef __cplusplus
 }
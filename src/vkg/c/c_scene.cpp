@@ -84,3 +84,21 @@ CShadowMapSetting *SceneGetShadowmap(CScene *scene) {
     auto *scene_ = reinterpret_cast<Scene *>(scene);
     return reinterpret_cast<CShadowMapSetting *>(&scene_->shadowmap());
 }
+CDynamicResolutionSetting *SceneGetDynamicResolution(CScene *scene) {
+    auto *scene_ = reinterpret_cast<Scene *>(scene);
+    return reinterpret_cast<CDynamicResolutionSetting *>(&scene_->dynamicResolution());
+}
+CTemporalAASetting *SceneGetTemporalAA(CScene *scene) {
+    auto *scene_ = reinterpret_cast<Scene *>(scene);
+    return reinterpret_cast<CTemporalAASetting *>(&scene_->temporalAA());
+}
+uint32_t SceneGetCullStats(CScene *scene, uint32_t *drawn, uint32_t *occluded, uint32_t capacity) {
+    auto *scene_ = reinterpret_cast<Scene *>(scene);
+    auto &stats = scene_->cullStats();
+    auto count = uint32_t(stats.drawn.size());
+    for(auto i = 0u; i < std::min(count, capacity); ++i) {
+        drawn[i] = stats.drawn[i];
+        occluded[i] = stats.occluded[i];
+    }
+    return count;
+}
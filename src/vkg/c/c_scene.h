@@ -12,6 +12,8 @@
 #include "c_camera.h"
 #include "c_atmosphere.h"
 #include "c_shadowmap.h"
+#include "c_dynamic_resolution.h"
+#include "c_temporal_aa.h"
 #include "vkg/base/resource/texture_formats.h"
 
 #ifdef __cplusplus
@@ -67,6 +69,13 @@ uint32_t SceneNewLight(CScene *scene, bool perFrame);
 CCamera *SceneGetCamera(CScene *scene);
 CAtmosphereSetting *SceneGetAtmosphere(CScene *scene);
 CShadowMapSetting *SceneGetShadowmap(CScene *scene);
+CDynamicResolutionSetting *SceneGetDynamicResolution(CScene *scene);
+CTemporalAASetting *SceneGetTemporalAA(CScene *scene);
+/**
+ * copies the per shade model counts of the camera cull into drawn and occluded, each holding
+ * capacity entries. Returns the number of shade models.
+ */
+uint32_t SceneGetCullStats(CScene *scene, uint32_t *drawn, uint32_t *occluded, uint32_t capacity);
 
 #ifdef __cplusplus
 }
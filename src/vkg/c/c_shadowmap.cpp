@@ -33,3 +33,31 @@ void ShadowMapSetZFar(CShadowMapSetting *shadowmap, float zFar) {
     auto *shadowmap_ = reinterpret_cast<ShadowMapSetting *>(shadowmap);
     shadowmap_->setZFar(zFar);
 }
+float ShadowMapGetCullMinTexels(CShadowMapSetting *shadowmap) {
+    auto *shadowmap_ = reinterpret_cast<ShadowMapSetting *>(shadowmap);
+    return shadowmap_->cullMinTexels();
+}
+void ShadowMapSetCullMinTexels(CShadowMapSetting *shadowmap, float minTexels) {
+    auto *shadowmap_ = reinterpret_cast<ShadowMapSetting *>(shadowmap);
+    shadowmap_->setCullMinTexels(minTexels);
+}
+float ShadowMapGetCullMaxDistance(CShadowMapSetting *shadowmap) {
+    auto *shadowmap_ = reinterpret_cast<ShadowMapSetting *>(shadowmap);
+    return shadowmap_->cullMaxDistance();
+}
+void ShadowMapSetCullMaxDistance(CShadowMapSetting *shadowmap, float maxDistance) {
+    auto *shadowmap_ = reinterpret_cast<ShadowMapSetting *>(shadowmap);
+    shadowmap_->setCullMaxDistance(maxDistance);
+}
+bool ShadowMapGetCacheStaticCasters(CShadowMapSetting *shadowmap) {
+    auto *shadowmap_ = reinterpret_cast<ShadowMapSetting *>(shadowmap);
+    return shadowmap_->cacheStaticCasters();
+}
+void ShadowMapSetCacheStaticCasters(CShadowMapSetting *shadowmap, bool cache) {
+    auto *shadowmap_ = reinterpret_cast<ShadowMapSetting *>(shadowmap);
+    shadowmap_->setCacheStaticCasters(cache);
+}
+void ShadowMapInvalidateStaticCasters(CShadowMapSetting *shadowmap) {
+    auto *shadowmap_ = reinterpret_cast<ShadowMapSetting *>(shadowmap);
+    shadowmap_->invalidateStaticCasters();
+}
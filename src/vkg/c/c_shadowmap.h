@@ -24,6 +24,16 @@ void ShadowMapSetTextureSize(CShadowMapSetting *shadowmap, uint32_t textureSize)
 float ShadowMapGetZFar(CShadowMapSetting *shadowmap);
 void ShadowMapSetZFar(CShadowMapSetting *shadowmap, float zFar);
 
+float ShadowMapGetCullMinTexels(CShadowMapSetting *shadowmap);
+void ShadowMapSetCullMinTexels(CShadowMapSetting *shadowmap, float minTexels);
+
+float ShadowMapGetCullMaxDistance(CShadowMapSetting *shadowmap);
+void ShadowMapSetCullMaxDistance(CShadowMapSetting *shadowmap, float maxDistance);
+
+bool ShadowMapGetCacheStaticCasters(CShadowMapSetting *shadowmap);
+void ShadowMapSetCacheStaticCasters(CShadowMapSetting *shadowmap, bool cache);
+void ShadowMapInvalidateStaticCasters(CShadowMapSetting *shadowmap);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,23 @@
+#include "c_temporal_aa.h"
+#include "vkg/render/model/temporal_aa.hpp"
+using namespace vkg;
+bool TemporalAAIsEnabled(CTemporalAASetting *temporalAA) {
+    auto *temporalAA_ = reinterpret_cast<TemporalAASetting *>(temporalAA);
+    return temporalAA_->isEnabled();
+}
+void TemporalAAEnable(CTemporalAASetting *temporalAA, bool enabled) {
+    auto *temporalAA_ = reinterpret_cast<TemporalAASetting *>(temporalAA);
+    temporalAA_->enable(enabled);
+}
+float TemporalAAGetFeedback(CTemporalAASetting *temporalAA) {
+    auto *temporalAA_ = reinterpret_cast<TemporalAASetting *>(temporalAA);
+    return temporalAA_->feedback();
+}
+void TemporalAASetFeedback(CTemporalAASetting *temporalAA, float feedback) {
+    auto *temporalAA_ = reinterpret_cast<TemporalAASetting *>(temporalAA);
+    temporalAA_->setFeedback(feedback);
+}
+void TemporalAAResetHistory(CTemporalAASetting *temporalAA) {
+    auto *temporalAA_ = reinterpret_cast<TemporalAASetting *>(temporalAA);
+    temporalAA_->resetHistory();
+}
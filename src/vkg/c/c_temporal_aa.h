@@ -0,0 +1,25 @@
+#ifndef VKG_C_TEMPORAL_AA_H
+#define VKG_C_TEMPORAL_AA_H
+
+#ifdef __cplusplus
+extern "C" {
+#else
+    #include <stdbool.h>
+#endif
+
+struct CTemporalAASetting;
+typedef struct CTemporalAASetting CTemporalAASetting;
+
+bool TemporalAAIsEnabled(CTemporalAASetting *temporalAA);
+void TemporalAAEnable(CTemporalAASetting *temporalAA, bool enabled);
+
+float TemporalAAGetFeedback(CTemporalAASetting *temporalAA);
+void TemporalAASetFeedback(CTemporalAASetting *temporalAA, float feedback);
+
+void TemporalAAResetHistory(CTemporalAASetting *temporalAA);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //VKG_C_TEMPORAL_AA_H
@@ -0,0 +1,8 @@
+#include "c_trace.h"
+#include "vkg/util/trace_recorder.hpp"
+using namespace vkg;
+void TraceStart(char *pathBuf, uint32_t size, uint32_t numFrames) {
+    TraceRecorder::instance().start(std::string{pathBuf, size}, numFrames);
+}
+void TraceStop() { TraceRecorder::instance().stop(); }
+bool TraceIsRecording() { return TraceRecorder::instance().recording(); }
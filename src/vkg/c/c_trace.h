@@ -0,0 +1,22 @@
+#ifndef VKG_C_TRACE_H
+#define VKG_C_TRACE_H
+
+#include <cstdint>
+#ifdef __cplusplus
+extern "C" {
+#else
+    #include <stdbool.h>
+#endif
+
+/**
+ * start recording a Chrome trace JSON file. numFrames is the number of frames to record before
+ * writing the file automatically, 0 means until TraceStop.
+ */
+void TraceStart(char *pathBuf, uint32_t size, uint32_t numFrames);
+void TraceStop();
+bool TraceIsRecording();
+
+#ifdef __cplusplus
+}
+#endif
+#endif //VKG_C_TRACE_H
@@ -3,8 +3,32 @@
 #include <array>
 
 namespace vkg {
+/**
+ * Which instances a frustum draws. Dynamic instances are those whose transform or primitive is
+ * allocated per frame, every other instance is static.
+ */
+enum class FrustumCasters : uint32_t { eAll, eStatic, eDynamic, eNone };
+
 struct Frustum {
     std::array<glm::vec4, 6> planes;
+    /**
+     * Small and distant instance culling. An instance is culled if the diameter of its bounding
+     * sphere covers less than `minPixels` or the sphere is farther than `maxDistance` from `eye`.
+     * 0 disables a threshold. `pixelScale` is the pixels covered by a unit length, at unit distance
+     * for a perspective projection or at any distance for an orthographic one.
+     */
+    glm::vec3 eye{0};
+    float pixelScale{0};
+    float minPixels{0};
+    float maxDistance{0};
+    uint32_t perspective{1};
+    FrustumCasters casters{FrustumCasters::eAll};
+    /**
+     * index of the frustum the instances visible in this one are drawn with, ~0u to draw them on
+     * their own. Frustums merged into the same one must follow it, bit `i - mergeInto` of an
+     * instance's view mask tells whether frustum `i` sees it.
+     */
+    uint32_t mergeInto{~0u};
 
     Frustum() = default;
 
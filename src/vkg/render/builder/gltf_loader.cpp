@@ -2,6 +2,7 @@
 #include "vkg/render/scene.hpp"
 #include <stb_image.h>
 #include "vkg/util/syntactic_sugar.hpp"
+#include "vkg/util/trace_recorder.hpp"
 
 namespace vkg {
 using namespace glm;
@@ -13,8 +14,11 @@ auto GLTFLoader::load(std::span<std::byte> bytes) -> uint32_t {
   tinygltf::Model model;
   tinygltf::TinyGLTF loader;
   std::string err, warn;
-  auto result = loader.LoadBinaryFromMemory(
-    &model, &err, &warn, (unsigned char *)bytes.data(), bytes.size_bytes());
+  auto result = [&]() {
+    TraceScope trace("glTF parse", "loader");
+    return loader.LoadBinaryFromMemory(
+      &model, &err, &warn, (unsigned char *)bytes.data(), bytes.size_bytes());
+  }();
   errorIf(!result, "failed to load glTF err: ", err, ", warn: ", warn);
 
   return internalLoad(model);
@@ -24,24 +28,36 @@ auto GLTFLoader::load(const std::string &file) -> uint32_t {
   tinygltf::Model model;
   tinygltf::TinyGLTF loader;
   std::string err, warn;
-  auto result = endWith(file, ".gltf") ?
-                  loader.LoadASCIIFromFile(&model, &err, &warn, file) :
-                  loader.LoadBinaryFromFile(&model, &err, &warn, file);
+  auto result = [&]() {
+    TraceScope trace("glTF parse", "loader");
+    return endWith(file, ".gltf") ? loader.LoadASCIIFromFile(&model, &err, &warn, file) :
+                                    loader.LoadBinaryFromFile(&model, &err, &warn, file);
+  }();
   errorIf(!result, "failed to load glTF: ", file, ", err: ", err, ", warn: ", warn);
 
   return internalLoad(model);
 }
 auto GLTFLoader::internalLoad(const tinygltf::Model &model) -> uint32_t {
-  loadTextureSamplers(model);
-  loadTextures(model);
-  loadMaterials(model);
+  {
+    TraceScope trace("glTF textures", "loader");
+    loadTextureSamplers(model);
+    loadTextures(model);
+  }
+  {
+    TraceScope trace("glTF materials", "loader");
+    loadMaterials(model);
+  }
 
   std::vector<uint32_t> nodes;
-  const auto &_scene = model.scenes[std::max(model.defaultScene, 0)];
-  _nodes.resize(model.nodes.size());
-  for(int i: _scene.nodes)
-    nodes.push_back(loadNode(i, model));
+  {
+    TraceScope trace("glTF nodes", "loader");
+    const auto &_scene = model.scenes[std::max(model.defaultScene, 0)];
+    _nodes.resize(model.nodes.size());
+    for(int i: _scene.nodes)
+      nodes.push_back(loadNode(i, model));
+  }
 
+  TraceScope trace("glTF animations", "loader");
   loadAnimations(model);
   return scene.newModel(std::move(nodes), std::move(animations));
 }
@@ -1,4 +1,6 @@
 #include "frame_graph.hpp"
+#include "vkg/util/trace_recorder.hpp"
+#include <algorithm>
 
 namespace vkg {
 
@@ -6,13 +8,44 @@ PassBuilder::PassBuilder(FrameGraph &frameGraph, uint32_t id, BasePass &pass)
     : frameGraph(frameGraph), id{id}, pass_{pass} {}
 auto PassBuilder::device() -> Device & { return frameGraph.device(); }
 auto PassBuilder::scopedName(std::string name) -> std::string { return pass_.name + "/" + name; }
+auto PassBuilder::queue(QueueType type) -> void { pass_.queue_ = type; }
+auto PassBuilder::compileSerially() -> void { pass_.serialCompile_ = true; }
+auto PassBuilder::createTexture(const std::string &name, const TransientTextureDesc &desc)
+    -> FrameGraphResource<Texture *> {
+    auto output = create<Texture *>(name);
+    frameGraph.transients.push_back({.id = output.id, .isTexture = true, .textureDesc = desc});
+    return output;
+}
+auto PassBuilder::createTexture(const std::string &name, const TransientTextureDesc &desc, AccessType access)
+    -> FrameGraphResource<Texture *> {
+    auto output = createTexture(name, desc);
+    declare<Texture *>(output.id, access);
+    return output;
+}
+auto PassBuilder::createBuffer(const std::string &name, const TransientBufferDesc &desc)
+    -> FrameGraphResource<Buffer *> {
+    errorIf(desc.size == 0, "transient buffer ", name, " has zero size");
+    auto output = create<Buffer *>(name);
+    frameGraph.transients.push_back({.id = output.id, .isTexture = false, .bufferDesc = desc});
+    return output;
+}
 
-Resources::Resources(Device &device, std::vector<FrameGraphResources> &resRevisions)
-    : device{device}, resRevisions{resRevisions} {
-    physicalResources.resize(resRevisions.size());
+thread_local BasePass *Resources::pass{nullptr};
+
+Resources::Resources(
+    Device &device, std::vector<FrameGraphResources> &resRevisions, std::vector<std::unique_ptr<ResourceSlot>> slots)
+    : device{device}, resRevisions{resRevisions}, slots{std::move(slots)} {}
+auto Resources::bufferInfo(uint32_t id, ResourceKind kind) -> std::optional<BufferInfo> {
+    if(kind == ResourceKind::eBufferInfo) return slot<BufferInfo>(id);
+    auto &buffer = slot<Buffer *>(id);
+    if(!buffer.has_value() || !*buffer) return std::nullopt;
+    return (*buffer)->bufferInfo();
 }
 
-FrameGraph::FrameGraph(Device &device): device_(device) {}
+FrameGraph::FrameGraph(Device &device, uint32_t recordThreads): device_(device) {
+    if(recordThreads > 1) threadPool = std::make_unique<ThreadPool>(recordThreads);
+}
+FrameGraph::~FrameGraph() { releaseTransients(); }
 auto FrameGraph::device() -> Device & { return device_; }
 auto FrameGraph::check(const FrameGraphBaseResource &resource) -> void {
     errorIf(resource.id >= resRevisions.size(), "resource's id is invalid: ", resource.id);
@@ -59,6 +92,7 @@ auto FrameGraph::build() -> void {
 
     for(auto i = 0u; i < n; ++i)
         if(visited[i] == State::eUnVisited && passes[i]->inputs_.empty()) dfs(i);
+    scheduleAsyncCompute();
 
     for(auto i = 0u; i < n; ++i) {
         auto passId = sortedPassIds[i];
@@ -85,21 +119,108 @@ auto FrameGraph::build() -> void {
     }
 #endif
 
-    resources = std::make_unique<Resources>(device_, resRevisions);
+    computeLifetimes();
+    partition();
+    computeWaves();
+
+    resources = std::make_unique<Resources>(device_, resRevisions, std::move(slots));
+    std::vector<std::string> names;
+    std::vector<uint32_t> tracks;
+    for(auto *pass: passes) {
+        names.push_back(pass->name);
+        tracks.push_back(device_.supported().asyncCompute ? value(pass->queue_) : 0);
+    }
+    profiler = std::make_unique<PassProfiler>(device_, names, tracks, uint32_t(device_.queues().size()));
     enabled.resize(passes.size());
 }
 
 auto FrameGraph::onFrame(RenderContext &renderContext) -> void {
     //this depends on that the parent pass is always created before child passes(created in setup method).
-    for(auto &pass: passes)
+    for(auto &pass: passes) {
         enabled[pass->id] = ((pass->parent == ~0u || enabled[pass->parent]) && pass->passCondition_());
-    for(auto &id: sortedPassIds) {
-        resources->pass = passes[id];
-        if(enabled[id]) passes[id]->compile(renderContext, *resources);
+        pass->afterPreviousFrame_ = false;
     }
-    for(auto &id: sortedPassIds) {
-        resources->pass = passes[id];
-        if(enabled[id]) passes[id]->execute(renderContext, *resources);
+    if(transientsDirty) allocateTransients(renderContext.numFrames);
+    profiler->beginFrame(renderContext.frameIndex);
+    accessStates.assign(resRevisions.size(), {});
+    barrierStats_ = {};
+    // the memory of an aliased transient was last written by another resource, so its first access waits on
+    // all previous writes and discards the content.
+    for(auto &t: transients)
+        if(t.isTexture) {
+            auto *texture = t.textures[renderContext.frameIndex].get();
+            if(t.aliased)
+                texture->recordLayout(
+                    vk::ImageLayout::eUndefined, vk::AccessFlagBits::eMemoryWrite,
+                    vk::PipelineStageFlagBits::eAllCommands);
+            resources->slot<Texture *>(t.id) = texture;
+        } else {
+            if(t.aliased)
+                accessStates[t.id] = {
+                    .init = true,
+                    .writeStage = vk::PipelineStageFlagBits::eAllCommands,
+                    .writeAccess = vk::AccessFlagBits::eMemoryWrite};
+            resources->slot<Buffer *>(t.id) = t.buffers[renderContext.frameIndex].get();
+        }
+    frameWaits_.clear();
+    frameCmdBuffers_.clear();
+    if(!submissions.empty()) {
+        executeSubmissions(renderContext);
+        return;
     }
+    if(!waves.empty()) executeParallel(renderContext);
+    else {
+        compilePasses(renderContext);
+        for(auto &id: sortedPassIds)
+            if(enabled[id]) executePass(*passes[id], collectBarriers(*passes[id]), renderContext);
+    }
+    // the whole frame is a single submission.
+    if(renderContext.previousFrame.semaphore &&
+       std::any_of(sortedPassIds.begin(), sortedPassIds.end(), [&](uint32_t id) {
+           return enabled[id] && passes[id]->afterPreviousFrame_;
+       }))
+        frameWaits_.push_back(renderContext.previousFrame);
+}
+
+auto FrameGraph::compilePasses(RenderContext &ctx) -> void {
+    auto start = TraceRecorder::now();
+    for(auto &id: sortedPassIds)
+        if(enabled[id]) compilePass(id, ctx);
+    if(compiled) return;
+    compiled = true;
+    debugLog("first compile of ", passes.size(), " passes took ", double(TraceRecorder::now() - start) / 1e6, " ms");
+}
+
+auto FrameGraph::compilePass(uint32_t passId, RenderContext &ctx) -> void {
+    resources->pass = passes[passId];
+    auto start = TraceRecorder::now();
+    passes[passId]->compile(ctx, *resources);
+    auto end = TraceRecorder::now();
+    profiler->recordCompile(passId, double(end - start) / 1e6);
+    TraceRecorder::instance().span(passes[passId]->name, "compile", start, end);
+}
+
+auto FrameGraph::executePass(BasePass &pass, const PassBarriers &barriers, RenderContext &ctx) -> void {
+    resources->pass = &pass;
+    auto start = TraceRecorder::now();
+    device_.begin(ctx.cb, pass.name);
+    profiler->writeBegin(ctx.cb, pass.id);
+    recordBarriers(barriers, ctx.cb);
+    pass.execute(ctx, *resources);
+    profiler->writeEnd(ctx.cb, pass.id);
+    device_.end(ctx.cb);
+    auto end = TraceRecorder::now();
+    profiler->recordExecute(pass.id, double(end - start) / 1e6);
+    TraceRecorder::instance().span(pass.name, "execute", start, end);
+}
+
+auto FrameGraph::frameStats() const -> FrameStats {
+    if(!profiler) return {};
+    return profiler->stats();
+}
+
+auto FrameGraph::gpuFrameTime() const -> double {
+    if(!profiler) return 0;
+    return profiler->frameTime();
 }
 }
@@ -1,13 +1,18 @@
 #pragma once
 #include "vkg/base/vk_headers.hpp"
 #include "vkg/base/device.hpp"
+#include "vkg/base/resource/texture.hpp"
+#include "vkg/base/resource/buffer.hpp"
+#include "frame_stats.hpp"
 #include <functional>
 #include <map>
 #include <set>
-#include <any>
+#include <array>
+#include <optional>
 #include <span>
 #include <utility>
 #include "vkg/util/syntactic_sugar.hpp"
+#include "vkg/util/thread_pool.hpp"
 #include "boost/pfr.hpp"
 
 namespace vkg {
@@ -45,6 +50,90 @@ struct FrameGraphResources {
     std::string name;
     uint32_t id;
     std::vector<FrameGraphResourcePass> revisions;
+    /**
+     * the resource points to an object that passes mutate even when only reading it, like the tracked
+     * layout of a texture or the jitter of the camera.
+     */
+    bool object{false};
+};
+
+/**
+ * Description of a texture whose memory is owned by the frame graph. Transient resources whose
+ * lifetimes don't overlap are placed in the same memory.
+ */
+struct TransientTextureDesc {
+    vk::Format format{vk::Format::eR8G8B8A8Unorm};
+    /**
+     * zero extent means the texture follows the extent set by `FrameGraph::resizeTransients`.
+     */
+    vk::Extent2D extent{};
+    uint32_t arrayLayers{1};
+    vk::ImageUsageFlags usage{vk::ImageUsageFlagBits::eSampled};
+    vk::SampleCountFlagBits samples{vk::SampleCountFlagBits::e1};
+    vk::ImageViewType viewType{vk::ImageViewType::e2D};
+    vk::ImageAspectFlags aspect{vk::ImageAspectFlagBits::eColor};
+};
+
+struct TransientBufferDesc {
+    vk::DeviceSize size{0};
+    vk::BufferUsageFlags usage{vk::BufferUsageFlagBits::eStorageBuffer};
+};
+
+struct TransientMemoryStats {
+    /** total size of transient resources if each one had its own memory. */
+    vk::DeviceSize unaliased{0};
+    /** total size of the shared memory actually allocated. */
+    vk::DeviceSize aliased{0};
+};
+
+/**
+ * How a pass accesses a Texture*, Buffer* or BufferInfo resource. The frame graph uses the declared
+ * access types to generate barriers and layout transitions between passes.
+ */
+enum class AccessType : uint32_t {
+    eIndirectRead,
+    eVertexRead,
+    eFragmentRead,
+    eComputeRead,
+    eRayTracingRead,
+    eComputeStorageRead,
+    eComputeStorageWrite,
+    eRayTracingStorageWrite,
+    eAccelerationStructureBuildRead,
+    eColorAttachment,
+    eDepthAttachment,
+    eTransferSrc,
+    eTransferDst,
+};
+
+struct ResourceAccess {
+    vk::PipelineStageFlags stage;
+    vk::AccessFlags access;
+    /** eUndefined keeps the current layout, which is always the case for buffers. */
+    vk::ImageLayout layout{vk::ImageLayout::eUndefined};
+    bool write{false};
+};
+
+auto accessOf(AccessType type) -> ResourceAccess;
+
+struct BarrierStats {
+    uint32_t batches{0};
+    uint32_t imageBarriers{0};
+    uint32_t bufferBarriers{0};
+    /** read after read of the same layout that didn't need a barrier. */
+    uint32_t elided{0};
+};
+
+/**
+ * Queue a pass prefers to run on. eCompute passes run on the dedicated compute queue when
+ * `FeatureConfig::asyncCompute` is enabled and supported, otherwise on the graphics queue.
+ */
+enum class QueueType : uint32_t { eGraphics = 0, eCompute = 1 };
+
+enum class ResourceKind : uint32_t { eTexture, eBuffer, eBufferInfo };
+struct PassAccess {
+    ResourceKind kind;
+    ResourceAccess access;
 };
 
 class BasePass {
@@ -60,6 +149,14 @@ public:
     void enableIf(PassCondition &&passCondition) { passCondition_ = std::move(passCondition); }
 
 protected:
+    /**
+     * Requested from `compile` or `execute` when the pass accesses state kept across frames outside of the
+     * per frame resources this frame, like a history or a cache. As the frames in flight are submitted to
+     * different queues, the submission recording the pass then waits until the previous frame finished, see
+     * `RenderContext::previousFrame`.
+     */
+    auto afterPreviousFrame() -> void { afterPreviousFrame_ = true; }
+
     std::string name;
 
 private:
@@ -67,6 +164,10 @@ private:
     uint32_t order;
     std::map<uint32_t, FrameGraphBaseResource> inputs_;
     std::map<uint32_t, FrameGraphBaseResource> outputs_;
+    std::map<uint32_t, PassAccess> accesses_;
+    QueueType queue_{QueueType::eGraphics};
+    bool serialCompile_{false};
+    bool afterPreviousFrame_{false};
     uint32_t parent{~0u};
 
     PassCondition passCondition_{[]() { return true; }};
@@ -129,6 +230,22 @@ public:
     template<typename T>
     auto create(const std::string &name = "") -> FrameGraphResource<T>;
     /**
+   * Create a transient texture as the output of this pass. The texture is allocated by the frame graph
+   * and may share memory with other transient resources whose lifetimes don't overlap, in which case
+   * its content and layout are undefined at the beginning of each frame.
+   */
+    auto createTexture(const std::string &name, const TransientTextureDesc &desc) -> FrameGraphResource<Texture *>;
+    /**
+   * Same as above but also declare how this pass accesses the texture. The first access of an aliased texture
+   * in a frame waits on all previous writes to its memory.
+   */
+    auto createTexture(const std::string &name, const TransientTextureDesc &desc, AccessType access)
+        -> FrameGraphResource<Texture *>;
+    /**
+   * Create a transient buffer as the output of this pass. Same aliasing rules as `createTexture`.
+   */
+    auto createBuffer(const std::string &name, const TransientBufferDesc &desc) -> FrameGraphResource<Buffer *>;
+    /**
    * Read the resource as the input of this pass.
    */
     template<DerivedResource T>
@@ -146,6 +263,27 @@ public:
    */
     template<typename T>
     auto write(const FrameGraphResource<T> &input) -> FrameGraphResource<T>;
+    /**
+   * Same as above but also declare how this pass accesses the resource. Barriers from the previous access
+   * are recorded before this pass executes. Declaring multiple access types for one resource merges them.
+   */
+    template<typename T>
+    auto create(const std::string &name, AccessType access) -> FrameGraphResource<T>;
+    template<typename T>
+    auto read(FrameGraphResource<T> &input, AccessType access) -> void;
+    template<typename T>
+    auto write(const FrameGraphResource<T> &input, AccessType access) -> FrameGraphResource<T>;
+
+    /**
+   * Declare the queue this pass prefers to run on. Resources crossing queues should be read/written with an
+   * access type, so that their ownership transfers are recorded.
+   */
+    auto queue(QueueType type) -> void;
+    /**
+   * The pass's compile mutates state shared outside of the frame graph, like the scene or the renderer. It is
+   * never compiled in parallel with other passes.
+   */
+    auto compileSerially() -> void;
 
     template<typename PassInType, typename PassOutType>
     auto addPass(const std::string &name, const PassInType &inputs, Pass<PassInType, PassOutType> &pass)
@@ -166,8 +304,12 @@ private:
         pass.setup(*this);
         pass.inputs_ = std::move(inputs_);
         pass.outputs_ = std::move(outputs_);
+        pass.accesses_ = std::move(accesses_);
     }
 
+    template<typename T>
+    auto declare(uint32_t resId, AccessType type) -> void;
+
     auto scopedName(std::string name) -> std::string;
 
     FrameGraph &frameGraph;
@@ -175,43 +317,85 @@ private:
     BasePass &pass_;
     std::map<uint32_t, FrameGraphBaseResource> inputs_;
     std::map<uint32_t, FrameGraphBaseResource> outputs_;
+    std::map<uint32_t, PassAccess> accesses_;
+};
+
+/**
+ * Storage of one resource. The value type is fixed when the resource is created, so that reading it
+ * back is a static cast.
+ */
+struct ResourceSlot {
+    virtual ~ResourceSlot() = default;
+};
+template<typename T>
+struct TypedResourceSlot: ResourceSlot {
+    std::optional<T> value;
 };
 
 class Resources {
     friend class FrameGraph;
 
 public:
-    explicit Resources(Device &device, std::vector<FrameGraphResources> &resRevisions);
+    explicit Resources(
+        Device &device, std::vector<FrameGraphResources> &resRevisions,
+        std::vector<std::unique_ptr<ResourceSlot>> slots);
 
     //TODO reset per frame resource.
 
+    /**
+   * Resource handles are validated against the pass's declared outputs/inputs in debug builds only. A pass can
+   * get back its own outputs, e.g. the transient resources it creates.
+   */
     template<typename T>
     auto set(FrameGraphResource<T> &resource, T res) -> Resources & {
+#ifndef NDEBUG
         auto out = pass->outputs_.find(resource.id);
         errorIf(
             out == pass->outputs_.end() || out->second.revision != resource.revision, "resource (",
             resRevisions[resource.id].name, "$", resource.id, ":", resource.revision, ") cannot be written by pass [",
             pass->name, "$", pass->id, ":", pass->order, "]");
-        physicalResources.at(resource.id) = res;
+#endif
+        slot<T>(resource.id).emplace(std::move(res));
         return *this;
     }
 
     template<typename T>
-    auto get(FrameGraphResource<T> &resource) -> T {
+    auto get(FrameGraphResource<T> &resource) -> const T & {
+        auto &value = slot<T>(resource.id);
+#ifndef NDEBUG
         auto in = pass->inputs_.find(resource.id);
+        auto readable = in != pass->inputs_.end() && in->second.revision == resource.revision;
+        auto out = pass->outputs_.find(resource.id);
+        readable = readable || (out != pass->outputs_.end() && out->second.revision == resource.revision);
         errorIf(
-            in == pass->inputs_.end() || in->second.revision != resource.revision, "resource (",
-            resRevisions[resource.id].name, "$", resource.id, ":", resource.revision, ") cannot be read by pass [",
-            pass->name, "$", pass->id, ":", pass->order, "]");
-        return std::any_cast<T>(physicalResources.at(resource.id));
+            !readable, "resource (", resRevisions[resource.id].name, "$", resource.id, ":", resource.revision,
+            ") cannot be read by pass [", pass->name, "$", pass->id, ":", pass->order, "]");
+        errorIf(!value.has_value(), "resource (", resRevisions[resource.id].name, "$", resource.id, ") is not set");
+#endif
+        return *value;
     }
 
     Device &device;
 
 private:
-    BasePass *pass{nullptr};
+    template<typename T>
+    auto slot(uint32_t id) -> std::optional<T> & {
+#ifndef NDEBUG
+        auto *typed = dynamic_cast<TypedResourceSlot<T> *>(slots.at(id).get());
+        errorIf(typed == nullptr, "resource (", resRevisions[id].name, "$", id, ") is not of the requested type");
+        return typed->value;
+#else
+        return static_cast<TypedResourceSlot<T> *>(slots[id].get())->value;
+#endif
+    }
+
+    /** buffer range of a Buffer* or BufferInfo resource, empty if it isn't set. */
+    auto bufferInfo(uint32_t id, ResourceKind kind) -> std::optional<BufferInfo>;
+
+    /** the pass currently compiling or executing on this thread. */
+    static thread_local BasePass *pass;
     std::vector<FrameGraphResources> &resRevisions;
-    std::vector<std::any> physicalResources;
+    std::vector<std::unique_ptr<ResourceSlot>> slots;
 };
 
 struct RenderContext {
@@ -220,13 +404,20 @@ struct RenderContext {
     uint32_t frameIndex{};
     uint32_t numFrames{};
     vk::CommandBuffer cb;
+    /** timeline value signalled once the previous frame finishes, see `BasePass::afterPreviousFrame`. */
+    SemaphoreWait previousFrame{};
 };
 
 class FrameGraph {
     friend class PassBuilder;
 
 public:
-    explicit FrameGraph(Device &device);
+    /**
+   * @param recordThreads number of threads recording passes. With more than one thread, independent passes
+   * execute in parallel into their own command buffers, see `frameCmdBuffers`.
+   */
+    explicit FrameGraph(Device &device, uint32_t recordThreads = 1);
+    ~FrameGraph();
 
     template<typename PassInType, typename PassOutType>
     auto addPass(const std::string &name, const PassInType &inputs, Pass<PassInType, PassOutType> &pass)
@@ -265,11 +456,41 @@ public:
 
     auto onFrame(RenderContext &renderContext) -> void;
 
+    /**
+   * Set the extent of transient textures that don't specify one. Transient resources are reallocated on
+   * the next frame if the extent changes.
+   */
+    auto resizeTransients(vk::Extent2D extent) -> void;
+    auto transientMemory() const -> TransientMemoryStats;
+    /**
+   * Barriers generated from declared access types during the last frame.
+   */
+    auto barrierStats() const -> BarrierStats;
+    /**
+   * Semaphores the renderer's frame submission has to wait on, valid after `onFrame`. This includes
+   * `RenderContext::previousFrame` if any pass of the frame's last submission requested it.
+   */
+    auto frameWaits() const -> std::span<const SemaphoreWait>;
+    /**
+   * Command buffers recorded by the worker threads during `onFrame`. They have to be submitted in this order
+   * right after `RenderContext::cb`.
+   */
+    auto frameCmdBuffers() const -> std::span<const vk::CommandBuffer>;
+    /**
+   * GPU and CPU timings of each pass over the recent frames. GPU timings lag `numFrames` frames behind.
+   */
+    auto frameStats() const -> FrameStats;
+    /**
+   * GPU milliseconds of the frame whose timings were read back last, `numFrames` frames behind. 0 if unknown.
+   */
+    auto gpuFrameTime() const -> double;
+
 private:
     template<typename T>
     auto create(uint32_t passId, const std::string &name = "") -> FrameGraphResource<T> {
         auto id_ = uint32_t(resRevisions.size());
-        resRevisions.push_back({name, id_, {{passId, {}}}});
+        resRevisions.push_back({name, id_, {{passId, {}}}, std::is_pointer_v<T>});
+        slots.push_back(std::make_unique<TypedResourceSlot<T>>());
         return {id_, 0};
     }
     auto read(const FrameGraphBaseResource &input, uint32_t passId) -> void;
@@ -287,6 +508,34 @@ private:
     }
     auto check(const FrameGraphBaseResource &resource) -> void;
 
+    auto computeLifetimes() -> void;
+    auto allocateTransients(uint32_t numFrames) -> void;
+    auto releaseTransients() -> void;
+    struct PassBarriers {
+        vk::PipelineStageFlags srcStage, dstStage;
+        std::vector<vk::ImageMemoryBarrier> imageBarriers;
+        std::vector<vk::BufferMemoryBarrier> bufferBarriers;
+    };
+    auto collectBarriers(BasePass &pass) -> PassBarriers;
+    auto recordBarriers(const PassBarriers &barriers, vk::CommandBuffer cb) -> void;
+    auto computeWaves() -> void;
+    auto compilePasses(RenderContext &ctx) -> void;
+    auto compilePass(uint32_t passId, RenderContext &ctx) -> void;
+    auto compileParallel(RenderContext &renderContext) -> void;
+    auto executePass(BasePass &pass, const PassBarriers &barriers, RenderContext &ctx) -> void;
+    auto executeParallel(RenderContext &renderContext) -> void;
+    auto scheduleAsyncCompute() -> void;
+    auto partition() -> void;
+    auto queueFamily(QueueType type) -> uint32_t;
+    struct OwnershipTransfer {
+        uint32_t resId;
+        /** the declared access of the acquiring passes, merged. Unused when releasing. */
+        PassAccess usage;
+    };
+    auto recordOwnershipTransfer(
+        const OwnershipTransfer &transfer, QueueType src, QueueType dst, bool release, vk::CommandBuffer cb) -> void;
+    auto executeSubmissions(RenderContext &renderContext) -> void;
+
     Device &device_;
 
     std::vector<BasePass *> passes;
@@ -295,9 +544,92 @@ private:
     std::vector<bool> enabled;
 
     std::vector<FrameGraphResources> resRevisions;
+    /** typed storage of each resource, moved into `resources` once the graph is built. */
+    std::vector<std::unique_ptr<ResourceSlot>> slots;
 
     std::unique_ptr<Resources> resources;
 
+    struct TransientResource {
+        uint32_t id;
+        bool isTexture;
+        TransientTextureDesc textureDesc;
+        TransientBufferDesc bufferDesc;
+        uint32_t firstOrder{~0u}, lastOrder{0};
+        bool aliased{false};
+        std::vector<std::unique_ptr<Texture>> textures;
+        std::vector<std::unique_ptr<Buffer>> buffers;
+    };
+    std::vector<TransientResource> transients;
+    std::vector<VmaAllocation> transientHeaps;
+    vk::Extent2D transientExtent{};
+    bool transientsDirty{true};
+    TransientMemoryStats transientStats;
+
+    /**
+     * per frame access history of a resource. Writes are made visible only to the stages that have
+     * waited on them, later readers of other stages still need a barrier.
+     */
+    struct AccessState {
+        bool init{false};
+        vk::PipelineStageFlags writeStage;
+        vk::AccessFlags writeAccess;
+        vk::PipelineStageFlags visibleStage;
+        vk::AccessFlags visibleAccess;
+        vk::PipelineStageFlags readStage;
+    };
+    auto transit(AccessState &state, const ResourceAccess &dst, bool layoutChange, vk::PipelineStageFlags &srcStage)
+        -> std::optional<vk::AccessFlags>;
+    std::vector<AccessState> accessStates;
+    BarrierStats barrierStats_;
+
+    /**
+     * Contiguous run of sorted passes on the same queue. Empty if every pass runs on the graphics queue,
+     * otherwise the first one also receives commands recorded during `compile` and the last one is
+     * recorded into `RenderContext::cb`.
+     */
+    struct Submission {
+        QueueType queue;
+        std::vector<uint32_t> passIds;
+        /** value of this submission relative to the frame's base value of its queue's semaphore. */
+        uint64_t signalOffset{0};
+        /** relative values to wait for, indexed by QueueType. 0 means no wait. */
+        std::array<uint64_t, 2> waitOffsets{0, 0};
+        /** only textures are transferred, buffers are shared concurrently by both queue families. */
+        std::vector<OwnershipTransfer> releases, acquires;
+        std::vector<vk::CommandBuffer> cbs;
+    };
+    std::vector<Submission> submissions;
+    struct QueueSync {
+        vk::UniqueSemaphore semaphore;
+        uint64_t value{0};
+    };
+    std::vector<std::array<QueueSync, 2>> queueSyncs;
+    std::vector<SemaphoreWait> frameWaits_;
+
+    std::unique_ptr<ThreadPool> threadPool;
+    /**
+     * sorted passes split into contiguous runs that don't depend on each other, so that passes of the
+     * same wave can be recorded in parallel while barriers are still generated in sorted order. Passes
+     * of a wave don't share any object resource either.
+     */
+    std::vector<std::vector<uint32_t>> waves;
+    struct RecordPool {
+        vk::UniqueCommandPool pool;
+        std::vector<vk::CommandBuffer> cbs;
+        uint32_t used{0};
+    };
+    auto nextCmdBuffer(RecordPool &pool) -> vk::CommandBuffer;
+    /** indexed by frame then by thread. */
+    std::vector<std::vector<RecordPool>> recordPools;
+    std::vector<vk::CommandBuffer> frameCmdBuffers_;
+    /**
+     * the first compile creates the passes' pipelines. With a thread pool it runs wave by wave in
+     * parallel so that pipeline creation is spread over the threads.
+     */
+    bool compiled{false};
+
+    std::unique_ptr<PassProfiler> profiler;
+
     bool frozen{false};
 };
 
@@ -338,6 +670,49 @@ auto PassBuilder::write(const FrameGraphResource<T> &input) -> FrameGraphResourc
     return output;
 }
 
+template<typename T>
+auto PassBuilder::create(const std::string &name, AccessType access) -> FrameGraphResource<T> {
+    auto output = create<T>(name);
+    declare<T>(output.id, access);
+    return output;
+}
+
+template<typename T>
+auto PassBuilder::read(FrameGraphResource<T> &input, AccessType access) -> void {
+    read(input);
+    declare<T>(input.id, access);
+}
+
+template<typename T>
+auto PassBuilder::write(const FrameGraphResource<T> &input, AccessType access) -> FrameGraphResource<T> {
+    auto output = write(input);
+    declare<T>(output.id, access);
+    return output;
+}
+
+template<typename T>
+auto PassBuilder::declare(uint32_t resId, AccessType type) -> void {
+    ResourceKind kind;
+    if constexpr(std::is_same_v<T, Texture *>)
+        kind = ResourceKind::eTexture;
+    else if constexpr(std::is_same_v<T, Buffer *>)
+        kind = ResourceKind::eBuffer;
+    else {
+        static_assert(std::is_same_v<T, BufferInfo>, "access type is only for Texture*, Buffer* or BufferInfo");
+        kind = ResourceKind::eBufferInfo;
+    }
+    auto access = accessOf(type);
+    auto [it, inserted] = accesses_.try_emplace(resId, PassAccess{kind, access});
+    if(inserted) return;
+    auto &merged = it->second.access;
+    errorIf(
+        kind == ResourceKind::eTexture && merged.layout != access.layout,
+        "cannot access the same texture with different layouts in a pass");
+    merged.stage |= access.stage;
+    merged.access |= access.access;
+    merged.write = merged.write || access.write;
+}
+
 template<typename PassInType, typename PassOutType>
 auto PassBuilder::addPass(const std::string &name, const PassInType &inputs, Pass<PassInType, PassOutType> &pass)
     -> Pass<PassInType, PassOutType> & {
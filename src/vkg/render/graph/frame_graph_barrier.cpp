@@ -0,0 +1,140 @@
+#include "frame_graph.hpp"
+
+namespace vkg {
+
+auto accessOf(AccessType type) -> ResourceAccess {
+    using vkStage = vk::PipelineStageFlagBits;
+    using vkAccess = vk::AccessFlagBits;
+    using vkLayout = vk::ImageLayout;
+    switch(type) {
+        case AccessType::eIndirectRead: return {vkStage::eDrawIndirect, vkAccess::eIndirectCommandRead};
+        case AccessType::eVertexRead:
+            return {vkStage::eVertexShader, vkAccess::eShaderRead, vkLayout::eShaderReadOnlyOptimal};
+        case AccessType::eFragmentRead:
+            return {vkStage::eFragmentShader, vkAccess::eShaderRead, vkLayout::eShaderReadOnlyOptimal};
+        case AccessType::eComputeRead:
+            return {vkStage::eComputeShader, vkAccess::eShaderRead, vkLayout::eShaderReadOnlyOptimal};
+        case AccessType::eRayTracingRead:
+            return {vkStage::eRayTracingShaderNV, vkAccess::eShaderRead, vkLayout::eShaderReadOnlyOptimal};
+        case AccessType::eComputeStorageRead:
+            return {vkStage::eComputeShader, vkAccess::eShaderRead, vkLayout::eGeneral};
+        case AccessType::eComputeStorageWrite:
+            return {vkStage::eComputeShader, vkAccess::eShaderRead | vkAccess::eShaderWrite, vkLayout::eGeneral, true};
+        case AccessType::eRayTracingStorageWrite:
+            return {
+                vkStage::eRayTracingShaderNV, vkAccess::eShaderRead | vkAccess::eShaderWrite, vkLayout::eGeneral, true};
+        case AccessType::eAccelerationStructureBuildRead:
+            return {vkStage::eAccelerationStructureBuildNV, vkAccess::eAccelerationStructureReadNV};
+        case AccessType::eColorAttachment:
+            return {
+                vkStage::eColorAttachmentOutput, vkAccess::eColorAttachmentRead | vkAccess::eColorAttachmentWrite,
+                vkLayout::eColorAttachmentOptimal, true};
+        case AccessType::eDepthAttachment:
+            return {
+                vkStage::eEarlyFragmentTests | vkStage::eLateFragmentTests,
+                vkAccess::eDepthStencilAttachmentRead | vkAccess::eDepthStencilAttachmentWrite,
+                vkLayout::eDepthStencilAttachmentOptimal, true};
+        case AccessType::eTransferSrc:
+            return {vkStage::eTransfer, vkAccess::eTransferRead, vkLayout::eTransferSrcOptimal};
+        case AccessType::eTransferDst:
+            return {vkStage::eTransfer, vkAccess::eTransferWrite, vkLayout::eTransferDstOptimal, true};
+    }
+    error("unknown access type: ", value(type));
+    return {};
+}
+
+namespace {
+using vkAccess = vk::AccessFlagBits;
+const vk::AccessFlags writeMask = vkAccess::eShaderWrite | vkAccess::eColorAttachmentWrite |
+                                  vkAccess::eDepthStencilAttachmentWrite | vkAccess::eTransferWrite |
+                                  vkAccess::eHostWrite | vkAccess::eMemoryWrite |
+                                  vkAccess::eAccelerationStructureWriteNV;
+}
+
+auto FrameGraph::barrierStats() const -> BarrierStats { return barrierStats_; }
+
+auto FrameGraph::transit(
+    AccessState &state, const ResourceAccess &dst, bool layoutChange, vk::PipelineStageFlags &srcStage)
+    -> std::optional<vk::AccessFlags> {
+    if(dst.write || layoutChange) {
+        auto stage = state.writeStage | state.readStage;
+        auto access = state.writeAccess;
+        state = {
+            .init = true,
+            .writeStage = dst.stage,
+            .writeAccess = dst.write ? dst.access & writeMask : vk::AccessFlags{},
+            .visibleStage = dst.stage,
+            .visibleAccess = dst.access};
+        if(!stage && !layoutChange) return std::nullopt;
+        srcStage |= stage;
+        return access;
+    }
+    state.readStage |= dst.stage;
+    if(!state.writeStage || ((dst.stage & ~state.visibleStage) == vk::PipelineStageFlags{} &&
+                             (dst.access & ~state.visibleAccess) == vk::AccessFlags{})) {
+        ++barrierStats_.elided;
+        return std::nullopt;
+    }
+    state.visibleStage |= dst.stage;
+    state.visibleAccess |= dst.access;
+    srcStage |= state.writeStage;
+    return state.writeAccess;
+}
+
+auto FrameGraph::collectBarriers(BasePass &pass) -> PassBarriers {
+    PassBarriers barriers;
+    auto &[srcStage, dstStage, imageBarriers, bufferBarriers] = barriers;
+    for(auto &[id, usage]: pass.accesses_) {
+        auto &dst = usage.access;
+        auto &state = accessStates[id];
+        if(usage.kind == ResourceKind::eTexture) {
+            auto &physical = resources->slot<Texture *>(id);
+            if(!physical.has_value() || !*physical) continue;
+            auto *texture = *physical;
+            if(!state.init) {
+                state.init = true;
+                if(texture->accessFlag() & writeMask) {
+                    state.writeStage = texture->stageFlag();
+                    state.writeAccess = texture->accessFlag() & writeMask;
+                } else
+                    state.readStage = texture->stageFlag();
+            }
+            auto oldLayout = texture->layout();
+            auto layout = dst.layout == vk::ImageLayout::eUndefined ? oldLayout : dst.layout;
+            auto srcAccess = transit(state, dst, layout != oldLayout, srcStage);
+            texture->recordLayout(layout, state.writeAccess | dst.access, state.writeStage | state.readStage);
+            if(!srcAccess) continue;
+            vk::ImageAspectFlags aspect = vk::ImageAspectFlagBits::eColor;
+            if(texture->aspectFlag()) aspect = texture->aspectFlag();
+            imageBarriers.emplace_back(
+                *srcAccess, dst.access, oldLayout, layout, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+                texture->image(),
+                vk::ImageSubresourceRange{aspect, 0, texture->mipLevels(), 0, texture->arrayLayers()});
+            dstStage |= dst.stage;
+        } else {
+            auto bufInfo = resources->bufferInfo(id, usage.kind);
+            if(!bufInfo) continue;
+            // previous frames are synchronized by the queue submission.
+            state.init = true;
+            auto srcAccess = transit(state, dst, false, srcStage);
+            if(!srcAccess) continue;
+            bufferBarriers.emplace_back(
+                *srcAccess, dst.access, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, bufInfo->buffer,
+                bufInfo->offset, bufInfo->size);
+            dstStage |= dst.stage;
+        }
+    }
+    if(imageBarriers.empty() && bufferBarriers.empty()) return barriers;
+    if(!srcStage) srcStage = vk::PipelineStageFlagBits::eTopOfPipe;
+    ++barrierStats_.batches;
+    barrierStats_.imageBarriers += uint32_t(imageBarriers.size());
+    barrierStats_.bufferBarriers += uint32_t(bufferBarriers.size());
+    return barriers;
+}
+
+auto FrameGraph::recordBarriers(const PassBarriers &barriers, vk::CommandBuffer cb) -> void {
+    if(barriers.imageBarriers.empty() && barriers.bufferBarriers.empty()) return;
+    cb.pipelineBarrier(
+        barriers.srcStage, barriers.dstStage, {}, nullptr, barriers.bufferBarriers, barriers.imageBarriers);
+}
+}
@@ -0,0 +1,150 @@
+#include "frame_graph.hpp"
+#include "vkg/util/trace_recorder.hpp"
+#include <set>
+
+namespace vkg {
+
+auto FrameGraph::frameCmdBuffers() const -> std::span<const vk::CommandBuffer> { return frameCmdBuffers_; }
+
+auto FrameGraph::computeWaves() -> void {
+    if(!threadPool || !submissions.empty()) return;
+
+    std::vector<uint32_t> waveOf(passes.size(), ~0u);
+    // objects touched by the current wave, they are mutated without synchronization (e.g. `image::transitTo`).
+    std::set<uint32_t> waveObjects;
+    for(auto id: sortedPassIds) {
+        auto current = uint32_t(waves.size() - 1);
+        auto dependent = waves.empty();
+        std::set<uint32_t> objects;
+        for(auto *resources: {&passes[id]->inputs_, &passes[id]->outputs_})
+            for(auto &[resId, _]: *resources)
+                if(resRevisions[resId].object) {
+                    objects.insert(resId);
+                    if(waveObjects.contains(resId)) dependent = true;
+                }
+        auto dependOn = [&](uint32_t passId) {
+            if(passId != id && waveOf[passId] == current) dependent = true;
+        };
+        for(auto &[_, input]: passes[id]->inputs_) {
+            auto &revision = resRevisions[input.id].revisions[input.revision];
+            dependOn(revision.writerPass);
+            for(auto reader: revision.readerPasses)
+                if(passes[reader]->outputs_.contains(input.id)) dependOn(reader);
+        }
+        for(auto &[_, output]: passes[id]->outputs_)
+            if(output.revision > 0)
+                for(auto reader: resRevisions[output.id].revisions[output.revision - 1].readerPasses)
+                    dependOn(reader);
+        if(dependent) {
+            waves.emplace_back();
+            waveObjects.clear();
+        }
+        waveObjects.merge(objects);
+        waves.back().push_back(id);
+        waveOf[id] = uint32_t(waves.size() - 1);
+    }
+
+    auto numFrames = uint32_t(device_.queues().size());
+    recordPools.resize(numFrames);
+    for(auto &pools: recordPools) {
+        pools.resize(threadPool->numThreads());
+        for(auto &pool: pools)
+            pool.pool = device_.vkDevice().createCommandPoolUnique(
+                {vk::CommandPoolCreateFlagBits::eTransient, device_.queueFamiliy()});
+    }
+
+#ifndef NDEBUG
+    for(auto &wave: waves) {
+        std::string names;
+        for(auto passId: wave)
+            names += " [" + passes[passId]->name + "]";
+        println("record wave:", names);
+    }
+#endif
+}
+
+auto FrameGraph::executeParallel(RenderContext &renderContext) -> void {
+    auto &pools = recordPools[renderContext.frameIndex];
+    for(auto &pool: pools) {
+        device_.vkDevice().resetCommandPool(*pool.pool, {});
+        pool.used = 0;
+    }
+
+    // compile may record into the frame's command buffer and set resources read by later passes.
+    if(compiled) compilePasses(renderContext);
+    else
+        compileParallel(renderContext);
+
+    std::vector<uint32_t> passIds;
+    std::vector<PassBarriers> barriers;
+    for(auto &wave: waves) {
+        passIds.clear();
+        barriers.clear();
+        for(auto id: wave) {
+            if(!enabled[id]) continue;
+            resources->pass = passes[id];
+            passIds.push_back(id);
+            barriers.push_back(collectBarriers(*passes[id]));
+        }
+        auto first = frameCmdBuffers_.size();
+        frameCmdBuffers_.resize(first + passIds.size());
+        threadPool->parallelFor(uint32_t(passIds.size()), [&](uint32_t task, uint32_t thread) {
+            auto cb = nextCmdBuffer(pools[thread]);
+            cb.begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+            RenderContext ctx = renderContext;
+            ctx.cb = cb;
+            executePass(*passes[passIds[task]], barriers[task], ctx);
+            cb.end();
+            frameCmdBuffers_[first + task] = cb;
+        });
+    }
+}
+
+auto FrameGraph::nextCmdBuffer(RecordPool &pool) -> vk::CommandBuffer {
+    if(pool.used == pool.cbs.size())
+        pool.cbs.push_back(
+            device_.vkDevice().allocateCommandBuffers({*pool.pool, vk::CommandBufferLevel::ePrimary, 1})[0]);
+    return pool.cbs[pool.used++];
+}
+
+auto FrameGraph::compileParallel(RenderContext &renderContext) -> void {
+    compiled = true;
+    auto &pools = recordPools[renderContext.frameIndex];
+    auto start = TraceRecorder::now();
+    // passes of a wave don't read each other's outputs, and each records into its own command buffer,
+    // which is submitted before all the executed passes just like the frame's command buffer. Passes
+    // mutating state outside the graph are compiled one after another before the rest of their wave.
+    std::vector<uint32_t> passIds;
+    for(auto &wave: waves) {
+        passIds.clear();
+        for(auto id: wave) {
+            if(!enabled[id]) continue;
+            if(!passes[id]->serialCompile_) {
+                passIds.push_back(id);
+                continue;
+            }
+            auto cb = nextCmdBuffer(pools[0]);
+            cb.begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+            RenderContext ctx = renderContext;
+            ctx.cb = cb;
+            compilePass(id, ctx);
+            cb.end();
+            frameCmdBuffers_.push_back(cb);
+        }
+        auto first = frameCmdBuffers_.size();
+        frameCmdBuffers_.resize(first + passIds.size());
+        threadPool->parallelFor(uint32_t(passIds.size()), [&](uint32_t task, uint32_t thread) {
+            auto cb = nextCmdBuffer(pools[thread]);
+            cb.begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+            RenderContext ctx = renderContext;
+            ctx.cb = cb;
+            compilePass(passIds[task], ctx);
+            cb.end();
+            frameCmdBuffers_[first + task] = cb;
+        });
+    }
+    debugLog(
+        "first compile of ", passes.size(), " passes on ", threadPool->numThreads(), " threads took ",
+        double(TraceRecorder::now() - start) / 1e6, " ms");
+}
+}
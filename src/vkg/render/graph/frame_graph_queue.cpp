@@ -0,0 +1,278 @@
+#include "frame_graph.hpp"
+#include <algorithm>
+#include <queue>
+#include <set>
+
+namespace vkg {
+
+auto FrameGraph::frameWaits() const -> std::span<const SemaphoreWait> { return frameWaits_; }
+
+auto FrameGraph::queueFamily(QueueType type) -> uint32_t {
+    return type == QueueType::eCompute ? device_.computeQueueFamily() : device_.queueFamiliy();
+}
+
+auto FrameGraph::scheduleAsyncCompute() -> void {
+    if(!device_.supported().asyncCompute) return;
+    if(std::none_of(passes.begin(), passes.end(), [](auto *pass) { return pass->queue_ == QueueType::eCompute; }))
+        return;
+
+    // reorder so that compute passes are issued as early as possible and graphics passes that don't depend
+    // on them are placed between the compute submission and its consumer, otherwise the graphics queue
+    // would wait on the compute queue immediately and nothing overlaps.
+    const auto n = uint32_t(passes.size());
+    std::vector<std::set<uint32_t>> next(n);
+    std::vector<uint32_t> inDegree(n, 0), position(n);
+    for(auto i = 0u; i < n; ++i)
+        position[sortedPassIds[i]] = i;
+    auto addEdge = [&](uint32_t from, uint32_t to) {
+        if(from != to && next[from].insert(to).second) ++inDegree[to];
+    };
+    for(auto u = 0u; u < n; ++u)
+        for(auto &[_, output]: passes[u]->outputs_) {
+            for(auto reader: resRevisions[output.id].revisions[output.revision].readerPasses)
+                addEdge(u, reader);
+            // write after read: readers of the previous revision must not be moved after the writer.
+            if(output.revision > 0)
+                for(auto reader: resRevisions[output.id].revisions[output.revision - 1].readerPasses)
+                    addEdge(reader, u);
+        }
+
+    std::vector<bool> dependsOnCompute(n, false);
+    std::vector<uint32_t> stack;
+    for(auto u = 0u; u < n; ++u)
+        if(passes[u]->queue_ == QueueType::eCompute) stack.push_back(u);
+    while(!stack.empty()) {
+        auto u = stack.back();
+        stack.pop_back();
+        for(auto v: next[u])
+            if(!dependsOnCompute[v]) {
+                dependsOnCompute[v] = true;
+                stack.push_back(v);
+            }
+    }
+    auto priority = [&](uint32_t u) {
+        if(passes[u]->queue_ == QueueType::eCompute) return 0u;
+        return dependsOnCompute[u] ? 2u : 1u;
+    };
+    auto later = [&](uint32_t a, uint32_t b) {
+        return std::pair{priority(a), position[a]} > std::pair{priority(b), position[b]};
+    };
+    std::priority_queue<uint32_t, std::vector<uint32_t>, decltype(later)> ready(later);
+    for(auto u = 0u; u < n; ++u)
+        if(inDegree[u] == 0) ready.push(u);
+    std::vector<uint32_t> sorted;
+    sorted.reserve(n);
+    while(!ready.empty()) {
+        auto u = ready.top();
+        ready.pop();
+        sorted.push_back(u);
+        for(auto v: next[u])
+            if(--inDegree[v] == 0) ready.push(v);
+    }
+    errorIf(sorted.size() != n, "cycles in frame graph");
+    sortedPassIds = std::move(sorted);
+}
+
+auto FrameGraph::partition() -> void {
+    if(!device_.supported().asyncCompute) return;
+    if(std::none_of(passes.begin(), passes.end(), [](auto *pass) { return pass->queue_ == QueueType::eCompute; }))
+        return;
+
+    // commands recorded during compile (e.g. scene updates) go to the first submission, which is always graphics.
+    submissions.push_back({QueueType::eGraphics});
+    std::vector<uint32_t> submissionOfPass(passes.size());
+    for(auto id: sortedPassIds) {
+        auto queue = passes[id]->queue_;
+        if(submissions.back().queue != queue) submissions.push_back({queue});
+        submissions.back().passIds.push_back(id);
+        submissionOfPass[id] = uint32_t(submissions.size() - 1);
+    }
+    // the last submission is recorded into the renderer's command buffer, which presents.
+    if(submissions.back().queue != QueueType::eGraphics) submissions.push_back({QueueType::eGraphics});
+
+    std::array<uint64_t, 2> count{0, 0};
+    for(auto &s: submissions)
+        s.signalOffset = ++count[value(s.queue)];
+
+    for(auto i = 0u; i < submissions.size(); ++i) {
+        auto &s = submissions[i];
+        auto dependOn = [&](uint32_t passId) {
+            auto &other = submissions[submissionOfPass[passId]];
+            if(submissionOfPass[passId] >= i || other.queue == s.queue) return;
+            auto &offset = s.waitOffsets[value(other.queue)];
+            offset = std::max(offset, other.signalOffset);
+        };
+        for(auto passId: s.passIds) {
+            for(auto &[_, input]: passes[passId]->inputs_)
+                dependOn(resRevisions[input.id].revisions[input.revision].writerPass);
+            for(auto &[_, output]: passes[passId]->outputs_) {
+                if(output.revision == 0) continue;
+                auto &prev = resRevisions[output.id].revisions[output.revision - 1];
+                for(auto reader: prev.readerPasses)
+                    if(reader != passId) dependOn(reader);
+            }
+        }
+    }
+    // the frame is finished only when all compute work is finished.
+    submissions.back().waitOffsets[value(QueueType::eCompute)] = count[value(QueueType::eCompute)];
+
+    if(queueFamily(QueueType::eCompute) != queueFamily(QueueType::eGraphics)) {
+        std::vector<uint32_t> lastSubmission(resRevisions.size(), ~0u);
+        for(auto i = 0u; i < submissions.size(); ++i)
+            for(auto passId: submissions[i].passIds)
+                for(auto &[resId, usage]: passes[passId]->accesses_) {
+                    if(usage.kind != ResourceKind::eTexture) continue;
+                    auto last = lastSubmission[resId];
+                    auto &acquires = submissions[i].acquires;
+                    if(last == i) {
+                        auto acquire = std::find_if(
+                            acquires.begin(), acquires.end(), [&](auto &a) { return a.resId == resId; });
+                        if(acquire != acquires.end()) {
+                            acquire->usage.access.stage |= usage.access.stage;
+                            acquire->usage.access.access |= usage.access.access;
+                        }
+                    } else if(last != ~0u && submissions[last].queue != submissions[i].queue) {
+                        submissions[last].releases.push_back({resId, usage});
+                        acquires.push_back({resId, usage});
+                    }
+                    lastSubmission[resId] = i;
+                }
+    }
+
+    auto numFrames = uint32_t(device_.queues().size());
+    queueSyncs.resize(numFrames);
+    for(auto &syncs: queueSyncs)
+        for(auto &sync: syncs) {
+            vk::SemaphoreTypeCreateInfo timelineCreateInfo{vk::SemaphoreType::eTimeline, 0};
+            vk::SemaphoreCreateInfo createInfo{};
+            createInfo.pNext = &timelineCreateInfo;
+            sync.semaphore = device_.vkDevice().createSemaphoreUnique(createInfo);
+        }
+    for(auto i = 0u; i + 1 < submissions.size(); ++i) {
+        auto &s = submissions[i];
+        auto pool = s.queue == QueueType::eCompute ? device_.computeCmdPool() : device_.cmdPool();
+        s.cbs = device_.vkDevice().allocateCommandBuffers({pool, vk::CommandBufferLevel::ePrimary, numFrames});
+    }
+
+#ifndef NDEBUG
+    for(auto &s: submissions) {
+        print("submission on ", s.queue == QueueType::eCompute ? "compute" : "graphics", " queue:");
+        for(auto passId: s.passIds)
+            print(" [", passes[passId]->name, "]");
+        println(", wait graphics:", s.waitOffsets[0], " compute:", s.waitOffsets[1], " signal:", s.signalOffset);
+    }
+#endif
+}
+
+auto FrameGraph::recordOwnershipTransfer(
+    const OwnershipTransfer &transfer, QueueType src, QueueType dst, bool release, vk::CommandBuffer cb) -> void {
+    auto &physical = resources->slot<Texture *>(transfer.resId);
+    if(!physical.has_value() || !*physical) return;
+    auto *texture = *physical;
+    auto &state = accessStates[transfer.resId];
+    auto srcFamily = queueFamily(src), dstFamily = queueFamily(dst);
+    vk::PipelineStageFlags srcStage = vk::PipelineStageFlagBits::eTopOfPipe;
+    vk::PipelineStageFlags dstStage = vk::PipelineStageFlagBits::eBottomOfPipe;
+    vk::AccessFlags srcAccess, dstAccess;
+    if(release) {
+        if(auto stage = state.writeStage | state.readStage; stage) srcStage = stage;
+        srcAccess = state.writeAccess;
+    } else {
+        // only the stages of the acquiring passes wait, later accesses are ordered by `collectBarriers`.
+        auto &access = transfer.usage.access;
+        dstStage = access.stage;
+        dstAccess = access.access;
+        state = {
+            .init = true, .writeStage = access.stage, .visibleStage = access.stage, .visibleAccess = access.access};
+    }
+    vk::ImageAspectFlags aspect = vk::ImageAspectFlagBits::eColor;
+    if(texture->aspectFlag()) aspect = texture->aspectFlag();
+    vk::ImageMemoryBarrier barrier{
+        srcAccess,
+        dstAccess,
+        texture->layout(),
+        texture->layout(),
+        srcFamily,
+        dstFamily,
+        texture->image(),
+        {aspect, 0, texture->mipLevels(), 0, texture->arrayLayers()}};
+    cb.pipelineBarrier(srcStage, dstStage, {}, nullptr, nullptr, barrier);
+    if(!release) texture->recordLayout(texture->layout(), {}, dstStage);
+    ++barrierStats_.batches;
+    ++barrierStats_.imageBarriers;
+}
+
+auto FrameGraph::executeSubmissions(RenderContext &renderContext) -> void {
+    auto frameIndex = renderContext.frameIndex;
+    auto &syncs = queueSyncs[frameIndex];
+    std::array<uint64_t, 2> base{syncs[0].value, syncs[1].value};
+    auto last = uint32_t(submissions.size() - 1);
+
+    RenderContext ctx = renderContext;
+    ctx.cb = submissions[0].cbs[frameIndex];
+    ctx.cb.begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+    compilePasses(ctx);
+
+    for(auto i = 0u; i <= last; ++i) {
+        auto &s = submissions[i];
+        if(i == last) ctx.cb = renderContext.cb;
+        else if(i > 0) {
+            ctx.cb = s.cbs[frameIndex];
+            ctx.cb.begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+        }
+        auto other = s.queue == QueueType::eCompute ? QueueType::eGraphics : QueueType::eCompute;
+        for(auto &acquire: s.acquires)
+            recordOwnershipTransfer(acquire, other, s.queue, false, ctx.cb);
+        for(auto &id: s.passIds)
+            if(enabled[id]) executePass(*passes[id], collectBarriers(*passes[id]), ctx);
+        for(auto &release: s.releases)
+            recordOwnershipTransfer(release, s.queue, other, true, ctx.cb);
+
+        auto q = value(s.queue);
+        std::vector<vk::Semaphore> waitSemaphores;
+        std::vector<uint64_t> waitValues;
+        std::vector<vk::PipelineStageFlags> waitStages;
+        for(auto wq: {0u, 1u})
+            if(s.waitOffsets[wq] > 0) {
+                waitSemaphores.push_back(*syncs[wq].semaphore);
+                waitValues.push_back(base[wq] + s.waitOffsets[wq]);
+                waitStages.emplace_back(vk::PipelineStageFlagBits::eAllCommands);
+            }
+        auto &previous = renderContext.previousFrame;
+        if(previous.semaphore && std::any_of(s.passIds.begin(), s.passIds.end(), [&](uint32_t id) {
+               return enabled[id] && passes[id]->afterPreviousFrame_;
+           })) {
+            waitSemaphores.push_back(previous.semaphore);
+            waitValues.push_back(previous.value);
+            waitStages.push_back(previous.stage);
+        }
+        if(i == last) {
+            for(auto w = 0u; w < waitSemaphores.size(); ++w)
+                frameWaits_.push_back({waitSemaphores[w], waitValues[w], waitStages[w]});
+            continue;
+        }
+        ctx.cb.end();
+
+        auto signalValue = base[q] + s.signalOffset;
+        vk::TimelineSemaphoreSubmitInfo timelineInfo;
+        timelineInfo.waitSemaphoreValueCount = uint32_t(waitValues.size());
+        timelineInfo.pWaitSemaphoreValues = waitValues.data();
+        timelineInfo.signalSemaphoreValueCount = 1;
+        timelineInfo.pSignalSemaphoreValues = &signalValue;
+
+        vk::SubmitInfo submit;
+        submit.pNext = &timelineInfo;
+        submit.waitSemaphoreCount = uint32_t(waitSemaphores.size());
+        submit.pWaitSemaphores = waitSemaphores.data();
+        submit.pWaitDstStageMask = waitStages.data();
+        submit.signalSemaphoreCount = 1;
+        submit.pSignalSemaphores = syncs[q].semaphore.operator->();
+        submit.commandBufferCount = 1;
+        submit.pCommandBuffers = &ctx.cb;
+        auto queue = s.queue == QueueType::eCompute ? device_.computeQueues()[frameIndex] :
+                                                      device_.queues()[frameIndex];
+        queue.submit(submit, nullptr);
+        syncs[q].value = signalValue;
+    }
+}
+}
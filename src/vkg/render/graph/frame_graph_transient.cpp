@@ -0,0 +1,163 @@
+#include "frame_graph.hpp"
+#include <algorithm>
+
+namespace vkg {
+
+auto FrameGraph::resizeTransients(vk::Extent2D extent) -> void {
+    if(extent == transientExtent) return;
+    transientExtent = extent;
+    transientsDirty = true;
+}
+auto FrameGraph::transientMemory() const -> TransientMemoryStats { return transientStats; }
+
+auto FrameGraph::computeLifetimes() -> void {
+    for(auto &t: transients) {
+        for(auto &revision: resRevisions[t.id].revisions) {
+            auto writer = passes[revision.writerPass]->order;
+            t.firstOrder = std::min(t.firstOrder, writer);
+            t.lastOrder = std::max(t.lastOrder, writer);
+            for(auto reader: revision.readerPasses)
+                t.lastOrder = std::max(t.lastOrder, passes[reader]->order);
+        }
+    }
+}
+
+auto FrameGraph::releaseTransients() -> void {
+    for(auto &t: transients) {
+        t.textures.clear();
+        t.buffers.clear();
+    }
+    for(auto heap: transientHeaps) {
+        VmaAllocationInfo info;
+        vmaGetAllocationInfo(device_.allocator(), heap, &info);
+        device_.memoryTracker().remove("transient heap", MemoryCategory::eRenderTargets, info.size);
+        vmaFreeMemory(device_.allocator(), heap);
+    }
+    transientHeaps.clear();
+}
+
+auto FrameGraph::allocateTransients(uint32_t numFrames) -> void {
+    transientsDirty = false;
+    if(transients.empty()) return;
+    if(!transientHeaps.empty()) device_.vkDevice().waitIdle();
+    releaseTransients();
+
+    for(auto &t: transients) {
+        auto &name = resRevisions[t.id].name;
+        t.aliased = false;
+        for(auto i = 0u; i < numFrames; ++i)
+            if(t.isTexture) {
+                auto &desc = t.textureDesc;
+                auto extent = desc.extent.width == 0 ? transientExtent : desc.extent;
+                errorIf(extent.width == 0 || extent.height == 0, "transient texture ", name, " has no extent");
+                auto texture = std::make_unique<Texture>(
+                    device_,
+                    vk::ImageCreateInfo{
+                        {},
+                        vk::ImageType::e2D,
+                        desc.format,
+                        {extent.width, extent.height, 1U},
+                        1,
+                        desc.arrayLayers,
+                        desc.samples,
+                        vk::ImageTiling::eOptimal,
+                        desc.usage},
+                    toString(name, "_", i));
+                t.textures.push_back(std::move(texture));
+            } else {
+                auto &desc = t.bufferDesc;
+                t.buffers.push_back(std::make_unique<Buffer>(
+                    device_, vk::BufferCreateInfo{{}, desc.size, desc.usage}, toString(name, "_", i)));
+            }
+    }
+
+    // Images and buffers go to different heaps so bufferImageGranularity never needs to be considered.
+    struct Placement {
+        uint32_t transient;
+        vk::DeviceSize offset, size;
+    };
+    struct HeapPlan {
+        uint32_t memoryTypeBits;
+        vk::DeviceSize size{0}, alignment{1};
+        std::vector<Placement> placements;
+    };
+    std::vector<HeapPlan> heaps;
+    transientStats = {};
+    for(auto isTexture: {true, false}) {
+        struct Candidate {
+            uint32_t transient;
+            vk::MemoryRequirements req;
+        };
+        std::vector<Candidate> candidates;
+        for(auto i = 0u; i < transients.size(); ++i) {
+            auto &t = transients[i];
+            if(t.isTexture != isTexture) continue;
+            auto req = isTexture ? t.textures[0]->memoryRequirements() : t.buffers[0]->memoryRequirements();
+            candidates.push_back({i, req});
+            transientStats.unaliased += req.size * numFrames;
+        }
+        std::sort(candidates.begin(), candidates.end(), [](const Candidate &a, const Candidate &b) {
+            return a.req.size > b.req.size;
+        });
+
+        auto firstHeap = heaps.size();
+        for(auto &[idx, req]: candidates) {
+            auto &t = transients[idx];
+            HeapPlan *heap{nullptr};
+            for(auto h = firstHeap; h < heaps.size(); ++h)
+                if(heaps[h].memoryTypeBits & req.memoryTypeBits) {
+                    heap = &heaps[h];
+                    break;
+                }
+            if(!heap) heap = &heaps.emplace_back(HeapPlan{req.memoryTypeBits});
+
+            // collect the ranges occupied by resources alive at the same time, then take the lowest gap that fits.
+            std::vector<std::pair<vk::DeviceSize, vk::DeviceSize>> occupied;
+            for(auto &p: heap->placements) {
+                auto &other = transients[p.transient];
+                if(other.lastOrder < t.firstOrder || t.lastOrder < other.firstOrder) {
+                    other.aliased = t.aliased = true;
+                    continue;
+                }
+                occupied.emplace_back(p.offset, p.offset + p.size);
+            }
+            std::sort(occupied.begin(), occupied.end());
+            vk::DeviceSize offset{0};
+            for(auto &[begin, end]: occupied) {
+                if(offset + req.size <= begin) break;
+                offset = std::max(offset, (end + req.alignment - 1) / req.alignment * req.alignment);
+            }
+            heap->placements.push_back({idx, offset, req.size});
+            heap->memoryTypeBits &= req.memoryTypeBits;
+            heap->size = std::max(heap->size, offset + req.size);
+            heap->alignment = std::max(heap->alignment, req.alignment);
+        }
+    }
+
+    for(auto i = 0u; i < numFrames; ++i)
+        for(auto &heap: heaps) {
+            VkMemoryRequirements req{heap.size, heap.alignment, heap.memoryTypeBits};
+            VmaAllocationCreateInfo allocInfo{{}, VMA_MEMORY_USAGE_GPU_ONLY};
+            VmaAllocation allocation;
+            auto result = vmaAllocateMemory(device_.allocator(), &req, &allocInfo, &allocation, nullptr);
+            errorIf(result != VK_SUCCESS, "failed to allocate transient memory!");
+            transientHeaps.push_back(allocation);
+            device_.memoryTracker().add("transient heap", MemoryCategory::eRenderTargets, heap.size);
+            transientStats.aliased += heap.size;
+
+            for(auto &p: heap.placements) {
+                auto &t = transients[p.transient];
+                if(t.isTexture) {
+                    auto &texture = t.textures[i];
+                    texture->bind(allocation, p.offset);
+                    texture->setImageView(t.textureDesc.viewType, t.textureDesc.aspect);
+                } else
+                    t.buffers[i]->bind(allocation, p.offset);
+            }
+        }
+
+    debugLog(
+        "transient memory: ", transientStats.unaliased, " bytes without aliasing, ", transientStats.aliased,
+        " bytes with aliasing, ", heaps.size() * numFrames, " heaps");
+}
+}
@@ -0,0 +1,108 @@
+#include "frame_stats.hpp"
+#include <algorithm>
+#include "vkg/util/trace_recorder.hpp"
+
+namespace vkg {
+
+auto PassProfiler::Samples::add(double value) -> void {
+    values[next] = value;
+    next = (next + 1) % kHistorySize;
+    count = std::min(count + 1, kHistorySize);
+}
+
+auto PassProfiler::Samples::stats() const -> TimingStats {
+    if(count == 0) return {};
+    std::array<double, kHistorySize> sorted{};
+    std::copy_n(values.begin(), count, sorted.begin());
+    std::sort(sorted.begin(), sorted.begin() + count);
+    double sum{0};
+    for(auto i = 0u; i < count; ++i)
+        sum += sorted[i];
+    auto p99 = std::min(count - 1, size_t(double(count) * 0.99));
+    return {sorted[0], sum / double(count), sorted[p99]};
+}
+
+PassProfiler::PassProfiler(
+    Device &device, std::vector<std::string> names, std::vector<uint32_t> tracks, uint32_t numFrames)
+    : device{device},
+      supported{device.limits().timestampComputeAndGraphics == VK_TRUE},
+      timestampPeriod{device.limits().timestampPeriod},
+      names{std::move(names)},
+      tracks{std::move(tracks)},
+      history(this->names.size()) {
+    auto numPasses = uint32_t(history.size());
+    if(!supported || numPasses == 0) return;
+    queryPools.resize(numFrames);
+    written.resize(size_t(numFrames) * numPasses);
+    for(auto &pool: queryPools) {
+        pool = device.vkDevice().createQueryPoolUnique({{}, vk::QueryType::eTimestamp, 2 * numPasses});
+        device.vkDevice().resetQueryPool(*pool, 0, 2 * numPasses);
+    }
+}
+
+auto PassProfiler::beginFrame(uint32_t frameIndex_) -> void {
+    frameIndex = frameIndex_;
+    if(queryPools.empty()) return;
+    auto numPasses = uint32_t(history.size());
+    auto &pool = queryPools[frameIndex];
+    // the frame graph only runs this frame after its previous submission finished, so the results are ready.
+    std::vector<uint64_t> results(4 * size_t(numPasses));
+    auto result = device.vkDevice().getQueryPoolResults(
+        *pool, 0, 2 * numPasses, results.size() * sizeof(uint64_t), results.data(), 2 * sizeof(uint64_t),
+        vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWithAvailability);
+    auto &recorder = TraceRecorder::instance();
+    // place the device clock on the host clock by sampling both at (almost) the same time.
+    double offsetNs{0};
+    auto calibrated = false;
+    if(recorder.recording()) {
+        auto before = TraceRecorder::now();
+        auto gpuNow = device.gpuTimestamp();
+        auto after = TraceRecorder::now();
+        calibrated = gpuNow != 0;
+        offsetNs = double(before / 2 + after / 2) - double(gpuNow) * timestampPeriod;
+    }
+    auto frameBegin = ~uint64_t(0), frameEnd = uint64_t(0);
+    if(result == vk::Result::eSuccess || result == vk::Result::eNotReady)
+        for(auto i = 0u; i < numPasses; ++i) {
+            if(!written[size_t(frameIndex) * numPasses + i]) continue;
+            auto begin = results[4 * i], beginAvailable = results[4 * i + 1];
+            auto end = results[4 * i + 2], endAvailable = results[4 * i + 3];
+            if(!beginAvailable || !endAvailable || end < begin) continue;
+            history[i].gpu.add(double(end - begin) * timestampPeriod / 1e6);
+            frameBegin = std::min(frameBegin, begin);
+            frameEnd = std::max(frameEnd, end);
+            if(calibrated)
+                recorder.span(
+                    names[i], "gpu", uint64_t(offsetNs + double(begin) * timestampPeriod),
+                    uint64_t(offsetNs + double(end) * timestampPeriod), TraceRecorder::kGPU, tracks[i]);
+        }
+    frameTime_ = frameEnd > frameBegin ? double(frameEnd - frameBegin) * timestampPeriod / 1e6 : 0;
+    device.vkDevice().resetQueryPool(*pool, 0, 2 * numPasses);
+    std::fill_n(written.begin() + size_t(frameIndex) * numPasses, numPasses, 0);
+}
+
+auto PassProfiler::writeBegin(vk::CommandBuffer cb, uint32_t passId) -> void {
+    if(queryPools.empty()) return;
+    cb.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, *queryPools[frameIndex], 2 * passId);
+}
+
+auto PassProfiler::writeEnd(vk::CommandBuffer cb, uint32_t passId) -> void {
+    if(queryPools.empty()) return;
+    cb.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, *queryPools[frameIndex], 2 * passId + 1);
+    written[size_t(frameIndex) * history.size() + passId] = 1;
+}
+
+auto PassProfiler::recordCompile(uint32_t passId, double ms) -> void { history[passId].compile.add(ms); }
+auto PassProfiler::recordExecute(uint32_t passId, double ms) -> void { history[passId].execute.add(ms); }
+
+auto PassProfiler::frameTime() const -> double { return frameTime_; }
+
+auto PassProfiler::stats() const -> FrameStats {
+    FrameStats frameStats;
+    for(auto i = 0u; i < history.size(); ++i) {
+        auto &h = history[i];
+        frameStats.passes.push_back({names[i], h.gpu.stats(), h.compile.stats(), h.execute.stats()});
+    }
+    return frameStats;
+}
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include "vkg/base/vk_headers.hpp"
+#include "vkg/base/device.hpp"
+#include <array>
+#include <string>
+#include <vector>
+
+namespace vkg {
+/** milliseconds over the recent frames. */
+struct TimingStats {
+    double min{0}, avg{0}, p99{0};
+};
+
+struct PassStats {
+    std::string name;
+    /** time between the timestamps written before and after the pass, including its barriers. */
+    TimingStats gpu;
+    TimingStats cpuCompile;
+    TimingStats cpuExecute;
+};
+
+struct FrameStats {
+    std::vector<PassStats> passes;
+};
+
+/**
+ * Collects per pass GPU timestamps and CPU timings. Each frame in flight has its own query pool, which
+ * is read back when that frame comes around again, so reading results never waits on the GPU. While a
+ * trace is recorded, the timestamps are also emitted as GPU spans on the track of the pass's queue.
+ */
+class PassProfiler {
+public:
+    PassProfiler(Device &device, std::vector<std::string> names, std::vector<uint32_t> tracks, uint32_t numFrames);
+
+    /** read back the queries last written for this frame and reset them. */
+    auto beginFrame(uint32_t frameIndex) -> void;
+    auto writeBegin(vk::CommandBuffer cb, uint32_t passId) -> void;
+    auto writeEnd(vk::CommandBuffer cb, uint32_t passId) -> void;
+    /** safe to call from different threads for different passes. */
+    auto recordCompile(uint32_t passId, double ms) -> void;
+    auto recordExecute(uint32_t passId, double ms) -> void;
+
+    auto stats() const -> FrameStats;
+    /** GPU milliseconds from the first to the last pass of the frame read back last, 0 if unknown. */
+    auto frameTime() const -> double;
+
+private:
+    static const size_t kHistorySize{128};
+    struct Samples {
+        std::array<double, kHistorySize> values{};
+        size_t next{0}, count{0};
+
+        auto add(double value) -> void;
+        auto stats() const -> TimingStats;
+    };
+    struct History {
+        Samples gpu, compile, execute;
+    };
+
+    Device &device;
+    bool supported;
+    double timestampPeriod;
+    uint32_t frameIndex{0};
+    double frameTime_{0};
+    std::vector<std::string> names;
+    std::vector<uint32_t> tracks;
+    std::vector<History> history;
+    std::vector<vk::UniqueQueryPool> queryPools;
+    std::vector<uint8_t> written;
+};
+}
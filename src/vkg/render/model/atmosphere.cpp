@@ -1,4 +1,5 @@
 #include "atmosphere.hpp"
+#include <algorithm>
 namespace vkg {
 
 auto AtmosphereSetting::isEnabled() const -> bool { return enabled_; }
@@ -19,10 +20,36 @@ void AtmosphereSetting::setSunIntensity(float sunIntensity) {
 }
 auto AtmosphereSetting::exposure() const -> float { return exposure_; }
 void AtmosphereSetting::setExposure(float exposure) { exposure_ = exposure; }
-auto AtmosphereSetting::sunAngularRadius() const -> double { return kSunAngularRadius_; }
-auto AtmosphereSetting::sunSolidAngle() const -> double { return kSunSolidAngle_; }
+auto AtmosphereSetting::sunAngularRadius() const -> double { return sunAngularRadius_; }
+void AtmosphereSetting::setSunAngularRadius(double sunAngularRadius) {
+  if(sunAngularRadius == sunAngularRadius_) return;
+  sunAngularRadius_ = sunAngularRadius;
+  version_++;
+}
+auto AtmosphereSetting::sunSolidAngle() const -> double {
+  return glm::pi<double>() * sunAngularRadius_ * sunAngularRadius_;
+}
 auto AtmosphereSetting::lengthUnitInMeters() const -> double {
-  return kLengthUnitInMeters_;
+  return lengthUnitInMeters_;
+}
+auto AtmosphereSetting::bottomRadius() const -> double { return bottomRadius_; }
+void AtmosphereSetting::setBottomRadius(double bottomRadius) {
+  if(bottomRadius == bottomRadius_) return;
+  bottomRadius_ = bottomRadius;
+  earthCenter_ = {0, -bottomRadius_ / lengthUnitInMeters_, 0};
+  version_++;
+}
+auto AtmosphereSetting::topRadius() const -> double { return topRadius_; }
+void AtmosphereSetting::setTopRadius(double topRadius) {
+  if(topRadius == topRadius_) return;
+  topRadius_ = topRadius;
+  version_++;
+}
+auto AtmosphereSetting::version() const -> uint64_t { return version_; }
+auto AtmosphereSetting::precomputeStepsPerFrame() const -> uint32_t {
+  return precomputeStepsPerFrame_;
+}
+void AtmosphereSetting::setPrecomputeStepsPerFrame(uint32_t steps) {
+  precomputeStepsPerFrame_ = std::max(steps, 1u);
 }
-auto AtmosphereSetting::bottomRadius() const -> double { return kBottomRadius_; }
 }
\ No newline at end of file
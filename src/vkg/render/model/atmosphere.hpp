@@ -1,5 +1,6 @@
 #pragma once
 #include "vkg/math/glm_common.hpp"
+#include <cstdint>
 
 namespace vkg {
 class AtmosphereSetting {
@@ -18,20 +19,34 @@ public:
   void setExposure(float exposure);
 
   auto sunAngularRadius() const -> double;
+  void setSunAngularRadius(double sunAngularRadius);
   auto sunSolidAngle() const -> double;
   auto lengthUnitInMeters() const -> double;
   auto bottomRadius() const -> double;
-
-  const double kSunAngularRadius_{0.00935 / 2.0};
-  const double kSunSolidAngle_{
-    glm::pi<double>() * kSunAngularRadius_ * kSunAngularRadius_};
-  const double kLengthUnitInMeters_{1.0};
-  const double kBottomRadius_{6360000.0};
-  const double kTopRadius{6420000.0};
+  /** also moves the earth center, keeping the ground at the origin. */
+  void setBottomRadius(double bottomRadius);
+  auto topRadius() const -> double;
+  void setTopRadius(double topRadius);
+  /**
+   * increased every time a parameter the LUTs are precomputed from changes. The LUTs
+   * of the new parameters are precomputed over the next frames, the old ones are
+   * rendered meanwhile.
+   */
+  auto version() const -> uint64_t;
+  /** dispatches of the precompute recorded per frame while the LUTs are recomputed. */
+  auto precomputeStepsPerFrame() const -> uint32_t;
+  void setPrecomputeStepsPerFrame(uint32_t steps);
 
 private:
+  double sunAngularRadius_{0.00935 / 2.0};
+  double lengthUnitInMeters_{1.0};
+  double bottomRadius_{6360000.0};
+  double topRadius_{6420000.0};
+  uint64_t version_{0};
+  uint32_t precomputeStepsPerFrame_{4};
+
   glm::vec3 sunDirection_{0, 1, 0};
-  glm::vec3 earthCenter_{0, -kBottomRadius_ / kLengthUnitInMeters_, 0};
+  glm::vec3 earthCenter_{0, -bottomRadius_ / lengthUnitInMeters_, 0};
   float sunIntensity_{1};
   float exposure_{10.0};
   bool enabled_{true};
@@ -12,16 +12,33 @@ Camera::Camera(
     zNear_(zNear),
     zFar_(zFar),
     width_(width),
-    height_(height) {}
+    height_(height),
+    renderWidth_(width),
+    renderHeight_(height) {}
 auto Camera::location() const -> glm::vec3 { return location_; }
 auto Camera::direction() const -> glm::vec3 { return focus_ - location_; }
 auto Camera::worldUp() const -> glm::vec3 { return worldUp_; }
 auto Camera::view() const -> glm::mat4 { return viewMatrix(location_, focus_, worldUp_); }
 auto Camera::proj() const -> glm::mat4 {
+  if(jitter_ == glm::vec2(0)) return unjitteredProj();
+  // translate in clip space, which is scaled by w so the offset is constant in NDC.
+  glm::mat4 offset{1};
+  offset[3] = glm::vec4(2.f * jitter_ / glm::vec2(renderWidth_, renderHeight_), 0, 1);
+  return offset * unjitteredProj();
+}
+auto Camera::unjitteredProj() const -> glm::mat4 {
   return perspectiveMatrix(fov_, float(width_) / float(height_), zNear_, zFar_);
 }
 auto Camera::width() const -> uint32_t { return width_; }
 auto Camera::height() const -> uint32_t { return height_; }
+auto Camera::renderWidth() const -> uint32_t { return renderWidth_; }
+auto Camera::renderHeight() const -> uint32_t { return renderHeight_; }
+auto Camera::setRenderExtent(uint32_t width, uint32_t height) -> void {
+  renderWidth_ = width;
+  renderHeight_ = height;
+}
+auto Camera::jitter() const -> glm::vec2 { return jitter_; }
+auto Camera::setJitter(glm::vec2 jitter) -> void { jitter_ = jitter; }
 auto Camera::zFar() const -> float { return zFar_; }
 auto Camera::zNear() const -> float { return zNear_; }
 
@@ -31,9 +48,17 @@ auto Camera::setWorldUp(glm::vec3 worldUp) -> void { worldUp_ = worldUp; }
 auto Camera::resize(uint32_t width, uint32_t height) -> void {
   width_ = width;
   height_ = height;
+  renderWidth_ = width;
+  renderHeight_ = height;
 }
 auto Camera::setZFar(float zFar) -> void { zFar_ = zFar; }
 auto Camera::setZNear(float zNear) -> void { zNear_ = zNear; }
+auto Camera::cullMinPixels() const -> float { return cullMinPixels_; }
+auto Camera::setCullMinPixels(float minPixels) -> void { cullMinPixels_ = minPixels; }
+auto Camera::cullMaxDistance() const -> float { return cullMaxDistance_; }
+auto Camera::setCullMaxDistance(float maxDistance) -> void {
+  cullMaxDistance_ = maxDistance;
+}
 
 auto Camera::desc() -> Desc {
   auto proj_ = proj();
@@ -42,9 +67,24 @@ auto Camera::desc() -> Desc {
   auto invProjView = glm::inverse(projView);
   auto v = glm::vec4(normalize(focus_ - location_), 1);
   auto r = glm::vec4(normalize(cross(glm::vec3(v), worldUp_)), 1);
-  return {view_,  proj_, projView,      invProjView,    glm::vec4(location_, 1.0),
-          r,      v,     float(width_), float(height_), fov_,
-          zNear_, zFar_};
+  auto unjitteredProjView = unjitteredProj() * view_;
+  // shaders map fragment coordinates to the view by the render extent.
+  return {view_,
+          proj_,
+          projView,
+          invProjView,
+          glm::vec4(location_, 1.0),
+          r,
+          v,
+          float(renderWidth_),
+          float(renderHeight_),
+          fov_,
+          zNear_,
+          zFar_,
+          0,
+          unjitteredProjView,
+          unjitteredProjView,
+          jitter_};
 }
 auto Camera::fov() -> float { return fov_; }
 
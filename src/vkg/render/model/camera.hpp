@@ -16,6 +16,11 @@ public:
     float w, h, fov;
     float zNear, zFar;
     uint32_t frame;
+    /** without the jitter, for motion vectors. */
+    glm::mat4 unjitteredProjView;
+    /** unjittered projView of the previous frame. */
+    glm::mat4 prevProjView;
+    glm::vec2 jitter;
   };
 
   Camera(
@@ -34,10 +39,28 @@ public:
   auto fov() -> float;
   auto setZFar(float zFar) -> void;
   auto setZNear(float zNear) -> void;
+  /** instances covering fewer pixels on screen are culled, 0 to draw them all. */
+  auto cullMinPixels() const -> float;
+  auto setCullMinPixels(float minPixels) -> void;
+  /** instances farther from the camera are culled, 0 to draw them all. */
+  auto cullMaxDistance() const -> float;
+  auto setCullMaxDistance(float maxDistance) -> void;
   auto view() const -> glm::mat4;
+  /** the projection offset by the jitter. */
   auto proj() const -> glm::mat4;
+  auto unjitteredProj() const -> glm::mat4;
   auto width() const -> uint32_t;
   auto height() const -> uint32_t;
+  /**
+   * pixels the view is rendered at, smaller than the size under dynamic resolution. Reset
+   * to the size by `resize`.
+   */
+  auto renderWidth() const -> uint32_t;
+  auto renderHeight() const -> uint32_t;
+  auto setRenderExtent(uint32_t width, uint32_t height) -> void;
+  /** sub pixel offset of the projection in pixels of the render extent. */
+  auto jitter() const -> glm::vec2;
+  auto setJitter(glm::vec2 jitter) -> void;
   auto desc() -> Desc;
 
 protected:
@@ -47,5 +70,8 @@ protected:
   float fov_;
   float zNear_, zFar_;
   uint32_t width_, height_;
+  uint32_t renderWidth_, renderHeight_;
+  glm::vec2 jitter_{0};
+  float cullMinPixels_{0}, cullMaxDistance_{0};
 };
 }
\ No newline at end of file
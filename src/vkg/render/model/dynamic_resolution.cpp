@@ -0,0 +1,39 @@
+#include "dynamic_resolution.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace vkg {
+auto DynamicResolutionSetting::isEnabled() const -> bool { return enabled_; }
+auto DynamicResolutionSetting::enable(bool enabled) -> void { enabled_ = enabled; }
+auto DynamicResolutionSetting::targetFrameTime() const -> float {
+  return targetFrameTime_;
+}
+void DynamicResolutionSetting::setTargetFrameTime(float frameTime) {
+  targetFrameTime_ = frameTime;
+}
+auto DynamicResolutionSetting::minScale() const -> float { return minScale_; }
+void DynamicResolutionSetting::setMinScale(float minScale) { minScale_ = minScale; }
+auto DynamicResolutionSetting::maxScale() const -> float { return maxScale_; }
+void DynamicResolutionSetting::setMaxScale(float maxScale) { maxScale_ = maxScale; }
+auto DynamicResolutionSetting::sharpness() const -> float { return sharpness_; }
+void DynamicResolutionSetting::setSharpness(float sharpness) { sharpness_ = sharpness; }
+auto DynamicResolutionSetting::scale() const -> float { return scale_; }
+
+auto DynamicResolutionSetting::update(double frameTime) -> void {
+  auto lo = std::clamp(minScale_, 0.1f, 1.f), hi = std::clamp(maxScale_, lo, 1.f);
+  if(frameTime <= 0 || targetFrameTime_ <= 0) {
+    scale_ = std::clamp(scale_, lo, hi);
+    return;
+  }
+  // settle a little under the budget instead of oscillating around it.
+  if(frameTime <= targetFrameTime_ && frameTime > targetFrameTime_ * 0.9) {
+    scale_ = std::clamp(scale_, lo, hi);
+    return;
+  }
+  // the GPU time roughly follows the number of pixels, the square of the scale.
+  auto next = scale_ * float(std::sqrt(targetFrameTime_ / frameTime));
+  // drop quickly under load spikes, recover slowly as the measured frame lags behind.
+  auto rate = next < scale_ ? 0.5f : 0.1f;
+  scale_ = std::clamp(scale_ + (next - scale_) * rate, lo, hi);
+}
+}
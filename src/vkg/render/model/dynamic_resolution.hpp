@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+
+namespace vkg {
+/**
+ * Scales the resolution the scene is rendered at to hold the GPU frame time within a
+ * budget. Render targets keep the output size and are only partly rendered to, the result
+ * is upscaled to the output size before post processing.
+ */
+class DynamicResolutionSetting {
+public:
+  auto isEnabled() const -> bool;
+  auto enable(bool enabled) -> void;
+  /** GPU milliseconds per frame the scale is adjusted to meet. */
+  auto targetFrameTime() const -> float;
+  void setTargetFrameTime(float frameTime);
+  /** fraction of the output size in each dimension. */
+  auto minScale() const -> float;
+  void setMinScale(float minScale);
+  auto maxScale() const -> float;
+  void setMaxScale(float maxScale);
+  /** strength of the sharpening applied when upscaling, 0 for plain bilinear. */
+  auto sharpness() const -> float;
+  void setSharpness(float sharpness);
+  /** the scale the scene is currently rendered at. */
+  auto scale() const -> float;
+
+  /** move the scale towards the budget from the GPU milliseconds of a recent frame. */
+  auto update(double frameTime) -> void;
+
+private:
+  bool enabled_{false};
+  float targetFrameTime_{16.6f};
+  float minScale_{0.5f}, maxScale_{1.f};
+  float sharpness_{0.25f};
+  float scale_{1.f};
+};
+}
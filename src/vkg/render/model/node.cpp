@@ -20,6 +20,8 @@ auto Node::setTransform(const Transform &transform) -> void {
   errorIf(frozen, "Frozen node cannot be modified!");
   transform_ = transform;
   *transf.ptr = transform;
+  // the node's meshes may be static shadow casters.
+  scene.shadowmap().invalidateStaticCasters();
 }
 auto Node::setName(const std::string &name) -> void { name_ = name; }
 auto Node::addMeshes(std::vector<uint32_t> &&meshes) -> void {
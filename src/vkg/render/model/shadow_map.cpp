@@ -12,4 +12,16 @@ void ShadowMapSetting::setTextureSize(uint32_t textureSize) {
 }
 auto ShadowMapSetting::zFar() const -> float { return zfar_; }
 void ShadowMapSetting::setZFar(float far) { zfar_ = far; }
+auto ShadowMapSetting::cullMinTexels() const -> float { return cullMinTexels_; }
+void ShadowMapSetting::setCullMinTexels(float minTexels) { cullMinTexels_ = minTexels; }
+auto ShadowMapSetting::cullMaxDistance() const -> float { return cullMaxDistance_; }
+void ShadowMapSetting::setCullMaxDistance(float maxDistance) {
+  cullMaxDistance_ = maxDistance;
+}
+auto ShadowMapSetting::cacheStaticCasters() const -> bool { return cacheStaticCasters_; }
+void ShadowMapSetting::setCacheStaticCasters(bool cache) { cacheStaticCasters_ = cache; }
+auto ShadowMapSetting::staticCastersVersion() const -> uint64_t {
+  return staticCastersVersion_;
+}
+void ShadowMapSetting::invalidateStaticCasters() { ++staticCastersVersion_; }
 }
@@ -12,11 +12,31 @@ public:
   void setTextureSize(uint32_t textureSize);
   auto zFar() const -> float;
   void setZFar(float far);
+  /** casters covering fewer shadow map texels are culled, 0 to draw them all. */
+  auto cullMinTexels() const -> float;
+  void setCullMinTexels(float minTexels);
+  /** casters farther from the camera are culled, 0 to draw them all. */
+  auto cullMaxDistance() const -> float;
+  void setCullMaxDistance(float maxDistance);
+  /**
+   * whether the depth of static casters is kept per cascade and only re-rendered when the
+   * cascade moves or the static world changes. Instances and primitives created per frame
+   * are dynamic casters and are drawn every frame. Moving a node or an instance invalidates
+   * the cache, so scenes animating nodes every frame should disable it.
+   */
+  auto cacheStaticCasters() const -> bool;
+  void setCacheStaticCasters(bool cache);
+  /** increased every time static casters change, re-rendering the cached depth. */
+  auto staticCastersVersion() const -> uint64_t;
+  void invalidateStaticCasters();
 
 private:
   bool enabled_{false};
   uint32_t numCascades_{4};
   uint32_t textureSize_{4096};
   float zfar_{0};
+  float cullMinTexels_{0}, cullMaxDistance_{0};
+  bool cacheStaticCasters_{true};
+  uint64_t staticCastersVersion_{0};
 };
 }
@@ -0,0 +1,9 @@
+#include "temporal_aa.hpp"
+namespace vkg {
+auto TemporalAASetting::isEnabled() const -> bool { return enabled_; }
+auto TemporalAASetting::enable(bool enabled) -> void { enabled_ = enabled; }
+auto TemporalAASetting::feedback() const -> float { return feedback_; }
+void TemporalAASetting::setFeedback(float feedback) { feedback_ = feedback; }
+auto TemporalAASetting::historyVersion() const -> uint64_t { return historyVersion_; }
+void TemporalAASetting::resetHistory() { ++historyVersion_; }
+}
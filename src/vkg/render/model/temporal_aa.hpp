@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdint>
+
+namespace vkg {
+/**
+ * Temporal anti-aliasing: the projection is jittered every frame and the lit image is blended
+ * with the history reprojected by motion vectors. Replaces FXAA while enabled.
+ */
+class TemporalAASetting {
+public:
+  auto isEnabled() const -> bool;
+  auto enable(bool enabled) -> void;
+  /** weight of the history in the blend, higher is smoother but slower to converge. */
+  auto feedback() const -> float;
+  void setFeedback(float feedback);
+  /** increased every time the history is discarded, e.g. on camera cuts. */
+  auto historyVersion() const -> uint64_t;
+  void resetHistory();
+
+private:
+  bool enabled_{false};
+  float feedback_{0.9f};
+  uint64_t historyVersion_{0};
+};
+}
@@ -0,0 +1,104 @@
+#include "atmosphere_model.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace vkg {
+namespace {
+/** increased whenever the layout of the file or the meaning of the LUTs changes. */
+constexpr uint32_t cacheVersion = 1;
+constexpr char cacheMagic[4] = {'V', 'K', 'G', 'A'};
+
+struct CacheHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t key;
+};
+
+auto texBytes(Texture &texture) -> size_t {
+    auto extent = texture.extent();
+    // the LUTs are all RGBA32F.
+    return size_t(extent.width) * extent.height * extent.depth * 4 * sizeof(float);
+}
+}
+
+auto AtmosphereModel::load(uint32_t queueIdx, const std::string &path, uint32_t num_scattering_orders) -> bool {
+    std::ifstream file(path, std::ios::binary);
+    if(!file.good()) return false;
+    CacheHeader header{};
+    file.read(reinterpret_cast<char *>(&header), sizeof(header));
+    if(!file.good() || std::memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0 ||
+       header.version != cacheVersion || header.key != cacheKey(num_scattering_orders)) {
+        debugLog("atmosphere cache ", path, " was saved for other parameters, ignored");
+        return false;
+    }
+
+    std::vector<std::byte> bytes;
+    for(auto *texture: {transmittanceTex_.get(), scatteringTex_.get(), irradianceTex_.get()}) {
+        bytes.resize(texBytes(*texture));
+        file.read(reinterpret_cast<char *>(bytes.data()), std::streamsize(bytes.size()));
+        if(!file.good()) {
+            debugLog("atmosphere cache ", path, " is truncated, ignored");
+            return false;
+        }
+        image::upload(queueIdx, *texture, bytes);
+    }
+
+    useRGBParameters();
+    num_scattering_orders_ = num_scattering_orders;
+    return true;
+}
+
+auto AtmosphereModel::save(uint32_t queueIdx, const std::string &path) -> bool {
+    std::array textures{transmittanceTex_.get(), scatteringTex_.get(), irradianceTex_.get()};
+    vk::DeviceSize total = 0;
+    for(auto *texture: textures)
+        total += texBytes(*texture);
+    auto readback = buffer::readbackBuffer(device, vk::BufferUsageFlagBits::eTransferDst, total, "atmosphereReadback");
+    device.execSync(
+        [&](vk::CommandBuffer cb) {
+            vk::DeviceSize offset = 0;
+            for(auto *texture: textures) {
+                image::transitTo(
+                    cb, *texture, vk::ImageLayout::eTransferSrcOptimal, vk::AccessFlagBits::eTransferRead,
+                    vk::PipelineStageFlagBits::eTransfer);
+                vk::BufferImageCopy region{
+                    offset, 0, 0, {vk::ImageAspectFlagBits::eColor, 0, 0, 1}, {}, texture->extent()};
+                cb.copyImageToBuffer(
+                    texture->image(), vk::ImageLayout::eTransferSrcOptimal, readback->bufferInfo().buffer, region);
+                image::transitTo(
+                    cb, *texture, vk::ImageLayout::eShaderReadOnlyOptimal, vk::AccessFlagBits::eShaderRead,
+                    vk::PipelineStageFlagBits::eAllCommands);
+                offset += texBytes(*texture);
+            }
+            readback->barrier(
+                cb, vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eHostRead,
+                vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost);
+        },
+        queueIdx);
+
+    CacheHeader header{};
+    std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+    header.version = cacheVersion;
+    header.key = cacheKey(num_scattering_orders_);
+    // write to a temporary file first so an interrupted save never leaves a truncated cache behind.
+    auto tmpPath = path + ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        if(!file.good()) {
+            debugLog("failed to write atmosphere cache ", tmpPath);
+            return false;
+        }
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(readback->ptr<const char>(), std::streamsize(total));
+        if(!file.good()) {
+            debugLog("failed to write atmosphere cache ", tmpPath);
+            return false;
+        }
+    }
+    std::remove(path.c_str());
+    std::rename(tmpPath.c_str(), path.c_str());
+    debugLog("atmosphere cache: saved ", total, " bytes to ", path);
+    return true;
+}
+}
@@ -1,5 +1,6 @@
 #include "atmosphere_model.hpp"
 #include "constants.hpp"
+#include <cstddef>
 
 namespace vkg {
 namespace {
@@ -120,6 +121,14 @@ auto luminanceFromRadiance(double dlambda, const glm::vec3 &lambdas) -> glm::mat
     return luminance_from_radiance;
 }
 
+/** FNV-1a, unlike `std::hash` it is the same on every run and platform. */
+auto hashBytes(uint64_t hash, const void *data, size_t size) -> uint64_t {
+    auto *bytes = static_cast<const uint8_t *>(data);
+    for(size_t i = 0; i < size; ++i)
+        hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+    return hash;
+}
+
 auto makeTex(
     Device &device, vk::ImageType type, uint32_t width, uint32_t height, uint32_t depth, vk::Format format,
     const std::string &name) -> std::unique_ptr<Texture> {
@@ -309,7 +318,7 @@ auto AtmosphereModel::createDescriptors() -> void {
     createMultipleScatteringSets();
 }
 
-auto AtmosphereModel::init(uint32_t queueIdx, uint32_t num_scattering_orders) -> void {
+auto AtmosphereModel::createScratch() -> void {
     deltaIrradianceTex = makeTex(
         device, vk::ImageType::e2D, IRRADIANCE_TEXTURE_WIDTH, IRRADIANCE_TEXTURE_HEIGHT, 1,
         vk::Format::eR32G32B32A32Sfloat, "deltaIrradianceTex");
@@ -324,56 +333,113 @@ auto AtmosphereModel::init(uint32_t queueIdx, uint32_t num_scattering_orders) ->
         vk::Format::eR32G32B32A32Sfloat, "deltaScatteringDensityTex");
 
     createDescriptors();
+}
 
-    compute(queueIdx, num_scattering_orders);
-
+auto AtmosphereModel::releaseScratch() -> void {
     deltaIrradianceTex.reset();
     deltaRayleighScatteringTex.reset();
     deltaMieScatteringTex.reset();
     deltaScatteringDensityTex.reset();
 }
 
-auto AtmosphereModel::compute(uint32_t queueIdx, uint32_t num_scattering_orders) -> void {
+auto AtmosphereModel::init(uint32_t queueIdx, uint32_t num_scattering_orders) -> void {
+    createScratch();
+
+    for(auto &step: precomputeSteps(num_scattering_orders))
+        device.execSync(step, queueIdx);
+    num_scattering_orders_ = num_scattering_orders;
+
+    releaseScratch();
+}
+
+auto AtmosphereModel::beginPrecompute(uint32_t num_scattering_orders) -> void {
+    createScratch();
+
+    pendingSteps = precomputeSteps(num_scattering_orders);
+    nextStep = 0;
+    num_scattering_orders_ = num_scattering_orders;
+}
+
+auto AtmosphereModel::recordPrecompute(vk::CommandBuffer cb, uint32_t maxSteps) -> bool {
+    for(auto i = 0u; i < maxSteps && nextStep < pendingSteps.size(); ++i)
+        pendingSteps[nextStep++](cb);
+    if(nextStep < pendingSteps.size()) return false;
+    pendingSteps.clear();
+    nextStep = 0;
+    return true;
+}
+
+auto AtmosphereModel::precomputeSteps(uint32_t num_scattering_orders) -> std::vector<PrecomputeStep> {
     constexpr double _kLambdaMin = 360.0;
     constexpr double _kLambdaMax = 830.0;
     int num_iterations = (int(num_precomputed_wavelengths_) + 2) / 3;
     double dlambda = (_kLambdaMax - _kLambdaMin) / (3 * num_iterations);
 
+    std::vector<PrecomputeStep> steps;
     for(int i = 0; i < num_iterations; ++i) {
         glm::vec3 lambdas{
             _kLambdaMin + (3 * i + 0.5) * dlambda, _kLambdaMin + (3 * i + 1.5) * dlambda,
             _kLambdaMin + (3 * i + 2.5) * dlambda};
 
         glm::mat4 luminance_from_radiance = luminanceFromRadiance(dlambda, lambdas);
-        precompute(queueIdx, lambdas, luminance_from_radiance, i > 0, num_scattering_orders);
+        auto cumulate = vk::Bool32(i > 0);
+        auto params = calcAtmosphereParams(lambdas);
+
+        steps.emplace_back([=, this](vk::CommandBuffer cb) {
+            recordAtmosphereUpdate(cb, params);
+            recordTransmittanceCMD(cb);
+        });
+        steps.emplace_back([=, this](vk::CommandBuffer cb) { recordDirectIrradianceCMD(cb, cumulate); });
+        steps.emplace_back(
+            [=, this](vk::CommandBuffer cb) { recordSingleScatteringCMD(cb, luminance_from_radiance, cumulate); });
+
+        for(auto scatteringOrder = 2u; scatteringOrder <= num_scattering_orders; ++scatteringOrder) {
+            auto order = int32_t(scatteringOrder);
+            steps.emplace_back([=, this](vk::CommandBuffer cb) { recordScatteringDensityCMD(cb, order); });
+            steps.emplace_back([=, this](vk::CommandBuffer cb) {
+                recordIndirectIrradianceCMD(cb, luminance_from_radiance, order - 1);
+            });
+            steps.emplace_back(
+                [=, this](vk::CommandBuffer cb) { recordMultipleScatteringCMD(cb, luminance_from_radiance); });
+        }
     }
 
-    atmosphereUBO_->ptr<AtmosphereUniform>()->atmosphere = calcAtmosphereParams({kLambdaR, kLambdaG, kLambdaB});
+    auto rgbParams = calcAtmosphereParams({kLambdaR, kLambdaG, kLambdaB});
+    steps.emplace_back([=, this](vk::CommandBuffer cb) {
+        recordAtmosphereUpdate(cb, rgbParams);
+        recordTransmittanceCMD(cb);
+        // the LUTs and the parameters are read by the render passes from here on.
+        cb.pipelineBarrier(
+            vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eTransfer,
+            vk::PipelineStageFlagBits::eAllCommands, {},
+            vk::MemoryBarrier{
+                vk::AccessFlagBits::eShaderWrite | vk::AccessFlagBits::eTransferWrite,
+                vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eUniformRead},
+            nullptr, nullptr);
+    });
+    return steps;
+}
 
-    device.execSync([&](vk::CommandBuffer cb) { recordTransmittanceCMD(cb); }, queueIdx);
+auto AtmosphereModel::recordAtmosphereUpdate(vk::CommandBuffer cb, const AtmosphereParameters &params) -> void {
+    // the dispatches of the previous wavelengths may still read the parameters.
+    cb.pipelineBarrier(
+        vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eTransfer, {},
+        vk::MemoryBarrier{vk::AccessFlagBits::eUniformRead, vk::AccessFlagBits::eTransferWrite}, nullptr, nullptr);
+    auto info = atmosphereUBO_->bufferInfo();
+    cb.updateBuffer<AtmosphereParameters>(info.buffer, info.offset + offsetof(AtmosphereUniform, atmosphere), params);
+    cb.pipelineBarrier(
+        vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader, {},
+        vk::MemoryBarrier{vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eUniformRead}, nullptr, nullptr);
 }
 
-auto AtmosphereModel::precompute(
-    uint32_t queueIdx, const glm::vec3 &lambdas, const glm::mat4 &luminance_from_radiance, bool cumulate,
-    uint32_t num_scattering_orders) -> void {
-    auto _cumulate = vk::Bool32(cumulate);
-    atmosphereUBO_->ptr<AtmosphereUniform>()->atmosphere = calcAtmosphereParams(lambdas);
-    device.execSync([&](vk::CommandBuffer cb) { recordTransmittanceCMD(cb); }, queueIdx);
-    device.execSync([&](vk::CommandBuffer cb) { recordDirectIrradianceCMD(cb, _cumulate); }, queueIdx);
-    device.execSync(
-        [&](vk::CommandBuffer cb) { recordSingleScatteringCMD(cb, luminance_from_radiance, _cumulate); }, queueIdx);
-
-    for(auto scatteringOrder = 2u; scatteringOrder <= num_scattering_orders; ++scatteringOrder) {
-        device.execSync([&](vk::CommandBuffer cb) { recordScatteringDensityCMD(cb, scatteringOrder); }, queueIdx);
-        device.execSync(
-            [&](vk::CommandBuffer cb) {
-                recordIndirectIrradianceCMD(cb, luminance_from_radiance, scatteringOrder - 1);
-            },
-            queueIdx);
-        device.execSync(
-            [&](vk::CommandBuffer cb) { recordMultipleScatteringCMD(cb, luminance_from_radiance); }, queueIdx);
-    }
+auto AtmosphereModel::useRGBParameters() -> void {
+    atmosphereUBO_->ptr<AtmosphereUniform>()->atmosphere = calcAtmosphereParams({kLambdaR, kLambdaG, kLambdaB});
+}
+
+auto AtmosphereModel::cacheKey(uint32_t num_scattering_orders) const -> uint64_t {
+    return hashBytes(paramsKey, &num_scattering_orders, sizeof(num_scattering_orders));
 }
+
 auto AtmosphereModel::initParameter(
     const std::vector<double> &wavelengths, const std::vector<double> &solar_irradiance, double sun_angular_radius,
     double bottom_radius_, double top_radius, const std::vector<DensityProfileLayer> &rayleigh_density,
@@ -383,6 +449,38 @@ auto AtmosphereModel::initParameter(
     const std::vector<double> &ground_albedo, double max_sun_zenith_angle, float length_unit_in_meters_,
     unsigned int num_precomputed_wavelengths, float exposure_scale_, glm::vec3 sunDirection, glm::vec3 earthCenter)
     -> void {
+    {
+        uint64_t key = 0xcbf29ce484222325ull;
+        auto hash = [&](const auto &v) { key = hashBytes(key, &v, sizeof(v)); };
+        auto hashAll = [&](const auto &vector) {
+            hash(uint64_t(vector.size()));
+            for(auto &v: vector)
+                hash(v);
+        };
+        hashAll(wavelengths);
+        hashAll(solar_irradiance);
+        hash(sun_angular_radius);
+        hash(bottom_radius_);
+        hash(top_radius);
+        hashAll(rayleigh_density);
+        hashAll(rayleigh_scattering);
+        hashAll(mie_density);
+        hashAll(mie_scattering);
+        hashAll(mie_extinction);
+        hash(mie_phase_function_g);
+        hashAll(absorption_density);
+        hashAll(absorption_extinction);
+        hashAll(ground_albedo);
+        hash(max_sun_zenith_angle);
+        hash(length_unit_in_meters_);
+        hash(num_precomputed_wavelengths);
+        hash(do_white_balance_);
+        for(auto size: {TRANSMITTANCE_TEXTURE_WIDTH, TRANSMITTANCE_TEXTURE_HEIGHT, SCATTERING_TEXTURE_WIDTH,
+                        SCATTERING_TEXTURE_HEIGHT, SCATTERING_TEXTURE_DEPTH, IRRADIANCE_TEXTURE_WIDTH,
+                        IRRADIANCE_TEXTURE_HEIGHT})
+            hash(size);
+        paramsKey = key;
+    }
     num_precomputed_wavelengths_ = num_precomputed_wavelengths;
     bottom_radius = bottom_radius_;
     length_unit_in_meters = length_unit_in_meters_;
@@ -86,6 +86,30 @@ public:
         glm::vec3 sunDirection, glm::vec3 earthCenter);
 
     auto init(uint32_t queueIdx, uint32_t num_scattering_orders = 4) -> void;
+    /**
+     * prepares the same precompute as `init`, but to be recorded a few dispatches at a time by
+     * `recordPrecompute` into the command buffers of the next frames.
+     */
+    auto beginPrecompute(uint32_t num_scattering_orders = 4) -> void;
+    /**
+     * records at most `maxSteps` dispatches of the precompute started by `beginPrecompute`. Returns
+     * true once the last one is recorded, the LUTs are then ready for the commands after it.
+     */
+    auto recordPrecompute(vk::CommandBuffer cb, uint32_t maxSteps) -> bool;
+    /** frees the intermediate textures of the precompute, once no frame in flight uses them. */
+    auto releaseScratch() -> void;
+    /**
+     * hash of everything the LUTs depend on, the physical parameters of the atmosphere, the sizes of
+     * the LUTs and the number of scattering orders.
+     */
+    auto cacheKey(uint32_t num_scattering_orders = 4) const -> uint64_t;
+    /**
+     * fills the LUTs from a file written by `save` instead of precomputing them. Returns false if the
+     * file doesn't exist or was saved for other parameters.
+     */
+    auto load(uint32_t queueIdx, const std::string &path, uint32_t num_scattering_orders = 4) -> bool;
+    /** writes the LUTs precomputed by `init` or read by `load` to `path`. */
+    auto save(uint32_t queueIdx, const std::string &path) -> bool;
 
     auto atmosphereUBO() const -> BufferInfo;
     auto sunUBO() const -> BufferInfo;
@@ -129,10 +153,14 @@ private:
 
     auto createMultipleScatteringSets() -> void;
     auto recordMultipleScatteringCMD(vk::CommandBuffer cb, const glm::mat4 &luminance_from_radiance) -> void;
-    auto compute(uint32_t queueIdx, uint32_t num_scattering_orders) -> void;
-    auto precompute(
-        uint32_t queueIdx, const glm::vec3 &lambdas, const glm::mat4 &luminance_from_radiance, bool cumulate,
-        uint32_t num_scattering_orders) -> void;
+    auto createScratch() -> void;
+    /** the atmosphere parameters of the rendered RGB wavelengths, used to look up the LUTs. */
+    auto useRGBParameters() -> void;
+    /** writes the atmosphere parameters from the command buffer, ordered with the dispatches around it. */
+    auto recordAtmosphereUpdate(vk::CommandBuffer cb, const AtmosphereParameters &params) -> void;
+    using PrecomputeStep = std::function<void(vk::CommandBuffer cb)>;
+    /** the precompute split in the dispatches of each pass, in the order they must be recorded. */
+    auto precomputeSteps(uint32_t num_scattering_orders) -> std::vector<PrecomputeStep>;
 
 private:
     Device &device;
@@ -145,6 +173,14 @@ private:
 
     std::unique_ptr<Buffer> atmosphereUBO_, sunUBO_;
 
+    /** hash of the parameters, see `cacheKey`. */
+    uint64_t paramsKey{0};
+    /** scattering orders of the current LUTs. */
+    uint32_t num_scattering_orders_{0};
+
+    std::vector<PrecomputeStep> pendingSteps;
+    size_t nextStep{0};
+
     bool do_white_balance_{true};
     double bottom_radius;
     float length_unit_in_meters;
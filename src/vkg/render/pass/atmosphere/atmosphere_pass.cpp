@@ -1,5 +1,9 @@
 #include "atmosphere_pass.hpp"
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
 namespace vkg {
+AtmospherePass::AtmospherePass(std::string cacheDir): cacheDir{std::move(cacheDir)} {}
 
 void AtmospherePass::setup(PassBuilder &builder) {
     builder.read(passIn.atmosphere);
@@ -12,36 +16,100 @@ void AtmospherePass::setup(PassBuilder &builder) {
         .irradiance = builder.create<Texture *>("irradiance"),
     };
 }
+auto AtmospherePass::makeModel(RenderContext &ctx, const AtmosphereSetting &setting)
+    -> std::unique_ptr<AtmosphereModel> {
+    return std::make_unique<AtmosphereModel>(
+        ctx.device, setting.sunAngularRadius(), setting.bottomRadius(), setting.topRadius(),
+        setting.lengthUnitInMeters(), setting.sunDirection(), setting.earthCenter());
+}
+
+auto AtmospherePass::setOutputs(Resources &resources) -> void {
+    version++;
+    resources.set(passOut.version, version);
+    resources.set(passOut.atmosphere, model_->atmosphereUBO());
+    resources.set(passOut.sun, model_->sunUBO());
+    resources.set(passOut.transmittance, &model_->transmittanceTex());
+    resources.set(passOut.scattering, &model_->scatteringTex());
+    resources.set(passOut.irradiance, &model_->irradianceTex());
+}
+
+auto AtmospherePass::retire(RenderContext &ctx, std::unique_ptr<AtmosphereModel> model) -> void {
+    if(model) retired.push_back({std::move(model), ctx.numFrames});
+}
+
 void AtmospherePass::compile(RenderContext &ctx, Resources &resources) {
+    // compile runs once the frame recorded `numFrames` frames ago has completed.
+    for(auto &r: retired)
+        r.frames--;
+    std::erase_if(retired, [](const Retired &r) { return r.frames == 0; });
+    if(scratchFrames > 0 && --scratchFrames == 0) model_->releaseScratch();
+
+    record = false;
     auto atmosSetting = resources.get(passIn.atmosphere);
 
     if(!atmosSetting.isEnabled()) return;
 
     if(model_ == nullptr) {
-        model_ = std::make_unique<AtmosphereModel>(
-            ctx.device, atmosSetting.kSunAngularRadius_, atmosSetting.kBottomRadius_, atmosSetting.kTopRadius,
-            atmosSetting.kLengthUnitInMeters_, atmosSetting.sunDirection(), atmosSetting.earthCenter());
+        model_ = makeModel(ctx, atmosSetting);
+        paramsVersion = atmosSetting.version();
 
         auto tStart = std::chrono::high_resolution_clock::now();
 
-        model_->init(ctx.frameIndex);
+        std::string cachePath;
+        if(!cacheDir.empty()) {
+            std::error_code error;
+            std::filesystem::create_directories(cacheDir, error);
+            std::ostringstream name;
+            name << "atmosphere_" << std::hex << std::setw(16) << std::setfill('0') << model_->cacheKey() << ".lut";
+            cachePath = (std::filesystem::path(cacheDir) / name.str()).string();
+        }
+        auto loaded = !cachePath.empty() && model_->load(ctx.frameIndex, cachePath);
+        if(!loaded) {
+            model_->init(ctx.frameIndex);
+            if(!cachePath.empty()) model_->save(ctx.frameIndex, cachePath);
+        }
 
         auto tEnd = std::chrono::high_resolution_clock::now();
         auto tDiff = std::chrono::duration<double, std::milli>(tEnd - tStart).count();
-        debugLog("Generating sky map took ", tDiff, " ms");
-
-        version++;
-        resources.set(passOut.version, version);
-        resources.set(passOut.atmosphere, model_->atmosphereUBO());
-        resources.set(passOut.sun, model_->sunUBO());
-        resources.set(passOut.transmittance, &model_->transmittanceTex());
-        resources.set(passOut.scattering, &model_->scatteringTex());
-        resources.set(passOut.irradiance, &model_->irradianceTex());
+        debugLog(loaded ? "Loading" : "Generating", " sky map took ", tDiff, " ms");
+
+        setOutputs(resources);
+    }
+
+    if(pendingDone) {
+        // the last dispatches were recorded by the previous frame, see `swapFrames`.
+        pendingDone = false;
+        retire(ctx, std::move(model_));
+        model_ = std::move(pending);
+        scratchFrames = ctx.numFrames;
+        swapFrames = ctx.numFrames - 1;
+        setOutputs(resources);
     }
 
+    if(atmosSetting.version() != paramsVersion) {
+        // restart from scratch if the parameters changed again before the precompute completed.
+        retire(ctx, std::move(pending));
+        paramsVersion = atmosSetting.version();
+        pending = makeModel(ctx, atmosSetting);
+        pending->beginPrecompute();
+    }
+    record = pending != nullptr;
+    stepsPerFrame = atmosSetting.precomputeStepsPerFrame();
+    // the precompute continues the dispatches of the previous frame, submitted to another queue.
+    if(record || swapFrames > 0) afterPreviousFrame();
+    if(swapFrames > 0) swapFrames--;
+
     model_->updateSunIntesity(atmosSetting.sunIntensity());
     model_->updateExpsure(atmosSetting.exposure());
     model_->updateSunDirection(atmosSetting.sunDirection());
     model_->updateEarthCenter(atmosSetting.earthCenter());
 }
+
+void AtmospherePass::execute(RenderContext &ctx, Resources &resources) {
+    if(!record) return;
+    auto cb = ctx.cb;
+    ctx.device.begin(cb, "precompute atmosphere");
+    pendingDone = pending->recordPrecompute(cb, stepsPerFrame);
+    ctx.device.end(cb);
+}
 }
\ No newline at end of file
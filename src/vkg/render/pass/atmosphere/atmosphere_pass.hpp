@@ -17,13 +17,50 @@ struct AtmospherePassOut {
   FrameGraphResource<Texture *> irradiance;
 };
 
+/**
+ * Precomputes the LUTs of the atmosphere. The first ones are precomputed, or loaded from
+ * the cache, before the first frame. When the parameters change later on, the LUTs of the
+ * new parameters are precomputed a few dispatches per frame into another model, which
+ * replaces the rendered one once complete.
+ */
 class AtmospherePass: public Pass<AtmospherePassIn, AtmospherePassOut> {
 public:
+  /** the LUTs are cached in `cacheDir` across runs unless it is empty. */
+  explicit AtmospherePass(std::string cacheDir = "");
   void setup(PassBuilder &builder) override;
   void compile(RenderContext &ctx, Resources &resources) override;
+  void execute(RenderContext &ctx, Resources &resources) override;
 
 private:
+  auto makeModel(RenderContext &ctx, const AtmosphereSetting &setting)
+    -> std::unique_ptr<AtmosphereModel>;
+  auto setOutputs(Resources &resources) -> void;
+  /** destroys `model` once the frames in flight no longer use it. */
+  auto retire(RenderContext &ctx, std::unique_ptr<AtmosphereModel> model) -> void;
+
+  std::string cacheDir;
   uint64_t version{0};
   std::unique_ptr<AtmosphereModel> model_;
+  /** `AtmosphereSetting::version` of `model_`, or of `pending` if any. */
+  uint64_t paramsVersion{0};
+
+  /** model of the changed parameters, precomputed over the next frames. */
+  std::unique_ptr<AtmosphereModel> pending;
+  uint32_t stepsPerFrame{1};
+  bool record{false};
+  bool pendingDone{false};
+  /** frames before the intermediate textures of `model_` are released. */
+  uint32_t scratchFrames{0};
+  /**
+   * frames after the swap that wait on their previous frame, so that every frame sampling
+   * the new LUTs before the frame index of the last dispatches is reused runs after them.
+   */
+  uint32_t swapFrames{0};
+
+  struct Retired {
+    std::unique_ptr<AtmosphereModel> model;
+    uint32_t frames;
+  };
+  std::vector<Retired> retired;
 };
 }
@@ -17,7 +17,13 @@ void CamFrustumPass::compile(RenderContext &ctx, Resources &resources) {
             camBuffers[i] = buffer::devStorageBuffer(resources.device, sizeof(Camera::Desc), toString("camBuffer_", i));
     }
     auto *camera = resources.get(passIn.camera);
-    frustums[0] = Frustum{camera->proj() * camera->view()};
+    auto proj = camera->proj();
+    auto &frustum = frustums[0];
+    frustum = Frustum{proj * camera->view()};
+    frustum.eye = camera->location();
+    frustum.pixelScale = glm::abs(proj[1][1]) * float(camera->renderHeight()) / 2;
+    frustum.minPixels = camera->cullMinPixels();
+    frustum.maxDistance = camera->cullMaxDistance();
 
     resources.set(passOut.camFrustum, {frustums});
     resources.set(passOut.camBuffer, camBuffers[ctx.frameIndex]->bufferInfo());
@@ -26,6 +32,10 @@ void CamFrustumPass::execute(RenderContext &ctx, Resources &resources) {
     auto *camera = resources.get(passIn.camera);
     auto desc = camera->desc();
     desc.frame = ctx.frameIndex;
+    // the first frame has no motion.
+    if(hasPrevProjView) desc.prevProjView = prevProjView;
+    prevProjView = desc.unjitteredProjView;
+    hasPrevProjView = true;
     auto bufInfo = camBuffers[ctx.frameIndex]->bufferInfo();
     auto cb = ctx.cb;
     ctx.device.begin(cb, "update camera");
@@ -23,6 +23,8 @@ public:
 private:
     std::vector<Frustum> frustums;
     std::vector<std::unique_ptr<Buffer>> camBuffers;
+    glm::mat4 prevProjView{1};
+    bool hasPrevProjView{false};
     bool init{false};
 };
 }
\ No newline at end of file
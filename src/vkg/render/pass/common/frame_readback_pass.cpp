@@ -0,0 +1,244 @@
+#include "frame_readback_pass.hpp"
+#include "vkg/render/renderer.hpp"
+#include "common/rgb_to_yuv_comp.hpp"
+
+namespace vkg {
+FrameReadbackPass::FrameReadbackPass(Renderer &renderer, FrameReadbackConfig config)
+    : renderer{renderer}, config{std::move(config)} {
+    errorIf(this->config.numSlots == 0, "frame readback needs at least one slot");
+}
+
+FrameReadbackPass::~FrameReadbackPass() {
+    {
+        std::scoped_lock lock{mutex};
+        stop = true;
+    }
+    cv.notify_all();
+    if(worker.joinable()) worker.join();
+}
+
+void FrameReadbackPass::setup(PassBuilder &builder) { builder.read(passIn); }
+
+void FrameReadbackPass::compile(RenderContext &ctx, Resources &resources) {
+    auto yuv = config.format != ReadbackFormat::eColor;
+    if(!init) {
+        init = true;
+
+        if(yuv) {
+            pipeDef = std::make_unique<ReflectedPipelineLayoutDef>(
+                ShaderReflection().add(vk::ShaderStageFlagBits::eCompute, shader::common::rgb_to_yuv_comp_span));
+            pipeDef->init(ctx.device);
+            pipe = ComputePipelineMaker(ctx.device)
+                       .layout(pipeDef->layout())
+                       .shader(Shader{shader::common::rgb_to_yuv_comp_span, local_size_x, local_size_y, 1})
+                       .createUnique();
+            sampler = ctx.device.sampler(vk::SamplerCreateInfo{});
+            descriptorPool =
+                DescriptorPoolMaker().pipelineLayout(*pipeDef, config.numSlots).createUnique(ctx.device);
+        }
+
+        slots.resize(config.numSlots);
+        for(auto i = 0u; i < config.numSlots; ++i) {
+            if(yuv) slots[i].set = pipeDef->createSet(*descriptorPool, 0);
+            freeSlots.push_back(i);
+        }
+        worker = std::thread{[this] { work(); }};
+    }
+    if(swapchainVersion != renderer.swapchain().version()) {
+        drain();
+        allocate(ctx);
+    }
+
+    ++frameCount;
+    {
+        std::scoped_lock lock{mutex};
+        if(freeSlots.empty()) recording = ~0u;
+        else {
+            recording = freeSlots.back();
+            freeSlots.pop_back();
+        }
+    }
+    if(recording == ~0u) {
+        ++dropped;
+        return;
+    }
+
+    auto &slot = slots[recording];
+    auto timeline = renderer.frameTimeline();
+    slot.semaphore = timeline.semaphore;
+    slot.value = timeline.value;
+    slot.frame = {
+        .frame = frameCount - 1,
+        .dropped = dropped,
+        .format = config.format,
+        .colorFormat = renderer.swapchain().format(),
+        .extent = extent,
+        .stride = stride,
+        .data = {slot.buffer->ptr<const std::byte>(), size},
+    };
+    dropped = 0;
+
+    if(yuv) {
+        auto imageIndex = resources.get(passIn.presentImage);
+        auto bufInfo = slot.buffer->bufferInfo();
+        auto imageView = slot.rgba ? slot.rgba->imageView() : renderer.swapchain().imageView(imageIndex);
+        DescriptorSetUpdater()
+            .writeImage(
+                0, 0, vk::DescriptorType::eCombinedImageSampler,
+                {**sampler, imageView, vk::ImageLayout::eShaderReadOnlyOptimal})
+            .writeBuffer(1, 0, vk::DescriptorType::eStorageBuffer, {bufInfo.buffer, bufInfo.offset, bufInfo.size})
+            .update(ctx.device, slot.set);
+    }
+}
+
+void FrameReadbackPass::execute(RenderContext &ctx, Resources &resources) {
+    if(recording == ~0u) return;
+    auto &slot = slots[recording];
+    auto cb = ctx.cb;
+    auto &swapchain = renderer.swapchain();
+    auto image = swapchain.image(resources.get(passIn.presentImage));
+    auto presentLayout = swapchain.presentLayout();
+
+    ctx.device.begin(cb, toString("readback frame ", ctx.frameIndex));
+    if(config.format == ReadbackFormat::eColor) {
+        using vkLayout = vk::ImageLayout;
+        if(presentLayout != vkLayout::eTransferSrcOptimal)
+            image::setLayout(
+                cb, image, presentLayout, vkLayout::eTransferSrcOptimal, {}, vk::AccessFlagBits::eTransferRead);
+        cb.copyImageToBuffer(
+            image, vkLayout::eTransferSrcOptimal, slot.buffer->bufferInfo().buffer,
+            vk::BufferImageCopy{
+                0, 0, 0, {vk::ImageAspectFlagBits::eColor, 0, 0, 1}, {}, {extent.width, extent.height, 1}});
+        slot.buffer->barrier(
+            cb, vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eHostRead, vk::PipelineStageFlagBits::eTransfer,
+            vk::PipelineStageFlagBits::eHost);
+        if(presentLayout != vkLayout::eTransferSrcOptimal)
+            image::setLayout(
+                cb, image, vkLayout::eTransferSrcOptimal, presentLayout, vk::AccessFlagBits::eTransferRead, {});
+    } else if(slot.rgba) {
+        using vkLayout = vk::ImageLayout;
+        if(presentLayout != vkLayout::eTransferSrcOptimal)
+            image::setLayout(
+                cb, image, presentLayout, vkLayout::eTransferSrcOptimal, {}, vk::AccessFlagBits::eTransferRead);
+        image::transitTo(
+            cb, *slot.rgba, vkLayout::eTransferDstOptimal, vk::AccessFlagBits::eTransferWrite,
+            vk::PipelineStageFlagBits::eTransfer);
+        // a blit converts from the swapchain's channel order.
+        std::array<vk::Offset3D, 2> region{
+            vk::Offset3D{}, vk::Offset3D{int32_t(extent.width), int32_t(extent.height), 1}};
+        vk::ImageSubresourceLayers layers{vk::ImageAspectFlagBits::eColor, 0, 0, 1};
+        cb.blitImage(
+            image, vkLayout::eTransferSrcOptimal, slot.rgba->image(), vkLayout::eTransferDstOptimal,
+            vk::ImageBlit{layers, region, layers, region}, vk::Filter::eNearest);
+        if(presentLayout != vkLayout::eTransferSrcOptimal)
+            image::setLayout(
+                cb, image, vkLayout::eTransferSrcOptimal, presentLayout, vk::AccessFlagBits::eTransferRead, {});
+        image::transitTo(
+            cb, *slot.rgba, vkLayout::eShaderReadOnlyOptimal, vk::AccessFlagBits::eShaderRead,
+            vk::PipelineStageFlagBits::eComputeShader);
+        dispatch(slot, cb);
+    } else {
+        image::setLayout(
+            cb, image, presentLayout, vk::ImageLayout::eShaderReadOnlyOptimal, {}, vk::AccessFlagBits::eShaderRead,
+            vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eComputeShader);
+        dispatch(slot, cb);
+        image::setLayout(
+            cb, image, vk::ImageLayout::eShaderReadOnlyOptimal, presentLayout, vk::AccessFlagBits::eShaderRead, {},
+            vk::PipelineStageFlagBits::eComputeShader);
+    }
+    ctx.device.end(cb);
+
+    {
+        std::scoped_lock lock{mutex};
+        pending.push_back(recording);
+    }
+    cv.notify_all();
+}
+
+auto FrameReadbackPass::dispatch(Slot &slot, vk::CommandBuffer cb) -> void {
+    cb.bindPipeline(vk::PipelineBindPoint::eCompute, *pipe);
+    cb.bindDescriptorSets(vk::PipelineBindPoint::eCompute, pipeDef->layout(), 0, slot.set, nullptr);
+    PushConstant pushConstant{
+        .width = extent.width,
+        .height = extent.height,
+        .yStride = stride,
+        .planar = config.format == ReadbackFormat::eI420,
+    };
+    cb.pushConstants<PushConstant>(pipeDef->layout(), vk::ShaderStageFlagBits::eCompute, 0, pushConstant);
+    auto blocksX = (extent.width + 7) / 8, blocksY = (extent.height + 1) / 2;
+    cb.dispatch((blocksX + local_size_x - 1) / local_size_x, (blocksY + local_size_y - 1) / local_size_y, 1);
+    slot.buffer->barrier(
+        cb, vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eHostRead, vk::PipelineStageFlagBits::eComputeShader,
+        vk::PipelineStageFlagBits::eHost);
+}
+
+auto FrameReadbackPass::allocate(RenderContext &ctx) -> void {
+    swapchainVersion = renderer.swapchain().version();
+    extent = renderer.swapchain().imageExtent();
+    if(config.format == ReadbackFormat::eColor) {
+        // swapchain formats are 32 bits per pixel.
+        stride = extent.width * 4;
+        size = vk::DeviceSize(stride) * extent.height;
+    } else {
+        // luma rows are padded to 8 pixels so every plane row is made of whole uints.
+        stride = (extent.width + 7) / 8 * 8;
+        size = vk::DeviceSize(stride) * (extent.height + (extent.height + 1) / 2);
+    }
+    auto &swapchain = renderer.swapchain();
+    auto features = ctx.device.physicalDevice().getFormatProperties(swapchain.format()).optimalTilingFeatures;
+    auto yuv = config.format != ReadbackFormat::eColor;
+    auto sampled = (swapchain.usage() & vk::ImageUsageFlagBits::eSampled) &&
+                   (features & vk::FormatFeatureFlagBits::eSampledImage);
+    auto copied = yuv && !sampled;
+    errorIf(
+        (!yuv || copied) && !(swapchain.usage() & vk::ImageUsageFlagBits::eTransferSrc),
+        "swapchain images can't be read back: the surface doesn't support transfer source usage");
+    errorIf(
+        copied && !(features & vk::FormatFeatureFlagBits::eBlitSrc),
+        "swapchain images can't be read back as YUV: format ",
+        vk::to_string(swapchain.format()), " can't be sampled nor blitted");
+    for(auto i = 0u; i < slots.size(); ++i) {
+        slots[i].buffer = buffer::readbackBuffer(
+            ctx.device, vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eStorageBuffer, size,
+            toString(name, "_", i));
+        slots[i].rgba.reset();
+        if(copied)
+            slots[i].rgba = image::make2DTex(
+                toString(name, "_rgba_", i), ctx.device, extent.width, extent.height,
+                vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst);
+    }
+}
+
+auto FrameReadbackPass::drain() -> void {
+    std::unique_lock lock{mutex};
+    cv.wait(lock, [&] { return freeSlots.size() == slots.size(); });
+}
+
+auto FrameReadbackPass::work() -> void {
+    auto dev = renderer.device().vkDevice();
+    // wake up regularly so a frame that is never submitted can't block shutting down.
+    constexpr uint64_t timeout = 100'000'000;
+    while(true) {
+        uint32_t idx;
+        {
+            std::unique_lock lock{mutex};
+            cv.wait(lock, [&] { return stop || !pending.empty(); });
+            if(stop) return;
+            idx = pending.front();
+            pending.pop_front();
+        }
+        auto &slot = slots[idx];
+        vk::SemaphoreWaitInfo waitInfo{{}, 1, &slot.semaphore, &slot.value};
+        while(dev.waitSemaphores(waitInfo, timeout) == vk::Result::eTimeout) {
+            std::scoped_lock lock{mutex};
+            if(stop) return;
+        }
+        config.callback(slot.frame);
+        {
+            std::scoped_lock lock{mutex};
+            freeSlots.push_back(idx);
+        }
+        cv.notify_all();
+    }
+}
+}
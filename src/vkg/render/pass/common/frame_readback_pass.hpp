@@ -0,0 +1,117 @@
+#pragma once
+#include "vkg/base/base.hpp"
+#include "vkg/render/graph/frame_graph.hpp"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace vkg {
+enum class ReadbackFormat : uint32_t {
+    /** the presented image copied as is, in the swapchain's format. */
+    eColor,
+    /** Y plane followed by an interleaved UV plane at half resolution. */
+    eNV12,
+    /** Y, U and V planes, the chroma planes at half resolution. */
+    eI420
+};
+
+/**
+ * A captured frame. `data` is only valid during the callback. For the YUV formats the luma rows are
+ * `stride` bytes apart and each chroma row of the I420 planes is `stride / 2` bytes.
+ */
+struct ReadbackFrame {
+    /** number of the frame since the readback started. */
+    uint64_t frame{0};
+    /** frames skipped since the last delivered frame because every slot was still in use. */
+    uint64_t dropped{0};
+    ReadbackFormat format{ReadbackFormat::eColor};
+    vk::Format colorFormat{vk::Format::eUndefined};
+    vk::Extent2D extent;
+    uint32_t stride{0};
+    std::span<const std::byte> data;
+};
+
+using ReadbackCallback = std::function<void(const ReadbackFrame &frame)>;
+
+struct FrameReadbackConfig {
+    ReadbackFormat format{ReadbackFormat::eColor};
+    /** number of readback buffers in flight. A frame is dropped when none of them is free. */
+    uint32_t numSlots{3};
+    /** called on the readback thread once the frame finished rendering. */
+    ReadbackCallback callback;
+};
+
+struct FrameReadbackPassIn {
+    FrameGraphResource<uint32_t> presentImage;
+};
+struct FrameReadbackPassOut {};
+
+class Renderer;
+/**
+ * Copies the presented image into a ring of readback buffers after `RendererPresentPass`. A
+ * dedicated thread waits for the frame's timeline value and hands the buffer to the callback, so
+ * neither the render queue nor the render thread ever waits for a capture.
+ */
+class FrameReadbackPass: public Pass<FrameReadbackPassIn, FrameReadbackPassOut> {
+public:
+    FrameReadbackPass(Renderer &renderer, FrameReadbackConfig config);
+    ~FrameReadbackPass() override;
+
+    void setup(PassBuilder &builder) override;
+    void compile(RenderContext &ctx, Resources &resources) override;
+    void execute(RenderContext &ctx, Resources &resources) override;
+
+private:
+    auto allocate(RenderContext &ctx) -> void;
+    auto drain() -> void;
+    auto work() -> void;
+
+    Renderer &renderer;
+    FrameReadbackConfig config;
+
+    struct PushConstant {
+        uint32_t width;
+        uint32_t height;
+        uint32_t yStride;
+        uint32_t planar;
+    };
+    /** reflected from rgb_to_yuv.comp: set 0 holds the image and the yuv buffer. */
+    std::unique_ptr<ReflectedPipelineLayoutDef> pipeDef;
+
+    vk::UniquePipeline pipe;
+    std::shared_ptr<vk::UniqueSampler> sampler;
+    vk::UniqueDescriptorPool descriptorPool;
+    const uint32_t local_size_x = 8, local_size_y = 8;
+
+    struct Slot {
+        std::unique_ptr<Buffer> buffer;
+        /**
+         * R8G8B8A8 copy of the presented image for the YUV formats when the swapchain images can't be
+         * sampled, either because of their usage or their format's features.
+         */
+        std::unique_ptr<Texture> rgba;
+        vk::DescriptorSet set;
+        ReadbackFrame frame;
+        vk::Semaphore semaphore;
+        uint64_t value{0};
+    };
+    std::vector<Slot> slots;
+    auto dispatch(Slot &slot, vk::CommandBuffer cb) -> void;
+    /** slot recorded this frame, ~0u when the frame is dropped. */
+    uint32_t recording{~0u};
+    vk::Extent2D extent;
+    uint64_t swapchainVersion{0};
+    uint32_t stride{0};
+    vk::DeviceSize size{0};
+    uint64_t frameCount{0}, dropped{0};
+    bool init{false};
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<uint32_t> pending;
+    std::vector<uint32_t> freeSlots;
+    bool stop{false};
+    std::thread worker;
+};
+}
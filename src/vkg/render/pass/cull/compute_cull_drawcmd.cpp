@@ -1,15 +1,29 @@
 #include "compute_cull_drawcmd.hpp"
 
+#include <algorithm>
 #include <utility>
+#include "hiz_pass.hpp"
 #include "common/cull_draw_group_comp.hpp"
+#include "common/cull_draw_group_hiz_comp.hpp"
+#include "common/cull_draw_group_retest_comp.hpp"
+#include "common/cull_draw_merge_comp.hpp"
+#include "common/cull_draw_scatter_comp.hpp"
 
 namespace vkg {
-ComputeCullDrawCMD::ComputeCullDrawCMD(std::set<ShadeModel> allowedShadeModel)
-    : allowedShadeModel(std::move(allowedShadeModel)) {}
+ComputeCullDrawCMD::ComputeCullDrawCMD(
+    std::set<ShadeModel> allowedShadeModel, DepthPyramid *pyramid, CullStats *stats)
+    : allowedShadeModel(std::move(allowedShadeModel)), pyramid{pyramid}, stats{stats} {}
 void ComputeCullDrawCMD::setup(PassBuilder &builder) {
     builder.read(passIn);
+    builder.read(passIn.matrices, AccessType::eComputeRead);
     passOut = {
         .drawCMDs = builder.create<DrawInfos>("drawCMDs"),
+        .cmdBuf = builder.create<BufferInfo>("cmdBuf", AccessType::eComputeStorageWrite),
+        .countBuf = builder.create<BufferInfo>("countBuf", AccessType::eComputeStorageWrite),
+        .instanceIds = builder.create<BufferInfo>("instanceIds", AccessType::eComputeStorageWrite),
+        .viewMasks = builder.create<BufferInfo>("viewMasks", AccessType::eComputeStorageWrite),
+        .rejected = builder.create<BufferInfo>("rejected", AccessType::eComputeStorageWrite),
+        .pyramid = builder.create<Texture *>("pyramid", AccessType::eComputeStorageRead),
     };
 }
 void ComputeCullDrawCMD::compile(RenderContext &ctx, Resources &resources) {
@@ -20,12 +34,33 @@ void ComputeCullDrawCMD::compile(RenderContext &ctx, Resources &resources) {
         init = true;
 
         setDef.init(ctx.device);
+        occlusionSetDef.init(ctx.device);
         pipeDef.transf(setDef);
+        pipeDef.occlusion(occlusionSetDef);
         pipeDef.init(ctx.device);
         pipe = ComputePipelineMaker(ctx.device)
                    .layout(pipeDef.layout())
                    .shader(Shader{shader::common::cull_draw_group_comp_span, local_size, 1, 1})
                    .createUnique();
+        if(pyramid) {
+            hizPipe = ComputePipelineMaker(ctx.device)
+                          .layout(pipeDef.layout())
+                          .shader(Shader{shader::common::cull_draw_group_hiz_comp_span, local_size, 1, 1})
+                          .createUnique();
+            retestPipe = ComputePipelineMaker(ctx.device)
+                             .layout(pipeDef.layout())
+                             .shader(Shader{shader::common::cull_draw_group_retest_comp_span, local_size, 1, 1})
+                             .createUnique();
+            pyramid->frames.resize(ctx.numFrames);
+        }
+        mergePipe = ComputePipelineMaker(ctx.device)
+                        .layout(pipeDef.layout())
+                        .shader(Shader{shader::common::cull_draw_merge_comp_span, merge_local_size, 1, 1})
+                        .createUnique();
+        scatterPipe = ComputePipelineMaker(ctx.device)
+                          .layout(pipeDef.layout())
+                          .shader(Shader{shader::common::cull_draw_scatter_comp_span, local_size, 1, 1})
+                          .createUnique();
 
         descriptorPool = DescriptorPoolMaker().pipelineLayout(pipeDef, ctx.numFrames).createUnique(ctx.device);
 
@@ -47,6 +82,9 @@ void ComputeCullDrawCMD::compile(RenderContext &ctx, Resources &resources) {
             buffer::uploadVec(ctx.frameIndex, *allowedShadeModelBuf, allowedGroup_);
         }
 
+        // one bucket of 3 uints per frustum and primitive.
+        bucketStride = sceneConfig.maxNumPrimitives;
+
         for(int i = 0; i < ctx.numFrames; ++i) {
             auto &frame = frames[i];
             frame.set = setDef.createSet(*descriptorPool);
@@ -58,9 +96,40 @@ void ComputeCullDrawCMD::compile(RenderContext &ctx, Resources &resources) {
                 toString(name, "_drawCMD_", i));
             frame.cmdOffsetPerShadeModelBuffer = buffer::devStorageBuffer(
                 resources.device, sizeof(uint32_t) * numShadeModels, toString(name, "_drawCMDOffset_", i));
-            frame.countOfShadeModelBuffer = buffer::devIndirectStorageBuffer(
-                resources.device, sizeof(uint32_t) * numShadeModels * numFrustums,
-                toString(name, "_drawGroupCount_", i));
+            // draw counts followed by occluded counts, copied out for the stats.
+            using vkBU = vk::BufferUsageFlagBits;
+            frame.countOfShadeModelBuffer = buffer::devBuffer(
+                resources.device, vkBU::eIndirectBuffer | vkBU::eStorageBuffer | vkBU::eTransferSrc,
+                sizeof(uint32_t) * numShadeModels * numFrustums * 2, toString(name, "_drawGroupCount_", i));
+            frame.instanceIds = buffer::devStorageBuffer(
+                resources.device, sizeof(uint32_t) * numDrawCMDsPerFrustum * numFrustums,
+                toString(name, "_instanceIds_", i));
+            frame.instanceCounts = buffer::devStorageBuffer(
+                resources.device, sizeof(uint32_t) * numFrustums, toString(name, "_instanceCounts_", i));
+            frame.viewMasks = buffer::devStorageBuffer(
+                resources.device, sizeof(uint32_t) * numDrawCMDsPerFrustum * numFrustums,
+                toString(name, "_viewMasks_", i));
+            // cleared before the first cull of the frame, afterwards the merge resets the buckets it emitted.
+            frame.buckets = buffer::devStorageBuffer(
+                resources.device, sizeof(uint32_t) * 3 * bucketStride * numFrustums, toString(name, "_buckets_", i));
+            // dispatch command and count of the header, followed by the bucket and its offset.
+            frame.activeBuckets = buffer::devIndirectStorageBuffer(
+                resources.device, sizeof(uint32_t) * 4 + sizeof(glm::uvec2) * numDrawCMDsPerFrustum * numFrustums,
+                toString(name, "_activeBuckets_", i));
+            frame.visibleSlots = buffer::devStorageBuffer(
+                resources.device, sizeof(uint32_t) * numDrawCMDsPerFrustum * numFrustums,
+                toString(name, "_visibleSlots_", i));
+            if(pyramid) {
+                frame.occlusionSet = occlusionSetDef.createSet(*descriptorPool);
+                // the re-test clears the flags it reads.
+                frame.rejected = buffer::devStorageBuffer(
+                    resources.device, sizeof(uint32_t) * numDrawCMDsPerFrustum, toString(name, "_rejected_", i));
+                buffer::uploadVec(i, *frame.rejected, std::vector<uint32_t>(numDrawCMDsPerFrustum, 0));
+            }
+            if(stats)
+                frame.statsBuffer = buffer::readbackBuffer(
+                    resources.device, vk::BufferUsageFlagBits::eTransferDst, sizeof(uint32_t) * numShadeModels * 2,
+                    toString(name, "_stats_", i));
         }
     }
     errorIf(frustums.size() != numFrustums, "number of frustums changed!");
@@ -76,8 +145,37 @@ void ComputeCullDrawCMD::compile(RenderContext &ctx, Resources &resources) {
     setDef.cmdOffsetPerGroup(frame.cmdOffsetPerShadeModelBuffer->bufferInfo());
     setDef.drawCMDCount(frame.countOfShadeModelBuffer->bufferInfo());
     setDef.allowedShadeModel(allowedShadeModelBuf->bufferInfo());
+    setDef.buckets(frame.buckets->bufferInfo());
+    setDef.activeBuckets(frame.activeBuckets->bufferInfo());
+    setDef.visibleSlots(frame.visibleSlots->bufferInfo());
+    setDef.instanceIds(frame.instanceIds->bufferInfo());
+    setDef.instanceCounts(frame.instanceCounts->bufferInfo());
+    setDef.viewMasks(frame.viewMasks->bufferInfo());
     setDef.update(frame.set);
 
+    if(pyramid) {
+        auto &level = pyramid->frames[ctx.frameIndex];
+        if(pyramid->requestedExtent.width > 0 && pyramid->requestedExtent != level.extent)
+            pyramid->resize(ctx.device, ctx.frameIndex);
+        useHiZ = level.valid;
+        pyramidViewProj = level.viewProj;
+        if(level.texture && frame.pyramidVersion != level.version) {
+            frame.pyramidVersion = level.version;
+            occlusionSetDef.pyramid(*level.texture, vk::ImageLayout::eGeneral);
+            occlusionSetDef.rejected(frame.rejected->bufferInfo());
+            occlusionSetDef.update(frame.occlusionSet);
+        }
+        resources.set(passOut.rejected, frame.rejected->bufferInfo());
+        if(level.texture) resources.set(passOut.pyramid, level.texture.get());
+    }
+
+    // the frame this resource was last used by has finished.
+    if(stats && frame.statsWritten) {
+        auto *counts = frame.statsBuffer->ptr<uint32_t>();
+        stats->drawn.assign(counts, counts + numShadeModels);
+        stats->occluded.assign(counts + numShadeModels, counts + numShadeModels * 2);
+    }
+
     {
         uint32_t offset = 0;
         for(int i = 0; i < numShadeModels; ++i) {
@@ -88,6 +186,8 @@ void ComputeCullDrawCMD::compile(RenderContext &ctx, Resources &resources) {
 
     DrawInfos drawInfos;
     drawInfos.cmdsPerShadeModel.resize(numFrustums);
+    drawInfos.instanceIds = frame.instanceIds->bufferInfo();
+    drawInfos.viewMasks = frame.viewMasks->bufferInfo();
 
     auto drawCMDBufInfo = frame.drawCMD->bufferInfo();
     auto countOfGroupBufInfo = frame.countOfShadeModelBuffer->bufferInfo();
@@ -106,6 +206,10 @@ void ComputeCullDrawCMD::compile(RenderContext &ctx, Resources &resources) {
         }
     }
     resources.set(passOut.drawCMDs, drawInfos);
+    resources.set(passOut.cmdBuf, drawCMDBufInfo);
+    resources.set(passOut.countBuf, countOfGroupBufInfo);
+    resources.set(passOut.instanceIds, drawInfos.instanceIds);
+    resources.set(passOut.viewMasks, drawInfos.viewMasks);
 }
 void ComputeCullDrawCMD::execute(RenderContext &ctx, Resources &resources) {
     auto totalMeshInstances = resources.get(passIn.meshInstancesCount);
@@ -116,6 +220,14 @@ void ComputeCullDrawCMD::execute(RenderContext &ctx, Resources &resources) {
     auto cb = ctx.cb;
 
     ctx.device.begin(cb, "update frustums");
+    // the merge scratch is shared with the cull of the last frame.
+    cb.pipelineBarrier(
+        vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eDrawIndirect,
+        vk::PipelineStageFlagBits::eTransfer | vk::PipelineStageFlagBits::eComputeShader, {},
+        vk::MemoryBarrier{
+            vk::AccessFlagBits::eShaderWrite,
+            vk::AccessFlagBits::eTransferWrite | vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite},
+        nullptr, nullptr);
 
     auto frustums = resources.get(passIn.frustums);
     auto bufInfo = frame.frustumsBuf->bufferInfo();
@@ -127,24 +239,38 @@ void ComputeCullDrawCMD::execute(RenderContext &ctx, Resources &resources) {
         cmdOffsetOfShadeModelInFrustum.data());
 
     bufInfo = frame.countOfShadeModelBuffer->bufferInfo();
-    cb.fillBuffer(bufInfo.buffer, bufInfo.offset, sizeof(uint32_t) * numFrustums * numShadeModels, 0u);
+    cb.fillBuffer(bufInfo.buffer, bufInfo.offset, sizeof(uint32_t) * numFrustums * numShadeModels * 2, 0u);
+
+    auto totalDispatch = totalMeshInstances * numFrustums;
+    bufInfo = frame.instanceCounts->bufferInfo();
+    cb.fillBuffer(bufInfo.buffer, bufInfo.offset, sizeof(uint32_t) * numFrustums, 0u);
+    if(std::any_of(frustums.begin(), frustums.end(), [](auto &f) { return f.mergeInto != ~0u; })) {
+        bufInfo = frame.viewMasks->bufferInfo();
+        cb.fillBuffer(bufInfo.buffer, bufInfo.offset, sizeof(uint32_t) * totalDispatch, 0u);
+    }
+    bufInfo = frame.visibleSlots->bufferInfo();
+    cb.fillBuffer(bufInfo.buffer, bufInfo.offset, sizeof(uint32_t) * totalDispatch, ~0u);
+    std::array<uint32_t, 4> mergeHeader{0, 1, 1, 0};
+    bufInfo = frame.activeBuckets->bufferInfo();
+    cb.updateBuffer(bufInfo.buffer, bufInfo.offset, sizeof(mergeHeader), mergeHeader.data());
+    // afterwards the merge resets the buckets it emitted.
+    if(!frame.bucketsCleared) {
+        frame.bucketsCleared = true;
+        bufInfo = frame.buckets->bufferInfo();
+        cb.fillBuffer(bufInfo.buffer, bufInfo.offset, bufInfo.size, 0u);
+    }
 
     cb.pipelineBarrier(
         vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader, {},
-        vk::MemoryBarrier{vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eShaderWrite}, nullptr, nullptr);
+        vk::MemoryBarrier{
+            vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite},
+        nullptr, nullptr);
     ctx.device.end(cb);
 
-    auto totalDispatch = totalMeshInstances * numFrustums;
-    auto maxCG = ctx.device.limits().maxComputeWorkGroupCount;
-    auto totalGroup = uint32_t(std::ceil(totalDispatch / double(local_size)));
-    auto dx = std::min(totalGroup, maxCG[0]);
-    totalGroup = uint32_t(totalGroup / double(dx));
-    auto dy = std::min(std::max(totalGroup, 1u), maxCG[1]);
-    totalGroup = uint32_t(totalGroup / double(dy));
-    auto dz = std::min(std::max(totalGroup, 1u), maxCG[2]);
+    auto [dx, dy, dz] = groupCount(ctx.device, totalDispatch);
 
     ctx.device.begin(cb, name + " compute cull drawGroup");
-    cb.bindPipeline(vk::PipelineBindPoint::eCompute, *pipe);
+    cb.bindPipeline(vk::PipelineBindPoint::eCompute, useHiZ ? *hizPipe : *pipe);
     cb.bindDescriptorSets(vk::PipelineBindPoint::eCompute, pipeDef.layout(), pipeDef.transf.set(), frame.set, nullptr);
     pushConstant = {
         .totalFrustums = numFrustums,
@@ -152,14 +278,125 @@ void ComputeCullDrawCMD::execute(RenderContext &ctx, Resources &resources) {
         .cmdFrustumStride = numDrawCMDsPerFrustum,
         .groupStride = numShadeModels,
         .frame = ctx.frameIndex,
+        .bucketStride = bucketStride,
     };
+    if(useHiZ) {
+        cb.bindDescriptorSets(
+            vk::PipelineBindPoint::eCompute, pipeDef.layout(), pipeDef.occlusion.set(), frame.occlusionSet, nullptr);
+        auto &level = pyramid->frames[ctx.frameIndex];
+        pushConstant.pyramidLevels = level.levels;
+        pushConstant.pyramidSize = {level.extent.width, level.extent.height};
+        pushConstant.pyramidViewProj = pyramidViewProj;
+    }
     cb.pushConstants<PushConstant>(pipeDef.layout(), vk::ShaderStageFlagBits::eCompute, 0, pushConstant);
     cb.dispatch(dx, dy, dz);
+    ctx.device.end(cb);
 
+    ctx.device.begin(cb, name + " merge instanced draws");
+    auto computeBarrier = vk::MemoryBarrier{
+        vk::AccessFlagBits::eShaderWrite,
+        vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite | vk::AccessFlagBits::eIndirectCommandRead};
     cb.pipelineBarrier(
-        vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eDrawIndirect, {},
-        vk::MemoryBarrier{vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eIndirectCommandRead}, nullptr,
-        nullptr);
+        vk::PipelineStageFlagBits::eComputeShader,
+        vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eDrawIndirect, {}, computeBarrier,
+        nullptr, nullptr);
+    cb.bindPipeline(vk::PipelineBindPoint::eCompute, *mergePipe);
+    cb.dispatchIndirect(frame.activeBuckets->bufferInfo().buffer, frame.activeBuckets->bufferInfo().offset);
+    cb.pipelineBarrier(
+        vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader, {}, computeBarrier,
+        nullptr, nullptr);
+    cb.bindPipeline(vk::PipelineBindPoint::eCompute, *scatterPipe);
+    cb.dispatch(dx, dy, dz);
+
+    // with a pyramid the counts are final after the re-test.
+    if(stats && !pyramid) copyStats(cb, frame);
     ctx.device.end(cb);
 }
-}
\ No newline at end of file
+
+auto ComputeCullDrawCMD::executeRetest(RenderContext &ctx, uint32_t totalMeshInstances) -> void {
+    if(totalMeshInstances == 0) return;
+    auto &frame = frames[ctx.frameIndex];
+    auto cb = ctx.cb;
+    if(useHiZ) {
+        ctx.device.begin(cb, name + " retest occluded instances");
+        // the merge scratch was last used by the first phase.
+        cb.pipelineBarrier(
+            vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eDrawIndirect,
+            vk::PipelineStageFlagBits::eTransfer, {},
+            vk::MemoryBarrier{vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eTransferWrite}, nullptr, nullptr);
+        auto bufInfo = frame.visibleSlots->bufferInfo();
+        cb.fillBuffer(bufInfo.buffer, bufInfo.offset, sizeof(uint32_t) * totalMeshInstances * numFrustums, ~0u);
+        std::array<uint32_t, 4> mergeHeader{0, 1, 1, 0};
+        bufInfo = frame.activeBuckets->bufferInfo();
+        cb.updateBuffer(bufInfo.buffer, bufInfo.offset, sizeof(mergeHeader), mergeHeader.data());
+        cb.pipelineBarrier(
+            vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader, {},
+            vk::MemoryBarrier{
+                vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite},
+            nullptr, nullptr);
+
+        // only the first frustum is tested against the pyramid.
+        auto [dx, dy, dz] = groupCount(ctx.device, totalMeshInstances);
+        auto &level = pyramid->frames[ctx.frameIndex];
+        cb.bindPipeline(vk::PipelineBindPoint::eCompute, *retestPipe);
+        cb.bindDescriptorSets(
+            vk::PipelineBindPoint::eCompute, pipeDef.layout(), pipeDef.transf.set(), frame.set, nullptr);
+        cb.bindDescriptorSets(
+            vk::PipelineBindPoint::eCompute, pipeDef.layout(), pipeDef.occlusion.set(), frame.occlusionSet, nullptr);
+        // the rest of the push constant is the first phase's.
+        pushConstant.pyramidLevels = level.valid ? level.levels : 0;
+        pushConstant.pyramidSize = {level.extent.width, level.extent.height};
+        pushConstant.pyramidViewProj = level.viewProj;
+        cb.pushConstants<PushConstant>(pipeDef.layout(), vk::ShaderStageFlagBits::eCompute, 0, pushConstant);
+        cb.dispatch(dx, dy, dz);
+
+        auto computeBarrier = vk::MemoryBarrier{
+            vk::AccessFlagBits::eShaderWrite,
+            vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite |
+                vk::AccessFlagBits::eIndirectCommandRead};
+        cb.pipelineBarrier(
+            vk::PipelineStageFlagBits::eComputeShader,
+            vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eDrawIndirect, {}, computeBarrier,
+            nullptr, nullptr);
+        cb.bindPipeline(vk::PipelineBindPoint::eCompute, *mergePipe);
+        cb.dispatchIndirect(frame.activeBuckets->bufferInfo().buffer, frame.activeBuckets->bufferInfo().offset);
+        cb.pipelineBarrier(
+            vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader, {}, computeBarrier,
+            nullptr, nullptr);
+        cb.bindPipeline(vk::PipelineBindPoint::eCompute, *scatterPipe);
+        cb.dispatch(dx, dy, dz);
+        ctx.device.end(cb);
+    }
+    if(stats) copyStats(cb, frame);
+}
+
+auto ComputeCullDrawCMD::copyStats(vk::CommandBuffer cb, FrameResource &frame) -> void {
+    cb.pipelineBarrier(
+        vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eTransfer, {},
+        vk::MemoryBarrier{vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eTransferRead}, nullptr, nullptr);
+    auto bufInfo = frame.countOfShadeModelBuffer->bufferInfo();
+    auto statsInfo = frame.statsBuffer->bufferInfo();
+    std::array<vk::BufferCopy, 2> regions{
+        vk::BufferCopy{bufInfo.offset, statsInfo.offset, sizeof(uint32_t) * numShadeModels},
+        vk::BufferCopy{
+            bufInfo.offset + sizeof(uint32_t) * numFrustums * numShadeModels,
+            statsInfo.offset + sizeof(uint32_t) * numShadeModels, sizeof(uint32_t) * numShadeModels},
+    };
+    cb.copyBuffer(bufInfo.buffer, statsInfo.buffer, regions);
+    frame.statsBuffer->barrier(
+        cb, vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eHostRead, vk::PipelineStageFlagBits::eTransfer,
+        vk::PipelineStageFlagBits::eHost);
+    frame.statsWritten = true;
+}
+
+auto ComputeCullDrawCMD::groupCount(Device &device, uint32_t totalDispatch) const -> std::array<uint32_t, 3> {
+    auto maxCG = device.limits().maxComputeWorkGroupCount;
+    auto totalGroup = uint32_t(std::ceil(totalDispatch / double(local_size)));
+    auto dx = std::min(totalGroup, maxCG[0]);
+    totalGroup = uint32_t(totalGroup / double(dx));
+    auto dy = std::min(std::max(totalGroup, 1u), maxCG[1]);
+    totalGroup = uint32_t(totalGroup / double(dy));
+    auto dz = std::min(std::max(totalGroup, 1u), maxCG[2]);
+    return {dx, dy, dz};
+}
+}
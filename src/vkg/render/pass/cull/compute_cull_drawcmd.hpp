@@ -14,7 +14,25 @@ struct DrawInfo {
 };
 struct DrawInfos {
     std::vector<std::vector<DrawInfo>> cmdsPerShadeModel;
+    /**
+     * mesh instance ids, indexed by `gl_InstanceIndex`. Instances sharing a primitive are drawn by a
+     * single command whose `firstInstance` points to their ids.
+     */
+    BufferInfo instanceIds;
+    /**
+     * per frustum others are merged into (see `Frustum::mergeInto`) and mesh instance, a bit for every
+     * merged frustum seeing the instance. Indexed by `frustum * meshInstancesCount + instance id`.
+     */
+    BufferInfo viewMasks;
 };
+/** counts of the first frustum per shade model, as counted by the cull a few frames ago. */
+struct CullStats {
+    /** indirect draws, each drawing every visible instance of a primitive. */
+    std::vector<uint32_t> drawn;
+    /** passed the frustum test but still occluded after the re-test against the frame's depth pyramid. */
+    std::vector<uint32_t> occluded;
+};
+struct DepthPyramid;
 struct ComputeCullDrawCMDPassIn {
     FrameGraphResource<std::span<Frustum>> frustums;
     FrameGraphResource<BufferInfo> meshInstances;
@@ -26,15 +44,39 @@ struct ComputeCullDrawCMDPassIn {
 };
 struct ComputeCullDrawCMDPassOut {
     FrameGraphResource<DrawInfos> drawCMDs;
+    /**
+     * buffers behind `drawCMDs`. Passes drawing with them declare how they read them, so that the frame
+     * graph records the barriers after the cull.
+     */
+    FrameGraphResource<BufferInfo> cmdBuf, countBuf, instanceIds, viewMasks;
+    /** per instance, 1 if the depth pyramid rejected it. Only set with a pyramid. */
+    FrameGraphResource<BufferInfo> rejected;
+    /** the frame's depth pyramid the cull tested against, only set with a pyramid. */
+    FrameGraphResource<Texture *> pyramid;
 };
 class ComputeCullDrawCMD: public Pass<ComputeCullDrawCMDPassIn, ComputeCullDrawCMDPassOut> {
 public:
-    explicit ComputeCullDrawCMD(std::set<ShadeModel> allowedShadeModel);
+    /**
+     * @param pyramid if not null, instances in the first frustum are also tested against the depth
+     * pyramid an earlier frame built. A `CullRetestPass` then draws those of the rejected that this
+     * frame's pyramid doesn't occlude.
+     * @param stats if not null, receives the per shade model counts of the first frustum.
+     */
+    explicit ComputeCullDrawCMD(
+        std::set<ShadeModel> allowedShadeModel, DepthPyramid *pyramid = nullptr, CullStats *stats = nullptr);
     void setup(PassBuilder &builder) override;
     void compile(RenderContext &ctx, Resources &resources) override;
     void execute(RenderContext &ctx, Resources &resources) override;
 
 private:
+    friend class CullRetestPass;
+
+    struct FrameResource;
+    /** appends the draws of the rejected instances that the frame's pyramid doesn't occlude. */
+    auto executeRetest(RenderContext &ctx, uint32_t totalMeshInstances) -> void;
+    auto copyStats(vk::CommandBuffer cb, FrameResource &frame) -> void;
+    auto groupCount(Device &device, uint32_t totalDispatch) const -> std::array<uint32_t, 3>;
+
     struct ComputeTransfSetDef: DescriptorSetDef {
         __buffer__(frustums, vk::ShaderStageFlagBits::eCompute);
         __buffer__(meshInstances, vk::ShaderStageFlagBits::eCompute);
@@ -44,6 +86,12 @@ private:
         __buffer__(cmdOffsetPerGroup, vk::ShaderStageFlagBits::eCompute);
         __buffer__(drawCMDCount, vk::ShaderStageFlagBits::eCompute);
         __buffer__(allowedShadeModel, vk::ShaderStageFlagBits::eCompute);
+        __buffer__(buckets, vk::ShaderStageFlagBits::eCompute);
+        __buffer__(activeBuckets, vk::ShaderStageFlagBits::eCompute);
+        __buffer__(visibleSlots, vk::ShaderStageFlagBits::eCompute);
+        __buffer__(instanceIds, vk::ShaderStageFlagBits::eCompute);
+        __buffer__(instanceCounts, vk::ShaderStageFlagBits::eCompute);
+        __buffer__(viewMasks, vk::ShaderStageFlagBits::eCompute);
     } setDef;
     struct PushConstant {
         uint32_t totalFrustums;
@@ -51,19 +99,37 @@ private:
         uint32_t cmdFrustumStride;
         uint32_t groupStride;
         uint32_t frame;
+        uint32_t pyramidLevels;
+        glm::uvec2 pyramidSize;
+        glm::mat4 pyramidViewProj;
+        uint32_t bucketStride;
     } pushConstant{};
+    struct OcclusionSetDef: DescriptorSetDef {
+        __sampler2D__(pyramid, vk::ShaderStageFlagBits::eCompute);
+        __buffer__(rejected, vk::ShaderStageFlagBits::eCompute);
+    } occlusionSetDef;
     struct ComputeTransfPipeDef: PipelineLayoutDef {
         __push_constant__(pushConst, vk::ShaderStageFlagBits::eCompute, PushConstant);
         __set__(transf, ComputeTransfSetDef);
+        __set__(occlusion, OcclusionSetDef);
     } pipeDef;
 
-    vk::UniquePipeline pipe;
+    vk::UniquePipeline pipe, hizPipe, retestPipe, mergePipe, scatterPipe;
     const uint32_t local_size = 64;
+    /** matches `cullMergeGroupSize` in cull_draw_resources.h. */
+    const uint32_t merge_local_size = 64;
 
     vk::UniqueDescriptorPool descriptorPool;
 
     std::set<ShadeModel> allowedShadeModel;
     std::unique_ptr<Buffer> allowedShadeModelBuf;
+    uint32_t bucketStride{0};
+
+    DepthPyramid *pyramid;
+    bool useHiZ{false};
+    /** view projection of the pyramid tested against, taken before the frame's `HiZPass` rebuilds it. */
+    glm::mat4 pyramidViewProj{1};
+    CullStats *stats;
 
     struct FrameResource {
         vk::DescriptorSet set;
@@ -72,6 +138,18 @@ private:
         std::unique_ptr<Buffer> drawCMD;
         std::unique_ptr<Buffer> cmdOffsetPerShadeModelBuffer;
         std::unique_ptr<Buffer> countOfShadeModelBuffer;
+        std::unique_ptr<Buffer> instanceIds;
+        std::unique_ptr<Buffer> instanceCounts;
+        std::unique_ptr<Buffer> viewMasks;
+        /** scratch of the merge, per frame as the frames in flight cull on different queues. */
+        std::unique_ptr<Buffer> buckets, activeBuckets, visibleSlots;
+        bool bucketsCleared{false};
+
+        vk::DescriptorSet occlusionSet;
+        uint64_t pyramidVersion{0};
+        std::unique_ptr<Buffer> rejected;
+        std::unique_ptr<Buffer> statsBuffer;
+        bool statsWritten{false};
     };
 
     std::vector<FrameResource> frames;
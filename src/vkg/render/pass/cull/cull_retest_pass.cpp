@@ -0,0 +1,22 @@
+#include "cull_retest_pass.hpp"
+
+namespace vkg {
+CullRetestPass::CullRetestPass(ComputeCullDrawCMD &cull): cull{cull} {}
+
+void CullRetestPass::setup(PassBuilder &builder) {
+    builder.read(passIn);
+    builder.read(passIn.matrices, AccessType::eComputeRead);
+    builder.read(passIn.pyramid, AccessType::eComputeStorageRead);
+    passOut = passIn.cull;
+    passOut.pyramid = passIn.pyramid;
+    passOut.drawCMDs = builder.write(passIn.cull.drawCMDs);
+    passOut.cmdBuf = builder.write(passIn.cull.cmdBuf, AccessType::eComputeStorageWrite);
+    passOut.countBuf = builder.write(passIn.cull.countBuf, AccessType::eComputeStorageWrite);
+    passOut.instanceIds = builder.write(passIn.cull.instanceIds, AccessType::eComputeStorageWrite);
+    passOut.rejected = builder.write(passIn.cull.rejected, AccessType::eComputeStorageWrite);
+}
+
+void CullRetestPass::execute(RenderContext &ctx, Resources &resources) {
+    cull.executeRetest(ctx, resources.get(passIn.meshInstancesCount));
+}
+}
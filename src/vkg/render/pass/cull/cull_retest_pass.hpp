@@ -0,0 +1,29 @@
+#pragma once
+#include "compute_cull_drawcmd.hpp"
+
+namespace vkg {
+struct CullRetestPassIn {
+    ComputeCullDrawCMDPassOut cull;
+    FrameGraphResource<uint32_t> meshInstancesCount;
+    FrameGraphResource<BufferInfo> meshInstances;
+    FrameGraphResource<BufferInfo> primitives;
+    FrameGraphResource<BufferInfo> matrices;
+    /** the frame's depth pyramid, built by the `HiZPass` from the depth prepass. */
+    FrameGraphResource<Texture *> pyramid;
+};
+
+/**
+ * Second phase of the occlusion cull. The instances the `ComputeCullDrawCMD` rejected against the
+ * pyramid of an earlier frame are tested against the pyramid of this frame's depth prepass, and the
+ * visible ones are appended to the cull's draws, so they are drawn in the frame they become visible.
+ */
+class CullRetestPass: public Pass<CullRetestPassIn, ComputeCullDrawCMDPassOut> {
+public:
+    explicit CullRetestPass(ComputeCullDrawCMD &cull);
+    void setup(PassBuilder &builder) override;
+    void execute(RenderContext &ctx, Resources &resources) override;
+
+private:
+    ComputeCullDrawCMD &cull;
+};
+}
@@ -0,0 +1,139 @@
+#include "hiz_pass.hpp"
+#include "common/hiz_reduce_comp.hpp"
+
+namespace vkg {
+auto DepthPyramid::resize(Device &device, uint32_t frameIndex) -> void {
+    // the last frame using this index has finished, nothing else reads the texture.
+    auto &frame = frames[frameIndex];
+    frame.extent = requestedExtent;
+    frame.levels = image::mipLevels(std::max(frame.extent.width, frame.extent.height));
+    using vkUsage = vk::ImageUsageFlagBits;
+    frame.texture = image::make2DTex(
+        toString("depthPyramid", frameIndex), device, frame.extent.width, frame.extent.height,
+        vkUsage::eSampled | vkUsage::eStorage, vk::Format::eR32Sfloat, vk::SampleCountFlagBits::e1,
+        vk::ImageAspectFlagBits::eColor, true);
+    frame.texture->setSampler(
+        {{},
+         vk::Filter::eNearest,
+         vk::Filter::eNearest,
+         vk::SamplerMipmapMode::eNearest,
+         vk::SamplerAddressMode::eClampToEdge,
+         vk::SamplerAddressMode::eClampToEdge,
+         vk::SamplerAddressMode::eClampToEdge,
+         0,
+         false,
+         1,
+         false,
+         vk::CompareOp::eNever,
+         0,
+         float(frame.levels)});
+    frame.mipViews.clear();
+    for(auto level = 0u; level < frame.levels; ++level)
+        frame.mipViews.push_back(device.vkDevice().createImageViewUnique(
+            {{},
+             frame.texture->image(),
+             vk::ImageViewType::e2D,
+             vk::Format::eR32Sfloat,
+             {},
+             {vk::ImageAspectFlagBits::eColor, level, 1, 0, 1}}));
+    ++frame.version;
+    frame.valid = false;
+}
+
+HiZPass::HiZPass(DepthPyramid &pyramid): pyramid{pyramid} {}
+
+void HiZPass::setup(PassBuilder &builder) {
+    builder.read(passIn);
+    builder.read(passIn.depth, AccessType::eComputeRead);
+    passOut.pyramid = builder.write(passIn.pyramid, AccessType::eComputeStorageWrite);
+}
+
+void HiZPass::compile(RenderContext &ctx, Resources &resources) {
+    auto *depth = resources.get(passIn.depth);
+    if(!init) {
+        init = true;
+
+        reduceSetDef.init(ctx.device);
+        reducePipeDef.reduce(reduceSetDef);
+        reducePipeDef.init(ctx.device);
+        reducePipe = ComputePipelineMaker(ctx.device)
+                         .layout(reducePipeDef.layout())
+                         .shader(Shader{shader::common::hiz_reduce_comp_span, local_size, local_size, 1})
+                         .createUnique();
+
+        descriptorPool = DescriptorPoolMaker()
+                             .pipelineLayout(reducePipeDef, ctx.numFrames * maxLevels)
+                             .createUnique(ctx.device);
+
+        frames.resize(ctx.numFrames);
+        for(auto &frame: frames) {
+            for(auto &set: frame.reduceSets)
+                set = reduceSetDef.createSet(*descriptorPool);
+        }
+    }
+
+    pyramid.requestedExtent = vk::Extent2D{depth->extent().width, depth->extent().height};
+    auto &level = pyramid.frames[ctx.frameIndex];
+    // the cull recreates the pyramid before this frame index comes around again when the depth buffer was
+    // resized. Until then the re-test draws every rejected instance.
+    build = level.texture && level.extent == pyramid.requestedExtent;
+    level.valid = build;
+    if(!build) return;
+    errorIf(level.levels > maxLevels, "depth pyramid has more than ", maxLevels, " levels");
+
+    auto &frame = frames[ctx.frameIndex];
+    if(frame.depth != depth || frame.pyramidVersion != level.version) {
+        frame.depth = depth;
+        frame.pyramidVersion = level.version;
+        for(auto l = 0u; l < level.levels; ++l) {
+            auto src = l == 0 ? depth->imageView() : *level.mipViews[l - 1];
+            auto srcLayout = l == 0 ? vk::ImageLayout::eShaderReadOnlyOptimal : vk::ImageLayout::eGeneral;
+            reduceSetDef.src(level.texture->sampler(), src, srcLayout);
+            reduceSetDef.dst(*level.mipViews[l]);
+            reduceSetDef.update(frame.reduceSets[l]);
+        }
+    }
+
+    auto *camera = resources.get(passIn.camera);
+    auto viewProj = camera->proj() * camera->view();
+    // under dynamic resolution only the top left of the depth buffer is rendered to. Level 0 repeats
+    // its last row and column past it, and the projection is remapped to that part of the pyramid.
+    renderExtent = {
+        std::min(camera->renderWidth(), level.extent.width), std::min(camera->renderHeight(), level.extent.height)};
+    glm::vec2 scale{
+        float(renderExtent.width) / float(level.extent.width),
+        float(renderExtent.height) / float(level.extent.height)};
+    glm::mat4 remap{1};
+    remap[0][0] = scale.x;
+    remap[1][1] = scale.y;
+    remap[3][0] = scale.x - 1;
+    remap[3][1] = scale.y - 1;
+    level.viewProj = remap * viewProj;
+}
+
+void HiZPass::execute(RenderContext &ctx, Resources &resources) {
+    if(!build) return;
+    auto &frame = frames[ctx.frameIndex];
+    auto &level = pyramid.frames[ctx.frameIndex];
+    auto cb = ctx.cb;
+
+    ctx.device.begin(cb, "build depth pyramid");
+    cb.bindPipeline(vk::PipelineBindPoint::eCompute, *reducePipe);
+    glm::uvec2 srcSize{renderExtent.width, renderExtent.height};
+    for(auto l = 0u; l < level.levels; ++l) {
+        glm::uvec2 dstSize = glm::max(glm::uvec2{level.extent.width, level.extent.height} >> l, 1u);
+        cb.bindDescriptorSets(
+            vk::PipelineBindPoint::eCompute, reducePipeDef.layout(), reducePipeDef.reduce.set(), frame.reduceSets[l],
+            nullptr);
+        ReducePushConstant pushConstant{.srcSize = srcSize, .dstSize = dstSize, .level = l};
+        cb.pushConstants<ReducePushConstant>(
+            reducePipeDef.layout(), vk::ShaderStageFlagBits::eCompute, 0, pushConstant);
+        cb.dispatch((dstSize.x + local_size - 1) / local_size, (dstSize.y + local_size - 1) / local_size, 1);
+        cb.pipelineBarrier(
+            vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader, {},
+            vk::MemoryBarrier{vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eShaderRead}, nullptr, nullptr);
+        srcSize = dstSize;
+    }
+    ctx.device.end(cb);
+}
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include "vkg/base/base.hpp"
+#include "vkg/render/graph/frame_graph.hpp"
+#include "vkg/render/model/camera.hpp"
+
+namespace vkg {
+/**
+ * Depth pyramids shared by the `ComputeCullDrawCMD` testing instances against them, the `HiZPass`
+ * building them and the `CullRetestPass`. Each texel keeps the farthest depth of the pixels it covers.
+ */
+struct DepthPyramid {
+    /** extent of the depth buffer the pyramids are built from, the cull resizes a pyramid to it. */
+    vk::Extent2D requestedExtent;
+
+    /**
+     * pyramid of one frame in flight. The cull tests against it before the frame's `HiZPass` rebuilds
+     * it, so it only ever waits on the frame that last used the same index.
+     */
+    struct Frame {
+        std::unique_ptr<Texture> texture;
+        std::vector<vk::UniqueImageView> mipViews;
+        vk::Extent2D extent;
+        uint32_t levels{0};
+        /** increased every time the texture is recreated. */
+        uint64_t version{0};
+
+        /** view projection the pyramid was built with. Only meaningful once `valid`. */
+        glm::mat4 viewProj{1};
+        bool valid{false};
+    };
+    std::vector<Frame> frames;
+
+    /** recreate the texture of the frame in `requestedExtent`. */
+    auto resize(Device &device, uint32_t frameIndex) -> void;
+};
+
+struct HiZPassIn {
+    FrameGraphResource<Camera *> camera;
+    FrameGraphResource<Texture *> depth;
+    FrameGraphResource<Texture *> pyramid;
+};
+struct HiZPassOut {
+    FrameGraphResource<Texture *> pyramid;
+};
+
+/**
+ * Reduces the depth prepass into the frame's `DepthPyramid`, which the `CullRetestPass` tests the
+ * instances the cull rejected against.
+ */
+class HiZPass: public Pass<HiZPassIn, HiZPassOut> {
+public:
+    explicit HiZPass(DepthPyramid &pyramid);
+    void setup(PassBuilder &builder) override;
+    void compile(RenderContext &ctx, Resources &resources) override;
+    void execute(RenderContext &ctx, Resources &resources) override;
+
+private:
+    DepthPyramid &pyramid;
+
+    struct ReduceSetDef: DescriptorSetDef {
+        __sampler2D__(src, vk::ShaderStageFlagBits::eCompute);
+        __image2D__(dst, vk::ShaderStageFlagBits::eCompute);
+    } reduceSetDef;
+    struct ReducePushConstant {
+        glm::uvec2 srcSize;
+        glm::uvec2 dstSize;
+        uint32_t level;
+    };
+    struct ReducePipeDef: PipelineLayoutDef {
+        __push_constant__(pushConst, vk::ShaderStageFlagBits::eCompute, ReducePushConstant);
+        __set__(reduce, ReduceSetDef);
+    } reducePipeDef;
+
+    vk::UniquePipeline reducePipe;
+    const uint32_t local_size = 8;
+    /** enough levels for a 32768 pixels wide depth buffer. */
+    static const uint32_t maxLevels = 16;
+
+    vk::UniqueDescriptorPool descriptorPool;
+
+    struct FrameResource {
+        std::array<vk::DescriptorSet, maxLevels> reduceSets;
+        Texture *depth{nullptr};
+        uint64_t pyramidVersion{0};
+    };
+    std::vector<FrameResource> frames;
+
+    /** part of the depth buffer that was rendered to. */
+    vk::Extent2D renderExtent;
+    bool build{false};
+    bool init{false};
+};
+}
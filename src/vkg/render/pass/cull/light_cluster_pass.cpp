@@ -0,0 +1,64 @@
+#include "light_cluster_pass.hpp"
+#include "common/light_cluster_comp.hpp"
+
+namespace vkg {
+void LightClusterPass::setup(PassBuilder &builder) {
+    builder.read(passIn);
+    passOut = {
+        .lightClusters = builder.create<BufferInfo>("lightClusters", AccessType::eComputeStorageWrite),
+    };
+}
+
+void LightClusterPass::compile(RenderContext &ctx, Resources &resources) {
+    if(!init) {
+        init = true;
+
+        setDef.init(ctx.device);
+        pipeDef.cluster(setDef);
+        pipeDef.init(ctx.device);
+        pipe = ComputePipelineMaker(ctx.device)
+                   .layout(pipeDef.layout())
+                   .shader(Shader{shader::common::light_cluster_comp_span, local_size, 1, 1})
+                   .createUnique();
+
+        descriptorPool = DescriptorPoolMaker().pipelineLayout(pipeDef, ctx.numFrames).createUnique(ctx.device);
+
+        frames.resize(ctx.numFrames);
+        for(auto i = 0u; i < ctx.numFrames; ++i) {
+            auto &frame = frames[i];
+            frame.clusters = buffer::devStorageBuffer(
+                ctx.device, sizeof(uint32_t) * numClusters * (maxLightsPerCluster + 1),
+                toString(name, "_clusters_", i));
+            frame.set = setDef.createSet(*descriptorPool);
+        }
+    }
+    auto &frame = frames[ctx.frameIndex];
+    setDef.lighting(resources.get(passIn.lighting));
+    setDef.lights(resources.get(passIn.lights));
+    setDef.clusters(frame.clusters->bufferInfo());
+    setDef.update(frame.set);
+
+    auto *camera = resources.get(passIn.camera);
+    auto proj = camera->proj();
+    pushConstant = {
+        .view = camera->view(),
+        .projScale = {proj[0][0], proj[1][1]},
+        .zNear = camera->zNear(),
+        .zFar = camera->zFar(),
+    };
+
+    resources.set(passOut.lightClusters, frame.clusters->bufferInfo());
+}
+
+void LightClusterPass::execute(RenderContext &ctx, Resources &resources) {
+    auto &frame = frames[ctx.frameIndex];
+    auto cb = ctx.cb;
+    ctx.device.begin(cb, "assign lights to clusters");
+    cb.bindPipeline(vk::PipelineBindPoint::eCompute, *pipe);
+    cb.bindDescriptorSets(
+        vk::PipelineBindPoint::eCompute, pipeDef.layout(), pipeDef.cluster.set(), frame.set, nullptr);
+    cb.pushConstants<PushConstant>(pipeDef.layout(), vk::ShaderStageFlagBits::eCompute, 0, pushConstant);
+    cb.dispatch((numClusters + local_size - 1) / local_size, 1, 1);
+    ctx.device.end(cb);
+}
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include "vkg/base/base.hpp"
+#include "vkg/render/graph/frame_graph.hpp"
+#include "vkg/render/model/camera.hpp"
+
+namespace vkg {
+struct LightClusterPassIn {
+    FrameGraphResource<Camera *> camera;
+    FrameGraphResource<BufferInfo> lighting;
+    FrameGraphResource<BufferInfo> lights;
+};
+struct LightClusterPassOut {
+    /** per cluster, the number of lights followed by their indices, see light_cluster.h. */
+    FrameGraphResource<BufferInfo> lightClusters;
+};
+
+/**
+ * Assigns the lights to the clusters of the camera's view frustum, so shading a fragment only
+ * iterates the lights whose range reaches the cluster it is in.
+ */
+class LightClusterPass: public Pass<LightClusterPassIn, LightClusterPassOut> {
+public:
+    void setup(PassBuilder &builder) override;
+    void compile(RenderContext &ctx, Resources &resources) override;
+    void execute(RenderContext &ctx, Resources &resources) override;
+
+    /** matches the constants in light_cluster.h. */
+    static const uint32_t clusterCountX = 16, clusterCountY = 9, clusterCountZ = 24;
+    static const uint32_t numClusters = clusterCountX * clusterCountY * clusterCountZ;
+    static const uint32_t maxLightsPerCluster = 127;
+
+private:
+    struct SetDef: DescriptorSetDef {
+        __uniform__(lighting, vk::ShaderStageFlagBits::eCompute);
+        __buffer__(lights, vk::ShaderStageFlagBits::eCompute);
+        __buffer__(clusters, vk::ShaderStageFlagBits::eCompute);
+    } setDef;
+    struct PushConstant {
+        glm::mat4 view;
+        glm::vec2 projScale;
+        float zNear;
+        float zFar;
+    } pushConstant{};
+    struct PipeDef: PipelineLayoutDef {
+        __push_constant__(pushConst, vk::ShaderStageFlagBits::eCompute, PushConstant);
+        __set__(cluster, SetDef);
+    } pipeDef;
+
+    vk::UniquePipeline pipe;
+    /** matches `clusterGroupSize` in light_cluster.h. */
+    const uint32_t local_size = 64;
+
+    vk::UniqueDescriptorPool descriptorPool;
+
+    struct FrameResource {
+        std::unique_ptr<Buffer> clusters;
+        vk::DescriptorSet set;
+    };
+    std::vector<FrameResource> frames;
+    bool init{false};
+};
+}
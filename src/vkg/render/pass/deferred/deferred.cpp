@@ -4,7 +4,31 @@ namespace vkg {
 
 void DeferredPass::setup(PassBuilder &builder) {
     builder.read(passIn);
+    builder.read(passIn.matrices, AccessType::eVertexRead);
+    builder.read(passIn.prevMatrices, AccessType::eVertexRead);
+    builder.read(passIn.shadowmap.cascades, AccessType::eFragmentRead);
+    builder.read(passIn.lightClusters, AccessType::eFragmentRead);
+    builder.read(passIn.cullCMD.cmdBuf, AccessType::eIndirectRead);
+    builder.read(passIn.cullCMD.countBuf, AccessType::eIndirectRead);
+    builder.read(passIn.cullCMD.instanceIds, AccessType::eVertexRead);
     passOut.backImg = builder.write(passIn.backImg);
+    passOut.depth = builder.write(passIn.depth, AccessType::eDepthAttachment);
+    passOut.velocity = builder.create<Texture *>("velocity");
+
+    using vkUsage = vk::ImageUsageFlagBits;
+    auto attachment = [&](const std::string &name, vk::Format format) {
+        return builder.createTexture(
+            name, {.format = format, .usage = vkUsage::eColorAttachment | vkUsage::eInputAttachment},
+            AccessType::eColorAttachment);
+    };
+    gbuffer = {
+        .normal = attachment("normal", vk::Format::eR16G16B16A16Sfloat),
+        .diffuse = attachment("diffuse", vk::Format::eR8G8B8A8Unorm),
+        .specular = attachment("specular", vk::Format::eR8G8B8A8Unorm),
+        .emissive = attachment("emissive", vk::Format::eR8G8B8A8Unorm),
+        .transColor = attachment("transColor", vk::Format::eR16G16B16A16Sfloat),
+        .reveal = attachment("reveal", vk::Format::eR16Sfloat),
+    };
 }
 void DeferredPass::compile(RenderContext &ctx, Resources &resources) {
     auto *backImg = resources.get(passIn.backImg);
@@ -15,7 +39,7 @@ void DeferredPass::compile(RenderContext &ctx, Resources &resources) {
         init = true;
 
         auto sceneConfig = resources.get(passIn.sceneConfig);
-        sceneSetDef.textures.descriptorCount() = sceneConfig.maxNumTextures;
+        sceneSetDef.textures.array(sceneConfig.maxNumTextures, resources.device.supported().descriptorIndexing);
         sceneSetDef.init(resources.device);
         gbufferSetDef.init(resources.device);
         transSetDef.init(resources.device);
@@ -28,6 +52,7 @@ void DeferredPass::compile(RenderContext &ctx, Resources &resources) {
         pipeDef.shadowMap(csmSetDef);
         pipeDef.init(resources.device);
 
+        createDummies(resources.device);
         createRenderPass(resources.device, backImg->format());
         createGbufferPass(resources.device, sceneConfig);
         createLightingPass(resources.device, sceneConfig);
@@ -48,16 +73,28 @@ void DeferredPass::compile(RenderContext &ctx, Resources &resources) {
                 frames[i].atmosphereSet = atmosphereSetDef.createSet(*descriptorPool);
                 sceneSetDef.textures(0, uint32_t(samplers.size()), samplers.data());
                 sceneSetDef.update(frames[i].sceneSet);
+                frames[i].lastNumValidSampler = numValidSampler;
             }
         }
     }
 
     auto &frame = frames[ctx.frameIndex];
 
-    if(backImg != frame.backImg) {
+    // transients are reallocated all together, e.g. when the swapchain is resized.
+    auto *normalAtt = resources.get(gbuffer.normal);
+    auto *depth = resources.get(passIn.depth);
+    if(backImg != frame.backImg || normalAtt != frame.normalAtt || depth != frame.depthAtt) {
         frame.backImg = backImg;
+        frame.normalAtt = normalAtt;
+        frame.depthAtt = depth;
+        frame.diffuseAtt = resources.get(gbuffer.diffuse);
+        frame.specularAtt = resources.get(gbuffer.specular);
+        frame.emissiveAtt = resources.get(gbuffer.emissive);
+        frame.transColorAtt = resources.get(gbuffer.transColor);
+        frame.revealAtt = resources.get(gbuffer.reveal);
         createAttachments(resources.device, ctx.frameIndex);
     }
+    resources.set(passOut.velocity, frame.velocityAtt.get());
     if(numValidSampler > frame.lastNumValidSampler) {
         sceneSetDef.textures(
             frame.lastNumValidSampler, numValidSampler - frame.lastNumValidSampler,
@@ -70,51 +107,95 @@ void DeferredPass::compile(RenderContext &ctx, Resources &resources) {
     sceneSetDef.materials(resources.get(passIn.materials));
     sceneSetDef.lighting(resources.get(passIn.lighting));
     sceneSetDef.lights(resources.get(passIn.lights));
+    sceneSetDef.instanceIds(resources.get(passIn.cullCMD.drawCMDs).instanceIds);
+    sceneSetDef.lightClusters(resources.get(passIn.lightClusters));
+    sceneSetDef.prevMatrices(resources.get(passIn.prevMatrices));
     sceneSetDef.update(frame.sceneSet);
 
-    if(auto atmosSetting = resources.get(passIn.atmosSetting); atmosSetting.isEnabled()) {
-        atmosphereSetDef.atmosphere(resources.get(passIn.atmosphere.atmosphere));
-        atmosphereSetDef.sun(resources.get(passIn.atmosphere.sun));
-        atmosphereSetDef.transmittance(*resources.get(passIn.atmosphere.transmittance));
-        atmosphereSetDef.scattering(*resources.get(passIn.atmosphere.scattering));
-        atmosphereSetDef.irradiance(*resources.get(passIn.atmosphere.irradiance));
+    storeVelocity = resources.get(passIn.temporalAA).isEnabled();
+
+    auto atmosEnabled = resources.get(passIn.atmosSetting).isEnabled();
+    auto shadowMapEnabled = resources.get(passIn.shadowMapSetting).isEnabled();
+    // create the lighting variant before recording so no pipeline is compiled inside the render pass.
+    litVariant = (atmosEnabled ? 1u : 0u) | (shadowMapEnabled ? 2u : 0u);
+    litPipes.get(litVariant);
+
+    // the sets are only written when the bound resources change.
+    auto atmosVersion = atmosEnabled ? resources.get(passIn.atmosphere.version) : 0;
+    if(atmosVersion != frame.atmosphereVersion) {
+        frame.atmosphereVersion = atmosVersion;
+        if(atmosEnabled) {
+            atmosphereSetDef.atmosphere(resources.get(passIn.atmosphere.atmosphere));
+            atmosphereSetDef.sun(resources.get(passIn.atmosphere.sun));
+            atmosphereSetDef.transmittance(*resources.get(passIn.atmosphere.transmittance));
+            atmosphereSetDef.scattering(*resources.get(passIn.atmosphere.scattering));
+            atmosphereSetDef.irradiance(*resources.get(passIn.atmosphere.irradiance));
+        } else {
+            atmosphereSetDef.atmosphere(dummies.uniform->bufferInfo());
+            atmosphereSetDef.sun(dummies.uniform->bufferInfo());
+            atmosphereSetDef.transmittance(*dummies.tex2D);
+            atmosphereSetDef.scattering(*dummies.tex3D);
+            atmosphereSetDef.irradiance(*dummies.tex2D);
+        }
         atmosphereSetDef.update(frame.atmosphereSet);
     }
 
-    if(auto shadowMapSetting = resources.get(passIn.shadowMapSetting); shadowMapSetting.isEnabled()) {
-        csmSetDef.setting(resources.get(passIn.shadowmap.settingBuffer));
-        csmSetDef.cascades(resources.get(passIn.shadowmap.cascades));
-        csmSetDef.shadowMaps(*resources.get(passIn.shadowmap.shadowMaps));
+    auto *shadowMaps = shadowMapEnabled ? resources.get(passIn.shadowmap.shadowMaps) : dummies.tex2DArray.get();
+    auto cascades = shadowMapEnabled ? resources.get(passIn.shadowmap.cascades) : dummies.storage->bufferInfo();
+    if(shadowMaps != frame.shadowMaps || cascades.buffer != frame.cascades) {
+        frame.shadowMaps = shadowMaps;
+        frame.cascades = cascades.buffer;
+        csmSetDef.setting(
+            shadowMapEnabled ? resources.get(passIn.shadowmap.settingBuffer) : dummies.uniform->bufferInfo());
+        csmSetDef.cascades(cascades);
+        csmSetDef.shadowMaps(*shadowMaps);
         csmSetDef.update(frame.shadowMapSet);
     }
 }
 
+auto DeferredPass::createDummies(Device &device) -> void {
+    // larger than any uniform block of the atmosphere and shadow map sets.
+    constexpr vk::DeviceSize uniformSize = 1024;
+    dummies.uniform = buffer::devUniformBuffer(device, uniformSize, name + "_dummyUniform");
+    dummies.storage = buffer::devStorageBuffer(device, uniformSize, name + "_dummyStorage");
+    auto makeTex = [&](vk::ImageType type, vk::ImageViewType viewType, const std::string &texName) {
+        auto texture = std::make_unique<Texture>(
+            device,
+            vk::ImageCreateInfo{
+                {},
+                type,
+                vk::Format::eR8G8B8A8Unorm,
+                {1, 1, 1},
+                1,
+                1,
+                vk::SampleCountFlagBits::e1,
+                vk::ImageTiling::eOptimal,
+                vk::ImageUsageFlagBits::eSampled},
+            VmaAllocationCreateInfo{{}, VMA_MEMORY_USAGE_GPU_ONLY}, name + texName);
+        texture->setImageView(viewType, vk::ImageAspectFlagBits::eColor);
+        texture->setSampler({});
+        device.execSync(
+            [&](vk::CommandBuffer cb) {
+                image::transitTo(
+                    cb, *texture, vk::ImageLayout::eShaderReadOnlyOptimal, vk::AccessFlagBits::eShaderRead,
+                    vk::PipelineStageFlagBits::eFragmentShader);
+            },
+            0);
+        return texture;
+    };
+    dummies.tex2D = makeTex(vk::ImageType::e2D, vk::ImageViewType::e2D, "_dummy2D");
+    dummies.tex3D = makeTex(vk::ImageType::e3D, vk::ImageViewType::e3D, "_dummy3D");
+    dummies.tex2DArray = makeTex(vk::ImageType::e2D, vk::ImageViewType::e2DArray, "_dummy2DArray");
+}
+
 auto DeferredPass::createAttachments(Device &device, uint32_t frameIdx) -> void {
     auto &frame = frames[frameIdx];
     auto w = frame.backImg->extent().width;
     auto h = frame.backImg->extent().height;
     using vkUsage = vk::ImageUsageFlagBits;
-    frame.normalAtt = image::make2DTex(
-        toString("normalAtt", frameIdx), device, w, h, vkUsage::eColorAttachment | vkUsage::eInputAttachment,
-        vk::Format::eR16G16B16A16Sfloat);
-    frame.diffuseAtt = image::make2DTex(
-        toString("diffuseAtt", frameIdx), device, w, h, vkUsage::eColorAttachment | vkUsage::eInputAttachment,
-        vk::Format::eR8G8B8A8Unorm);
-    frame.specularAtt = image::make2DTex(
-        toString("specularAtt", frameIdx), device, w, h, vkUsage::eColorAttachment | vkUsage::eInputAttachment,
-        vk::Format::eR8G8B8A8Unorm);
-    frame.emissiveAtt = image::make2DTex(
-        toString("emissiveAtt", frameIdx), device, w, h, vkUsage::eColorAttachment | vkUsage::eInputAttachment,
-        vk::Format::eR8G8B8A8Unorm);
-    frame.transColorAtt = image::make2DTex(
-        toString("transColorAtt", frameIdx), device, w, h, vkUsage ::eColorAttachment | vkUsage::eInputAttachment,
-        vk::Format::eR16G16B16A16Sfloat, vk::SampleCountFlagBits::e1, vk::ImageAspectFlagBits::eColor);
-    frame.revealAtt = image::make2DTex(
-        toString("revelAtt", frameIdx), device, w, h, vkUsage ::eColorAttachment | vkUsage::eInputAttachment,
-        vk::Format::eR16Sfloat, vk::SampleCountFlagBits::e1, vk::ImageAspectFlagBits::eColor);
-    frame.depthAtt = image::make2DTex(
-        toString("depthAtt", frameIdx), device, w, h, vkUsage::eDepthStencilAttachment | vkUsage::eInputAttachment,
-        vk::Format::eD32Sfloat, vk::SampleCountFlagBits::e1, vk::ImageAspectFlagBits::eDepth);
+    frame.velocityAtt = image::make2DTex(
+        toString("velocityAtt", frameIdx), device, w, h, vkUsage::eColorAttachment | vkUsage::eSampled,
+        vk::Format::eR16G16Sfloat);
 
     gbufferSetDef.normal(frame.normalAtt->imageView());
     gbufferSetDef.diffuse(frame.diffuseAtt->imageView());
@@ -130,7 +211,8 @@ auto DeferredPass::createAttachments(Device &device, uint32_t frameIdx) -> void
     std::vector<vk::ImageView> attachments = {frame.backImg->imageView(),     frame.normalAtt->imageView(),
                                               frame.diffuseAtt->imageView(),  frame.specularAtt->imageView(),
                                               frame.emissiveAtt->imageView(), frame.transColorAtt->imageView(),
-                                              frame.revealAtt->imageView(),   frame.depthAtt->imageView()};
+                                              frame.revealAtt->imageView(),   frame.velocityAtt->imageView(),
+                                              frame.depthAtt->imageView()};
 
     vk::FramebufferCreateInfo info{{}, *renderPass, uint32_t(attachments.size()), attachments.data(), w, h, 1};
 
@@ -167,8 +249,17 @@ auto DeferredPass::createRenderPass(Device &device, vk::Format format) -> void {
                       .loadOp(vk::AttachmentLoadOp::eClear)
                       .storeOp(vk::AttachmentStoreOp::eDontCare)
                       .index();
+    // kept for the temporal anti-aliasing.
+    auto velocity = maker.attachmentCopy(normal)
+                        .format(vk::Format::eR16G16Sfloat)
+                        .storeOp(vk::AttachmentStoreOp::eStore)
+                        .index();
+    // continues the depth prepass.
     auto depth = maker.attachmentCopy(normal)
                      .format(vk::Format::eD32Sfloat)
+                     .loadOp(vk::AttachmentLoadOp::eLoad)
+                     .storeOp(vk::AttachmentStoreOp::eStore)
+                     .initialLayout(vk::ImageLayout::eDepthStencilAttachmentOptimal)
                      .finalLayout(vk::ImageLayout::eDepthStencilAttachmentOptimal)
                      .index();
     gbPass = maker.subpass(vk::PipelineBindPoint::eGraphics)
@@ -176,6 +267,7 @@ auto DeferredPass::createRenderPass(Device &device, vk::Format format) -> void {
                  .color(diffuse)
                  .color(specular)
                  .color(emissive)
+                 .color(velocity)
                  .depthStencil(depth)
                  .index();
     litPass = maker.subpass(vk::PipelineBindPoint::eGraphics)
@@ -185,8 +277,10 @@ auto DeferredPass::createRenderPass(Device &device, vk::Format format) -> void {
                   .input(specular)
                   .input(emissive)
                   .input(depth)
+                  .preserve(velocity)
                   .index();
-    unlitPass = maker.subpass(vk::PipelineBindPoint::eGraphics).color(backImg).depthStencil(depth).index();
+    unlitPass =
+        maker.subpass(vk::PipelineBindPoint::eGraphics).color(backImg).color(velocity).depthStencil(depth).index();
     transPass =
         maker.subpass(vk::PipelineBindPoint::eGraphics).color(transColor).color(reveal).depthStencil(depth).index();
     compositePass =
@@ -209,6 +303,13 @@ auto DeferredPass::createRenderPass(Device &device, vk::Format format) -> void {
         .srcAccess(vk::AccessFlagBits::eColorAttachmentWrite)
         .dstAccess(vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite)
         .flags(vk::DependencyFlagBits::eByRegion);
+    // the unlit geometry writes over the velocity of the gbuffer.
+    maker.dependency(gbPass, unlitPass)
+        .srcStage(vk::PipelineStageFlagBits::eColorAttachmentOutput)
+        .dstStage(vk::PipelineStageFlagBits::eColorAttachmentOutput)
+        .srcAccess(vk::AccessFlagBits::eColorAttachmentWrite)
+        .dstAccess(vk::AccessFlagBits::eColorAttachmentWrite)
+        .flags(vk::DependencyFlagBits::eByRegion);
     maker.dependency(unlitPass, transPass)
         .srcStage(vk::PipelineStageFlagBits::eColorAttachmentOutput)
         .dstStage(vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests)
@@ -229,6 +330,9 @@ auto DeferredPass::createRenderPass(Device &device, vk::Format format) -> void {
         .flags(vk::DependencyFlagBits::eByRegion);
 
     renderPass = maker.createUnique(device);
+    // only the store op differs, so the framebuffers and pipelines are shared.
+    AttachmentMaker(maker, velocity).storeOp(vk::AttachmentStoreOp::eDontCare);
+    noVelocityRenderPass = maker.createUnique(device);
 }
 
 }
@@ -3,6 +3,7 @@
 #include "vkg/render/scene_config.hpp"
 #include "vkg/render/graph/frame_graph.hpp"
 #include "vkg/render/model/camera.hpp"
+#include "vkg/render/model/temporal_aa.hpp"
 #include "vkg/render/pass/cull/compute_cull_drawcmd.hpp"
 #include "vkg/render/model/vertex.hpp"
 #include "vkg/render/shade_model.hpp"
@@ -13,6 +14,10 @@
 namespace vkg {
 struct DeferredPassIn {
     FrameGraphResource<Texture *> backImg;
+    /** part of the render targets that is rendered to, from their origin. */
+    FrameGraphResource<vk::Extent2D> renderExtent;
+    /** depth of the `DepthPrepass`, the gbuffer is drawn on top of it. */
+    FrameGraphResource<Texture *> depth;
     FrameGraphResource<BufferInfo> camBuffer;
     ComputeCullDrawCMDPassOut cullCMD;
     FrameGraphResource<SceneConfig> sceneConfig;
@@ -22,6 +27,10 @@ struct DeferredPassIn {
     FrameGraphResource<BufferInfo> uvs;
     FrameGraphResource<BufferInfo> indices;
     FrameGraphResource<BufferInfo> matrices;
+    /** model matrices of the previous frame, to compute the velocity. */
+    FrameGraphResource<BufferInfo> prevMatrices;
+    /** the velocity is only stored while the TAA is enabled. */
+    FrameGraphResource<TemporalAASetting> temporalAA;
     FrameGraphResource<BufferInfo> materials;
     FrameGraphResource<std::span<vk::DescriptorImageInfo>> samplers;
     FrameGraphResource<uint32_t> numValidSampler;
@@ -33,9 +42,14 @@ struct DeferredPassIn {
 
     FrameGraphResource<ShadowMapSetting> shadowMapSetting;
     ShadowMapPassOut shadowmap;
+
+    FrameGraphResource<BufferInfo> lightClusters;
 };
 struct DeferredPassOut {
     FrameGraphResource<Texture *> backImg;
+    FrameGraphResource<Texture *> depth;
+    /** screen uv offset of the opaque surfaces since the previous frame. */
+    FrameGraphResource<Texture *> velocity;
 };
 
 class DeferredPass: public Pass<DeferredPassIn, DeferredPassOut> {
@@ -46,6 +60,7 @@ public:
 
 private:
     auto createAttachments(Device &device, uint32_t frameIdx) -> void;
+    auto createDummies(Device &device) -> void;
     auto createRenderPass(Device &device, vk::Format format) -> void;
     auto createGbufferPass(Device &device, SceneConfig sceneConfig) -> void;
     auto createLightingPass(Device &device, SceneConfig sceneConfig) -> void;
@@ -62,6 +77,9 @@ private:
 
         __uniform__(lighting, vkStage::eFragment);
         __buffer__(lights, vkStage::eFragment);
+        __buffer__(instanceIds, vkStage::eVertex);
+        __buffer__(lightClusters, vkStage::eFragment);
+        __buffer__(prevMatrices, vkStage::eVertex);
     } sceneSetDef;
 
     struct GBufferSetDef: DescriptorSetDef {
@@ -103,6 +121,11 @@ private:
         __set__(shadowMap, CSMSetDef);
     } pipeDef;
 
+    /** transient attachments only used inside the render pass, their memory is shared with other passes. */
+    struct GBuffer {
+        FrameGraphResource<Texture *> normal, diffuse, specular, emissive, transColor, reveal;
+    } gbuffer;
+
     bool wireframe_{false};
     float lineWidth_{1.f};
 
@@ -110,18 +133,40 @@ private:
 
     uint32_t gbPass{}, litPass{}, unlitPass{}, transPass{}, compositePass{};
     vk::UniqueRenderPass renderPass;
+    /** compatible with `renderPass`, but discards the velocity while the TAA is disabled. */
+    vk::UniqueRenderPass noVelocityRenderPass;
+    bool storeVelocity{true};
     vk::UniquePipeline gbTriPipe, gbWireFramePipe;
     vk::UniquePipeline unlitTriPipe, unlitLinePipe;
     vk::UniquePipeline transTriPipe, transLinePipe, compositePipe;
-    vk::UniquePipeline litPipe, litAtmosPipe, litCSMPipe, litAtmosCSMPipe;
+    /** lighting permutations, bit 0 for the atmosphere and bit 1 for the shadow map. */
+    std::unique_ptr<ShaderVariants> litShader;
+    PipelineVariants litPipes;
+    uint32_t litVariant{0};
 
     vk::UniqueDescriptorPool descriptorPool;
 
+    /**
+     * lit.frag statically uses the atmosphere and shadow map sets in every variant, so they are bound
+     * with these when disabled.
+     */
+    struct Dummies {
+        std::unique_ptr<Buffer> uniform, storage;
+        std::unique_ptr<Texture> tex2D, tex3D, tex2DArray;
+    } dummies;
+
     struct FrameResource {
         Texture *backImg;
-        std::unique_ptr<Texture> depthAtt, normalAtt, diffuseAtt, specularAtt, emissiveAtt, transColorAtt, revealAtt;
+        Texture *normalAtt{}, *diffuseAtt{}, *specularAtt{}, *emissiveAtt{}, *transColorAtt{}, *revealAtt{};
+        Texture *depthAtt{};
+        std::unique_ptr<Texture> velocityAtt;
         uint64_t lastNumValidSampler{0};
         vk::DescriptorSet sceneSet, gbSet, transSet, shadowMapSet, atmosphereSet;
+        /** `AtmospherePassOut::version` written into `atmosphereSet`, 0 for the dummies. */
+        uint64_t atmosphereVersion{~0ull};
+        /** shadow maps and cascades written into `shadowMapSet`, the dummies' if disabled. */
+        Texture *shadowMaps{};
+        vk::Buffer cascades;
         vk::UniqueFramebuffer framebuffer;
     };
     std::vector<FrameResource> frames;
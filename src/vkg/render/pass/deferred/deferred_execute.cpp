@@ -2,9 +2,7 @@
 
 namespace vkg {
 void DeferredPass::execute(RenderContext &ctx, Resources &resources) {
-    auto drawInfos = resources.get(passIn.cullCMD.drawCMDs);
-    auto atmosSetting = resources.get(passIn.atmosSetting);
-    auto shadowMapSetting = resources.get(passIn.shadowMapSetting);
+    auto &drawInfos = resources.get(passIn.cullCMD.drawCMDs);
 
     auto &frame = frames[ctx.frameIndex];
 
@@ -12,14 +10,8 @@ void DeferredPass::execute(RenderContext &ctx, Resources &resources) {
     image::transitTo(
         cb, *frame.backImg, vk::ImageLayout::eColorAttachmentOptimal, vk::AccessFlagBits::eColorAttachmentWrite,
         vk::PipelineStageFlagBits::eColorAttachmentOutput);
-    image::transitTo(
-        cb, *frame.transColorAtt, vk::ImageLayout::eColorAttachmentOptimal, vk::AccessFlagBits::eColorAttachmentWrite,
-        vk::PipelineStageFlagBits::eColorAttachmentOutput);
-    image::transitTo(
-        cb, *frame.revealAtt, vk::ImageLayout::eColorAttachmentOptimal, vk::AccessFlagBits::eColorAttachmentWrite,
-        vk::PipelineStageFlagBits::eColorAttachmentOutput);
 
-    std::array<vk::ClearValue, 8> clearValues{
+    std::array<vk::ClearValue, 9> clearValues{
         vk::ClearColorValue{std::array{0.0f, 0.0f, 0.0f, 0.0f}},
         vk::ClearColorValue{std::array{0.0f, 0.0f, 0.0f, 0.0f}},
         vk::ClearColorValue{std::array{0.0f, 0.0f, 0.0f, 0.0f}},
@@ -27,18 +19,19 @@ void DeferredPass::execute(RenderContext &ctx, Resources &resources) {
         vk::ClearColorValue{std::array{0.0f, 0.0f, 0.0f, 0.0f}},
         vk::ClearColorValue{std::array{0.0f, 0.0f, 0.0f, 0.0f}},
         vk::ClearColorValue{std::array{1.0f, 0.0f, 0.0f, 0.0f}},
+        vk::ClearColorValue{std::array{0.0f, 0.0f, 0.0f, 0.0f}},
         vk::ClearDepthStencilValue{1.0f, 0},
     };
 
+    // the targets keep their size under dynamic resolution, only the render extent is drawn to.
+    auto extent = resources.get(passIn.renderExtent);
     vk::RenderPassBeginInfo renderPassBeginInfo{
-        *renderPass, *frame.framebuffer,
-        vk::Rect2D{{0, 0}, {frame.backImg->extent().width, frame.backImg->extent().height}},
+        storeVelocity ? *renderPass : *noVelocityRenderPass, *frame.framebuffer, vk::Rect2D{{0, 0}, extent},
         uint32_t(clearValues.size()), clearValues.data()};
     cb.beginRenderPass(renderPassBeginInfo, vk::SubpassContents::eInline);
-    vk::Viewport viewport{0,    0,   float(frame.backImg->extent().width), float(frame.backImg->extent().height),
-                          0.0f, 1.0f};
+    vk::Viewport viewport{0, 0, float(extent.width), float(extent.height), 0.0f, 1.0f};
     cb.setViewport(0, viewport);
-    vk::Rect2D scissor{{0, 0}, {frame.backImg->extent().width, frame.backImg->extent().height}};
+    vk::Rect2D scissor{{0, 0}, extent};
     cb.setScissor(0, scissor);
 
     auto &dev = resources.device;
@@ -48,12 +41,11 @@ void DeferredPass::execute(RenderContext &ctx, Resources &resources) {
         vk::PipelineBindPoint::eGraphics, pipeDef.layout(), pipeDef.gbuffer.set(), frame.gbSet, nullptr);
     cb.bindDescriptorSets(
         vk::PipelineBindPoint::eGraphics, pipeDef.layout(), pipeDef.trans.set(), frame.transSet, nullptr);
-    if(atmosSetting.isEnabled())
-        cb.bindDescriptorSets(
-            vk::PipelineBindPoint::eGraphics, pipeDef.layout(), pipeDef.atmosphere.set(), frame.atmosphereSet, nullptr);
-    if(shadowMapSetting.isEnabled())
-        cb.bindDescriptorSets(
-            vk::PipelineBindPoint::eGraphics, pipeDef.layout(), pipeDef.shadowMap.set(), frame.shadowMapSet, nullptr);
+    // bound even when disabled, see `dummies`.
+    cb.bindDescriptorSets(
+        vk::PipelineBindPoint::eGraphics, pipeDef.layout(), pipeDef.atmosphere.set(), frame.atmosphereSet, nullptr);
+    cb.bindDescriptorSets(
+        vk::PipelineBindPoint::eGraphics, pipeDef.layout(), pipeDef.shadowMap.set(), frame.shadowMapSet, nullptr);
 
     auto bufInfo = resources.get(passIn.positions);
     cb.bindVertexBuffers(0, bufInfo.buffer, bufInfo.offset);
@@ -89,15 +81,7 @@ void DeferredPass::execute(RenderContext &ctx, Resources &resources) {
     cb.nextSubpass(vk::SubpassContents::eInline);
 
     dev.begin(cb, "Subpass deferred lighting");
-    vk::Pipeline pipe;
-    if(atmosSetting.isEnabled() && shadowMapSetting.isEnabled()) pipe = *litAtmosCSMPipe;
-    else if(atmosSetting.isEnabled())
-        pipe = *litAtmosPipe;
-    else if(shadowMapSetting.isEnabled())
-        pipe = *litCSMPipe;
-    else
-        pipe = *litPipe;
-    cb.bindPipeline(vk::PipelineBindPoint::eGraphics, pipe);
+    cb.bindPipeline(vk::PipelineBindPoint::eGraphics, litPipes.get(litVariant));
     cb.draw(3, 1, 0, 0);
     dev.end(cb);
 
@@ -135,5 +119,11 @@ void DeferredPass::execute(RenderContext &ctx, Resources &resources) {
     dev.end(cb);
 
     cb.endRenderPass();
+    frame.depthAtt->recordLayout(
+        vk::ImageLayout::eDepthStencilAttachmentOptimal, vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+        vk::PipelineStageFlagBits::eLateFragmentTests);
+    frame.velocityAtt->recordLayout(
+        vk::ImageLayout::eColorAttachmentOptimal, vk::AccessFlagBits::eColorAttachmentWrite,
+        vk::PipelineStageFlagBits::eColorAttachmentOutput);
 }
 }
\ No newline at end of file
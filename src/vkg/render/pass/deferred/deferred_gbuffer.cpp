@@ -4,7 +4,7 @@
 
 namespace vkg {
 auto DeferredPass::createGbufferPass(Device &device, SceneConfig sceneConfig) -> void {
-    GraphicsPipelineMaker maker(device.vkDevice());
+    GraphicsPipelineMaker maker(device);
 
     maker.layout(pipeDef.layout())
         .renderPass(*renderPass)
@@ -30,6 +30,7 @@ auto DeferredPass::createGbufferPass(Device &device, SceneConfig sceneConfig) ->
     maker.blendColorAttachment(false); //albedoAtt
     maker.blendColorAttachment(false); //pbrAtt
     maker.blendColorAttachment(false); //emissiveAtt
+    maker.blendColorAttachment(false); //velocityAtt
 
     maker
         .shader(
@@ -1,50 +1,36 @@
 #include "deferred.hpp"
 #include "common/quad_vert.hpp"
 #include "deferred/lit_frag.hpp"
-#include "deferred/lit_atmos_frag.hpp"
-#include "deferred/lit_csm_frag.hpp"
-#include "deferred/lit_atmos_csm_frag.hpp"
 
 namespace vkg {
 auto DeferredPass::createLightingPass(Device &device, SceneConfig sceneConfig) -> void {
-    GraphicsPipelineMaker maker(device.vkDevice());
+    litShader = std::make_unique<ShaderVariants>(
+        shader::deferred::lit_frag_span, std::vector<std::string>{"useAtmosphere", "useShadowMap"});
 
-    maker.layout(pipeDef.layout())
-        .renderPass(*renderPass)
-        .subpass(litPass)
-        .inputAssembly(vk::PrimitiveTopology::eTriangleList)
-        .polygonMode(vk::PolygonMode::eFill)
-        .cullMode(vk::CullModeFlagBits::eNone)
-        .frontFace(vk::FrontFace::eClockwise)
-        .depthTestEnable(false)
-        .viewport({})
-        .scissor({})
-        .dynamicState(vk::DynamicState::eViewport)
-        .dynamicState(vk::DynamicState::eScissor)
-        .dynamicState(vk::DynamicState::eLineWidth);
+    litPipes.factory([&device, sceneConfig, this](uint32_t variant) {
+        GraphicsPipelineMaker maker(device);
 
-    maker.blendColorAttachment(false);
+        maker.layout(pipeDef.layout())
+            .renderPass(*renderPass)
+            .subpass(litPass)
+            .inputAssembly(vk::PrimitiveTopology::eTriangleList)
+            .polygonMode(vk::PolygonMode::eFill)
+            .cullMode(vk::CullModeFlagBits::eNone)
+            .frontFace(vk::FrontFace::eClockwise)
+            .depthTestEnable(false)
+            .viewport({})
+            .scissor({})
+            .dynamicState(vk::DynamicState::eViewport)
+            .dynamicState(vk::DynamicState::eScissor)
+            .dynamicState(vk::DynamicState::eLineWidth);
 
-    maker.shader(vk::ShaderStageFlagBits::eVertex, Shader{shader::common::quad_vert_span})
-        .shader(
-            vk::ShaderStageFlagBits::eFragment, Shader{shader::deferred::lit_frag_span, sceneConfig.maxNumTextures});
-    litPipe = maker.createUnique();
-    device.name(*litPipe, "deferred lighting pipeline");
+        maker.blendColorAttachment(false);
 
-    maker.shader(
-        vk::ShaderStageFlagBits::eFragment, Shader{shader::deferred::lit_atmos_frag_span, sceneConfig.maxNumTextures});
-    litAtmosPipe = maker.createUnique();
-    device.name(*litAtmosPipe, "deferred lighting atmosphere pipeline");
-
-    maker.shader(
-        vk::ShaderStageFlagBits::eFragment, Shader{shader::deferred::lit_csm_frag_span, sceneConfig.maxNumTextures});
-    litCSMPipe = maker.createUnique();
-    device.name(*litCSMPipe, "deferred lighting shadowmap pipeline");
-
-    maker.shader(
-        vk::ShaderStageFlagBits::eFragment,
-        Shader{shader::deferred::lit_atmos_csm_frag_span, sceneConfig.maxNumTextures});
-    litAtmosCSMPipe = maker.createUnique();
-    device.name(*litAtmosCSMPipe, "deferred lighting atmosphere shadowmap pipeline");
+        maker.shader(vk::ShaderStageFlagBits::eVertex, Shader{shader::common::quad_vert_span})
+            .shader(vk::ShaderStageFlagBits::eFragment, litShader->shader(variant, sceneConfig.maxNumTextures));
+        auto pipe = maker.createUnique();
+        device.name(*pipe, toString("deferred lighting pipeline variant ", variant));
+        return pipe;
+    });
+}
 }
-}
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "deferred_setup.hpp"
 namespace vkg {
+DeferredSetupPass::DeferredSetupPass(CullStats &stats): stats{stats} {}
 
 void DeferredSetupPass::setup(vkg::PassBuilder &builder) {
     auto cam = builder
@@ -10,45 +11,97 @@ void DeferredSetupPass::setup(vkg::PassBuilder &builder) {
                        })
                    .out();
 
-    auto cull = builder
-                    .newPass<ComputeCullDrawCMD>(
-                        "CullDrawCMD",
-                        {
-                            cam.camFrustum,
-                            passIn.meshInstances,
-                            passIn.meshInstancesCount,
-                            passIn.sceneConfig,
-                            passIn.primitives,
-                            passIn.matrices,
-                            passIn.shadeModelCount,
-                        },
-                        std::set{
-                            ShadeModel::Unlit,
-                            ShadeModel::BRDF,
-                            ShadeModel::Reflective,
-                            ShadeModel::Refractive,
-                            ShadeModel::Transparent,
-                            ShadeModel::TransparentLines,
-                            ShadeModel::OpaqueLines,
-                        })
-                    .out();
+    auto &cullPass = builder.newPass<ComputeCullDrawCMD>(
+        "CullDrawCMD",
+        {
+            cam.camFrustum,
+            passIn.meshInstances,
+            passIn.meshInstancesCount,
+            passIn.sceneConfig,
+            passIn.primitives,
+            passIn.matrices,
+            passIn.shadeModelCount,
+        },
+        std::set{
+            ShadeModel::Unlit,
+            ShadeModel::BRDF,
+            ShadeModel::Reflective,
+            ShadeModel::Refractive,
+            ShadeModel::Transparent,
+            ShadeModel::TransparentLines,
+            ShadeModel::OpaqueLines,
+        },
+        &pyramid, &stats);
+    auto cull = cullPass.out();
+
+    auto prepass = builder
+                       .newPass<DepthPrepass>(
+                           "DepthPrepass",
+                           {
+                               passIn.backImg,
+                               passIn.renderExtent,
+                               cam.camBuffer,
+                               cull,
+                               passIn.positions,
+                               passIn.indices,
+                               passIn.matrices,
+                           })
+                       .out();
+
+    auto hiz = builder
+                   .newPass<HiZPass>(
+                       "HiZ",
+                       {
+                           passIn.camera,
+                           prepass.depth,
+                           cull.pyramid,
+                       },
+                       pyramid)
+                   .out();
+
+    auto retest = builder
+                      .newPass<CullRetestPass>(
+                          "CullRetest",
+                          {
+                              cull,
+                              passIn.meshInstancesCount,
+                              passIn.meshInstances,
+                              passIn.primitives,
+                              passIn.matrices,
+                              hiz.pyramid,
+                          },
+                          cullPass)
+                      .out();
+
+    auto clusters = builder
+                        .newPass<LightClusterPass>(
+                            "LightCluster",
+                            {
+                                passIn.camera,
+                                passIn.lighting,
+                                passIn.lights,
+                            })
+                        .out();
 
     auto deferred = builder
                         .newPass<DeferredPass>(
                             "DeferredShading",
                             {
-                                passIn.backImg,         cam.camBuffer,        cull,
-                                passIn.sceneConfig,     passIn.meshInstances, passIn.positions,
-                                passIn.normals,         passIn.uvs,           passIn.indices,
-                                passIn.matrices,        passIn.materials,     passIn.samplers,
-                                passIn.numValidSampler, passIn.lighting,      passIn.lights,
-                                passIn.atmosSetting,    passIn.atmosphere,    passIn.shadowMapSetting,
-                                passIn.shadowmap,
+                                passIn.backImg,          passIn.renderExtent,    prepass.depth,
+                                cam.camBuffer,           retest,                 passIn.sceneConfig,
+                                passIn.meshInstances,    passIn.positions,       passIn.normals,
+                                passIn.uvs,              passIn.indices,         passIn.matrices,
+                                passIn.prevMatrices,     passIn.temporalAA,      passIn.materials,
+                                passIn.samplers,         passIn.numValidSampler, passIn.lighting,
+                                passIn.lights,           passIn.atmosSetting,    passIn.atmosphere,
+                                passIn.shadowMapSetting, passIn.shadowmap,       clusters.lightClusters,
                             })
                         .out();
 
     passOut = {
         .backImg = deferred.backImg,
+        .depth = deferred.depth,
+        .velocity = deferred.velocity,
     };
 }
 }
@@ -1,9 +1,14 @@
 #pragma once
 #include "deferred.hpp"
+#include "depth_prepass.hpp"
+#include "vkg/render/pass/cull/hiz_pass.hpp"
+#include "vkg/render/pass/cull/cull_retest_pass.hpp"
+#include "vkg/render/pass/cull/light_cluster_pass.hpp"
 
 namespace vkg {
 struct DeferredSetupPassIn {
     FrameGraphResource<Texture *> backImg;
+    FrameGraphResource<vk::Extent2D> renderExtent;
     FrameGraphResource<Camera *> camera;
     FrameGraphResource<SceneConfig> sceneConfig;
     FrameGraphResource<BufferInfo> meshInstances;
@@ -14,6 +19,8 @@ struct DeferredSetupPassIn {
     FrameGraphResource<BufferInfo> indices;
     FrameGraphResource<BufferInfo> primitives;
     FrameGraphResource<BufferInfo> matrices;
+    FrameGraphResource<BufferInfo> prevMatrices;
+    FrameGraphResource<TemporalAASetting> temporalAA;
     FrameGraphResource<BufferInfo> materials;
     FrameGraphResource<std::span<vk::DescriptorImageInfo>> samplers;
     FrameGraphResource<uint32_t> numValidSampler;
@@ -30,9 +37,16 @@ struct DeferredSetupPassIn {
 };
 struct DeferredSetupPassOut {
     FrameGraphResource<Texture *> backImg;
+    FrameGraphResource<Texture *> depth;
+    FrameGraphResource<Texture *> velocity;
 };
 class DeferredSetupPass: public Pass<DeferredSetupPassIn, DeferredSetupPassOut> {
 public:
+    explicit DeferredSetupPass(CullStats &stats);
     void setup(PassBuilder &builder) override;
+
+private:
+    CullStats &stats;
+    DepthPyramid pyramid;
 };
 }
\ No newline at end of file
@@ -6,7 +6,7 @@
 
 namespace vkg {
 auto DeferredPass::createTransparentPass(Device &device, SceneConfig sceneConfig) -> void {
-    GraphicsPipelineMaker maker(device.vkDevice());
+    GraphicsPipelineMaker maker(device);
 
     maker.layout(pipeDef.layout())
         .renderPass(*renderPass)
@@ -64,7 +64,7 @@ auto DeferredPass::createTransparentPass(Device &device, SceneConfig sceneConfig
     device.name(*transLinePipe, "transparent line pipeline");
 }
 void DeferredPass::createCompositePass(Device &device, SceneConfig &sceneConfig) {
-    GraphicsPipelineMaker maker(device.vkDevice());
+    GraphicsPipelineMaker maker(device);
 
     maker.layout(pipeDef.layout())
         .renderPass(*renderPass)
@@ -4,7 +4,7 @@
 
 namespace vkg {
 auto DeferredPass::createUnlitPass(Device &device, SceneConfig sceneConfig) -> void {
-    GraphicsPipelineMaker maker(device.vkDevice());
+    GraphicsPipelineMaker maker(device);
 
     maker.layout(pipeDef.layout())
         .renderPass(*renderPass)
@@ -27,6 +27,7 @@ auto DeferredPass::createUnlitPass(Device &device, SceneConfig sceneConfig) -> v
         .dynamicState(vk::DynamicState::eLineWidth);
 
     maker.blendColorAttachment(false);
+    maker.blendColorAttachment(false); //velocityAtt
 
     maker
         .shader(
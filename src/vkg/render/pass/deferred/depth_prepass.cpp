@@ -0,0 +1,130 @@
+#include "depth_prepass.hpp"
+#include "deferred/depth_prepass_vert.hpp"
+
+namespace vkg {
+void DepthPrepass::setup(PassBuilder &builder) {
+    builder.read(passIn);
+    builder.read(passIn.matrices, AccessType::eVertexRead);
+    builder.read(passIn.cullCMD.cmdBuf, AccessType::eIndirectRead);
+    builder.read(passIn.cullCMD.countBuf, AccessType::eIndirectRead);
+    builder.read(passIn.cullCMD.instanceIds, AccessType::eVertexRead);
+    passOut.depth = builder.create<Texture *>("depth", AccessType::eDepthAttachment);
+}
+
+void DepthPrepass::compile(RenderContext &ctx, Resources &resources) {
+    auto *backImg = resources.get(passIn.backImg);
+    if(!init) {
+        init = true;
+
+        setDef.init(ctx.device);
+        pipeDef.depth(setDef);
+        pipeDef.init(ctx.device);
+        createRenderPass(ctx.device);
+        createPipeline(ctx.device);
+
+        descriptorPool = DescriptorPoolMaker().pipelineLayout(pipeDef, ctx.numFrames).createUnique(ctx.device);
+        frames.resize(ctx.numFrames);
+        for(auto &frame: frames)
+            frame.set = setDef.createSet(*descriptorPool);
+    }
+
+    auto &frame = frames[ctx.frameIndex];
+    if(backImg != frame.backImg) {
+        frame.backImg = backImg;
+        auto w = backImg->extent().width;
+        auto h = backImg->extent().height;
+        using vkUsage = vk::ImageUsageFlagBits;
+        frame.depth = image::make2DTex(
+            toString("depthAtt", ctx.frameIndex), ctx.device, w, h,
+            vkUsage::eDepthStencilAttachment | vkUsage::eInputAttachment | vkUsage::eSampled, vk::Format::eD32Sfloat,
+            vk::SampleCountFlagBits::e1, vk::ImageAspectFlagBits::eDepth);
+        auto view = frame.depth->imageView();
+        frame.framebuffer =
+            ctx.device.vkDevice().createFramebufferUnique({{}, *renderPass, 1, &view, w, h, 1});
+    }
+    resources.set(passOut.depth, frame.depth.get());
+
+    setDef.camera(resources.get(passIn.camBuffer));
+    setDef.matrices(resources.get(passIn.matrices));
+    setDef.instanceIds(resources.get(passIn.cullCMD.drawCMDs).instanceIds);
+    setDef.update(frame.set);
+}
+
+void DepthPrepass::execute(RenderContext &ctx, Resources &resources) {
+    auto &drawInfos = resources.get(passIn.cullCMD.drawCMDs);
+    auto &frame = frames[ctx.frameIndex];
+    auto cb = ctx.cb;
+
+    vk::ClearValue clearValue{vk::ClearDepthStencilValue{1.0f, 0}};
+    auto extent = resources.get(passIn.renderExtent);
+    cb.beginRenderPass(
+        vk::RenderPassBeginInfo{*renderPass, *frame.framebuffer, vk::Rect2D{{0, 0}, extent}, 1, &clearValue},
+        vk::SubpassContents::eInline);
+    cb.setViewport(0, vk::Viewport{0, 0, float(extent.width), float(extent.height), 0.0f, 1.0f});
+    cb.setScissor(0, vk::Rect2D{{0, 0}, extent});
+
+    ctx.device.begin(cb, "depth prepass");
+    cb.bindPipeline(vk::PipelineBindPoint::eGraphics, *pipe);
+    cb.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pipeDef.layout(), pipeDef.depth.set(), frame.set, nullptr);
+    auto bufInfo = resources.get(passIn.positions);
+    cb.bindVertexBuffers(0, bufInfo.buffer, bufInfo.offset);
+    bufInfo = resources.get(passIn.indices);
+    cb.bindIndexBuffer(bufInfo.buffer, bufInfo.offset, vk::IndexType::eUint32);
+    // the shade models of the gbuffer subpass, others are drawn after the lighting reads the depth.
+    for(auto shadeModel: {ShadeModel::BRDF, ShadeModel::Reflective, ShadeModel::Refractive}) {
+        auto drawInfo = drawInfos.cmdsPerShadeModel[0][value(shadeModel)];
+        if(drawInfo.maxCount == 0) continue;
+        cb.drawIndexedIndirectCount(
+            drawInfo.cmdBuf.buffer, drawInfo.cmdBuf.offset, drawInfo.countBuf.buffer, drawInfo.countBuf.offset,
+            drawInfo.maxCount, drawInfo.stride);
+    }
+    ctx.device.end(cb);
+
+    cb.endRenderPass();
+    frame.depth->recordLayout(
+        vk::ImageLayout::eDepthStencilAttachmentOptimal, vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+        vk::PipelineStageFlagBits::eLateFragmentTests);
+}
+
+auto DepthPrepass::createRenderPass(Device &device) -> void {
+    RenderPassMaker maker;
+    auto depth = maker.attachment(vk::Format::eD32Sfloat)
+                     .samples(vk::SampleCountFlagBits::e1)
+                     .loadOp(vk::AttachmentLoadOp::eClear)
+                     .storeOp(vk::AttachmentStoreOp::eStore)
+                     .stencilLoadOp(vk::AttachmentLoadOp::eDontCare)
+                     .stencilStoreOp(vk::AttachmentStoreOp::eDontCare)
+                     .initialLayout(vk::ImageLayout::eUndefined)
+                     .finalLayout(vk::ImageLayout::eDepthStencilAttachmentOptimal)
+                     .index();
+    auto subpass = maker.subpass(vk::PipelineBindPoint::eGraphics).depthStencil(depth).index();
+    maker.dependency(VK_SUBPASS_EXTERNAL, subpass)
+        .srcStage(vk::PipelineStageFlagBits::eBottomOfPipe)
+        .dstStage(vk::PipelineStageFlagBits::eEarlyFragmentTests)
+        .srcAccess(vk::AccessFlagBits::eMemoryRead)
+        .dstAccess(vk::AccessFlagBits::eDepthStencilAttachmentWrite);
+    renderPass = maker.createUnique(device);
+}
+
+auto DepthPrepass::createPipeline(Device &device) -> void {
+    GraphicsPipelineMaker maker(device);
+    maker.layout(pipeDef.layout())
+        .renderPass(*renderPass)
+        .subpass(0)
+        .vertexInputAuto({{.stride = sizeof(Vertex::Position), .attributes = {{vk::Format::eR32G32B32Sfloat}}}})
+        .inputAssembly(vk::PrimitiveTopology::eTriangleList)
+        .polygonMode(vk::PolygonMode::eFill)
+        .cullMode(vk::CullModeFlagBits::eBack)
+        .frontFace(vk::FrontFace::eCounterClockwise)
+        .depthTestEnable(true)
+        .depthWriteEnable(true)
+        .depthCompareOp(vk::CompareOp::eLessOrEqual)
+        .viewport({})
+        .scissor({})
+        .dynamicState(vk::DynamicState::eViewport)
+        .dynamicState(vk::DynamicState::eScissor)
+        .shader(vk::ShaderStageFlagBits::eVertex, Shader{shader::deferred::depth_prepass_vert_span});
+    pipe = maker.createUnique();
+    device.name(*pipe, "depth prepass pipeline");
+}
+}
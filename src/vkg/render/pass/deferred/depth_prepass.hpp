@@ -0,0 +1,59 @@
+#pragma once
+#include "vkg/base/base.hpp"
+#include "vkg/render/graph/frame_graph.hpp"
+#include "vkg/render/pass/cull/compute_cull_drawcmd.hpp"
+#include "vkg/render/model/vertex.hpp"
+
+namespace vkg {
+struct DepthPrepassIn {
+    /** the depth buffer is sized like it. */
+    FrameGraphResource<Texture *> backImg;
+    FrameGraphResource<vk::Extent2D> renderExtent;
+    FrameGraphResource<BufferInfo> camBuffer;
+    ComputeCullDrawCMDPassOut cullCMD;
+    FrameGraphResource<BufferInfo> positions;
+    FrameGraphResource<BufferInfo> indices;
+    FrameGraphResource<BufferInfo> matrices;
+};
+struct DepthPrepassOut {
+    FrameGraphResource<Texture *> depth;
+};
+
+/**
+ * Draws the depth of the gbuffer instances the first phase of the occlusion cull found visible. The
+ * depth pyramid of the second phase is built from it, and the `DeferredPass` renders on top of it.
+ */
+class DepthPrepass: public Pass<DepthPrepassIn, DepthPrepassOut> {
+public:
+    void setup(PassBuilder &builder) override;
+    void compile(RenderContext &ctx, Resources &resources) override;
+    void execute(RenderContext &ctx, Resources &resources) override;
+
+private:
+    auto createRenderPass(Device &device) -> void;
+    auto createPipeline(Device &device) -> void;
+
+    struct DepthSetDef: DescriptorSetDef {
+        __buffer__(camera, vkStage::eVertex);
+        __buffer__(matrices, vkStage::eVertex);
+        __buffer__(instanceIds, vkStage::eVertex);
+    } setDef;
+    struct DepthPipeDef: PipelineLayoutDef {
+        __set__(depth, DepthSetDef);
+    } pipeDef;
+
+    vk::UniqueRenderPass renderPass;
+    vk::UniquePipeline pipe;
+    vk::UniqueDescriptorPool descriptorPool;
+
+    struct FrameResource {
+        vk::DescriptorSet set;
+        Texture *backImg{nullptr};
+        std::unique_ptr<Texture> depth;
+        vk::UniqueFramebuffer framebuffer;
+    };
+    std::vector<FrameResource> frames;
+
+    bool init{false};
+};
+}
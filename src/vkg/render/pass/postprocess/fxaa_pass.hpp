@@ -1,6 +1,7 @@
 #pragma once
 #include "screen_pass.hpp"
 #include "postprocess/fxaa_frag.hpp"
+#include <functional>
 
 namespace vkg {
 struct FxaaPushConstant {
@@ -10,11 +11,17 @@ struct FxaaPushConstant {
 };
 class FxaaPass: public ScreenPass<FxaaPushConstant> {
 public:
-  FxaaPass(): ScreenPass(shader::postprocess::fxaa_frag_span) {}
+  /** `replaced` tells if another anti-aliasing, e.g. TAA, already ran this frame. */
+  explicit FxaaPass(std::function<bool()> replaced = [] { return false; })
+    : ScreenPass(shader::postprocess::fxaa_frag_span), replaced(std::move(replaced)) {}
 
 protected:
   void updatePushConstant() override{
 
   };
+  auto bypass() -> bool override { return replaced(); }
+
+private:
+  std::function<bool()> replaced;
 };
 }
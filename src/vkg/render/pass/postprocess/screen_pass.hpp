@@ -14,15 +14,30 @@ struct ScreenPassOut {
 template<typename PushConstant = std::monostate>
 class ScreenPass: public Pass<ScreenPassIn, ScreenPassOut> {
 public:
-    explicit ScreenPass(const std::span<const uint32_t> &opcodes): opcodes(opcodes) {}
+    /**
+     * @param format format of the output, which is a transient texture of the frame graph's transient extent.
+     */
+    explicit ScreenPass(
+        const std::span<const uint32_t> &opcodes, vk::Format format = vk::Format::eR16G16B16A16Sfloat)
+        : opcodes(opcodes), format(format) {}
     void setup(PassBuilder &builder) override {
         builder.read(passIn.img);
+        using vkUsage = vk::ImageUsageFlagBits;
         passOut = {
-            .img = builder.create<Texture *>("img"),
+            .img = builder.createTexture(
+                "img", {.format = format,
+                        .usage = vkUsage::eSampled | vkUsage::eStorage | vkUsage::eTransferSrc |
+                                 vkUsage::eTransferDst | vkUsage::eColorAttachment}),
         };
     }
     void compile(RenderContext &ctx, Resources &resources) override {
         auto *img = resources.get(passIn.img);
+        auto *toImg = resources.get(passOut.img);
+        bypassed = bypass();
+        if(bypassed) {
+            resources.set(passOut.img, img);
+            return;
+        }
         if(!init) {
             init = true;
 
@@ -32,7 +47,7 @@ public:
 
             {
                 RenderPassMaker maker;
-                auto backImg = maker.attachment(img->format())
+                auto backImg = maker.attachment(format)
                                    .samples(vk::SampleCountFlagBits::e1)
                                    .loadOp(vk::AttachmentLoadOp::eClear)
                                    .storeOp(vk::AttachmentStoreOp::eStore)
@@ -93,17 +108,11 @@ public:
         }
         auto &frame = frames[ctx.frameIndex];
 
-        if(img != frame.img) {
-            frame.img = img;
-            auto w = img->extent().width;
-            auto h = img->extent().height;
-            using vkUsage = vk::ImageUsageFlagBits;
-            frame.toImg = image::make2DTex(
-                "toImg", ctx.device, w, h,
-                vkUsage::eSampled | vkUsage::eStorage | vkUsage::eTransferSrc | vkUsage ::eTransferDst |
-                    vkUsage ::eColorAttachment,
-                img->format());
-            std::vector<vk::ImageView> attachments = {frame.toImg->imageView()};
+        if(toImg != frame.toImg) {
+            frame.toImg = toImg;
+            auto w = toImg->extent().width;
+            auto h = toImg->extent().height;
+            std::vector<vk::ImageView> attachments = {toImg->imageView()};
 
             vk::FramebufferCreateInfo info{{}, *renderPass, uint32_t(attachments.size()), attachments.data(), w, h, 1};
 
@@ -113,9 +122,10 @@ public:
         setDef.image(*img);
         setDef.update(frame.set);
 
-        resources.set(passOut.img, frame.toImg.get());
+        resources.set(passOut.img, toImg);
     }
     void execute(RenderContext &ctx, Resources &resources) override {
+        if(bypassed) return;
         auto &frame = frames[ctx.frameIndex];
         auto *img = resources.get(passIn.img);
 
@@ -160,6 +170,8 @@ public:
 
 protected:
     virtual void updatePushConstant(){};
+    /** passes the image through untouched this frame if true. */
+    virtual auto bypass() -> bool { return false; }
     PushConstant pushConstant;
 
 private:
@@ -179,13 +191,14 @@ private:
 
     struct FrameResource {
         vk::DescriptorSet set;
-        std::unique_ptr<Texture> toImg;
-        Texture *img{};
+        Texture *toImg{};
         vk::UniqueFramebuffer framebuffer;
     };
     std::vector<FrameResource> frames;
+    bool bypassed{false};
     bool init{false};
 
     std::span<const uint32_t> opcodes;
+    vk::Format format;
 };
 }
@@ -0,0 +1,227 @@
+#pragma once
+#include "vkg/base/base.hpp"
+#include "vkg/render/graph/frame_graph.hpp"
+#include "vkg/render/model/camera.hpp"
+#include "vkg/render/model/temporal_aa.hpp"
+#include "postprocess/taa_comp.hpp"
+
+namespace vkg {
+struct TemporalAAPassIn {
+    FrameGraphResource<Texture *> img;
+    FrameGraphResource<Texture *> depth;
+    FrameGraphResource<Texture *> velocity;
+    FrameGraphResource<Camera *> camera;
+    /** part of `img` that was rendered to, from its origin. */
+    FrameGraphResource<vk::Extent2D> renderExtent;
+    FrameGraphResource<TemporalAASetting> setting;
+};
+struct TemporalAAPassOut {
+    FrameGraphResource<Texture *> img;
+};
+/**
+ * Resolves the jittered image against the history of the previous frames at render resolution. The
+ * image is passed through untouched while temporal anti-aliasing is disabled.
+ */
+class TemporalAAPass: public Pass<TemporalAAPassIn, TemporalAAPassOut> {
+public:
+    void setup(PassBuilder &builder) override {
+        builder.read(passIn);
+        passOut = {
+            .img = builder.create<Texture *>("img"),
+        };
+    }
+    void compile(RenderContext &ctx, Resources &resources) override {
+        auto &setting = resources.get(passIn.setting);
+        auto *img = resources.get(passIn.img);
+        resolve = setting.isEnabled();
+        if(!resolve) {
+            // the history is stale once re-enabled.
+            hasHistory = false;
+            resources.set(passOut.img, img);
+            return;
+        }
+        // the history written by the previous frame, submitted to another queue, is read.
+        afterPreviousFrame();
+        if(!init) {
+            init = true;
+
+            setDef.init(ctx.device);
+            pipeDef.set(setDef);
+            pipeDef.init(ctx.device);
+
+            pipe = ComputePipelineMaker(ctx.device)
+                       .layout(pipeDef.layout())
+                       .shader(Shader{shader::postprocess::taa_comp_span, local_size_x, local_size_y, 1})
+                       .createUnique();
+
+            pointSampler = ctx.device.sampler(
+                {{},
+                 vk::Filter::eNearest,
+                 vk::Filter::eNearest,
+                 vk::SamplerMipmapMode::eNearest,
+                 vk::SamplerAddressMode::eClampToEdge,
+                 vk::SamplerAddressMode::eClampToEdge,
+                 vk::SamplerAddressMode::eClampToEdge});
+            linearSampler = ctx.device.sampler(
+                {{},
+                 vk::Filter::eLinear,
+                 vk::Filter::eLinear,
+                 vk::SamplerMipmapMode::eNearest,
+                 vk::SamplerAddressMode::eClampToEdge,
+                 vk::SamplerAddressMode::eClampToEdge,
+                 vk::SamplerAddressMode::eClampToEdge});
+
+            descriptorPool = DescriptorPoolMaker().pipelineLayout(pipeDef, ctx.numFrames).createUnique(ctx.device);
+
+            frames.resize(ctx.numFrames);
+            for(auto &frame: frames)
+                frame.set = setDef.createSet(*descriptorPool);
+        }
+        auto &frame = frames[ctx.frameIndex];
+        auto w = img->extent().width, h = img->extent().height;
+        using vkUsage = vk::ImageUsageFlagBits;
+
+        if(!history[0] || history[0]->extent().width != w || history[0]->extent().height != h) {
+            // the other frames in flight may still read the history.
+            if(history[0]) ctx.device.vkDevice().waitIdle();
+            for(auto i = 0u; i < 2; ++i)
+                history[i] = image::make2DTex(
+                    toString("taaHistory", i), ctx.device, w, h, vkUsage::eSampled | vkUsage::eStorage,
+                    img->format());
+            hasHistory = false;
+        }
+        if(img != frame.img) {
+            frame.img = img;
+            frame.toImg = image::make2DTex(
+                "taaImg", ctx.device, w, h,
+                vkUsage::eSampled | vkUsage::eStorage | vkUsage::eTransferSrc | vkUsage::eTransferDst |
+                    vkUsage::eColorAttachment,
+                img->format());
+            frame.toImg->setSampler({{}, vk::Filter::eLinear, vk::Filter::eLinear, vk::SamplerMipmapMode::eLinear});
+        }
+
+        if(setting.historyVersion() != historyVersion) {
+            historyVersion = setting.historyVersion();
+            hasHistory = false;
+        }
+        auto reset = !hasHistory;
+        hasHistory = true;
+        historyIdx = 1 - historyIdx;
+        auto &prevHistory = *history[1 - historyIdx], &curHistory = *history[historyIdx];
+
+        frame.depth = resources.get(passIn.depth);
+        frame.velocity = resources.get(passIn.velocity);
+        setDef.src(**pointSampler, img->imageView());
+        setDef.depth(**pointSampler, frame.depth->imageView());
+        setDef.velocity(**pointSampler, frame.velocity->imageView());
+        setDef.history(**linearSampler, prevHistory.imageView(), vk::ImageLayout::eGeneral);
+        setDef.dst(frame.toImg->imageView());
+        setDef.outHistory(curHistory.imageView());
+        setDef.update(frame.set);
+
+        auto *camera = resources.get(passIn.camera);
+        auto viewProj = camera->unjitteredProj() * camera->view();
+        auto renderExtent = resources.get(passIn.renderExtent);
+        pushConstant = {
+            .reproject = prevViewProj * glm::inverse(viewProj),
+            .extent = {renderExtent.width, renderExtent.height},
+            .prevExtent = reset ? glm::uvec2{renderExtent.width, renderExtent.height} : prevExtent,
+            .feedback = glm::clamp(setting.feedback(), 0.f, 1.f),
+            .reset = reset ? 1u : 0u,
+        };
+        prevViewProj = viewProj;
+        prevExtent = pushConstant.extent;
+
+        resources.set(passOut.img, frame.toImg.get());
+    }
+    void execute(RenderContext &ctx, Resources &resources) override {
+        if(!resolve) return;
+        auto &frame = frames[ctx.frameIndex];
+
+        auto cb = ctx.cb;
+        ctx.device.begin(cb, name);
+
+        image::transitTo(
+            cb, *frame.img, vk::ImageLayout::eShaderReadOnlyOptimal, vk::AccessFlagBits::eShaderRead,
+            vk::PipelineStageFlagBits::eComputeShader);
+        image::transitTo(
+            cb, *frame.velocity, vk::ImageLayout::eShaderReadOnlyOptimal, vk::AccessFlagBits::eShaderRead,
+            vk::PipelineStageFlagBits::eComputeShader);
+        auto depthStage = frame.depth->stageFlag();
+        auto depthBarrier = frame.depth->barrier(
+            vk::ImageLayout::eShaderReadOnlyOptimal, vk::AccessFlagBits::eShaderRead,
+            vk::PipelineStageFlagBits::eComputeShader, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+            vk::ImageAspectFlagBits::eDepth);
+        cb.pipelineBarrier(depthStage, vk::PipelineStageFlagBits::eComputeShader, {}, nullptr, nullptr, depthBarrier);
+        image::transitTo(
+            cb, *history[1 - historyIdx], vk::ImageLayout::eGeneral, vk::AccessFlagBits::eShaderRead,
+            vk::PipelineStageFlagBits::eComputeShader);
+        image::transitTo(
+            cb, *history[historyIdx], vk::ImageLayout::eGeneral, vk::AccessFlagBits::eShaderWrite,
+            vk::PipelineStageFlagBits::eComputeShader);
+        image::transitTo(
+            cb, *frame.toImg, vk::ImageLayout::eGeneral, vk::AccessFlagBits::eShaderWrite,
+            vk::PipelineStageFlagBits::eComputeShader);
+
+        cb.bindPipeline(vk::PipelineBindPoint::eCompute, *pipe);
+        cb.bindDescriptorSets(vk::PipelineBindPoint::eCompute, pipeDef.layout(), pipeDef.set.set(), frame.set, nullptr);
+        cb.pushConstants<PushConstant>(pipeDef.layout(), vk::ShaderStageFlagBits::eCompute, 0, pushConstant);
+        auto dx = (pushConstant.extent.x + local_size_x - 1) / local_size_x;
+        auto dy = (pushConstant.extent.y + local_size_y - 1) / local_size_y;
+        cb.dispatch(dx, dy, 1);
+
+        ctx.device.end(cb);
+    }
+
+private:
+    struct TemporalAASetDef: DescriptorSetDef {
+        __sampler2D__(src, vkStage::eCompute);
+        __sampler2D__(depth, vkStage::eCompute);
+        __sampler2D__(velocity, vkStage::eCompute);
+        __sampler2D__(history, vkStage::eCompute);
+        __image2D__(dst, vkStage::eCompute);
+        __image2D__(outHistory, vkStage::eCompute);
+    } setDef;
+
+    struct PushConstant {
+        glm::mat4 reproject;
+        glm::uvec2 extent;
+        glm::uvec2 prevExtent;
+        float feedback;
+        uint32_t reset;
+    } pushConstant;
+
+    struct TemporalAAPipeDef: PipelineLayoutDef {
+        __push_constant__(constant, vkStage::eCompute, PushConstant);
+        __set__(set, TemporalAASetDef);
+    } pipeDef;
+
+    vk::UniquePipeline pipe;
+    const uint32_t local_size_x = 8;
+    const uint32_t local_size_y = 8;
+
+    vk::UniqueDescriptorPool descriptorPool;
+    std::shared_ptr<vk::UniqueSampler> pointSampler, linearSampler;
+
+    struct FrameResource {
+        vk::DescriptorSet set;
+        Texture *img{nullptr}, *depth{nullptr}, *velocity{nullptr};
+        std::unique_ptr<Texture> toImg;
+    };
+    std::vector<FrameResource> frames;
+
+    /**
+     * written alternately, each frame reads the one written by the previous frame and overwrites the one the
+     * frame before read, so the frames are ordered by waiting on the previous one.
+     */
+    std::array<std::unique_ptr<Texture>, 2> history;
+    uint32_t historyIdx{0};
+    bool hasHistory{false};
+    uint64_t historyVersion{0};
+    glm::mat4 prevViewProj{1};
+    glm::uvec2 prevExtent{0};
+
+    bool resolve{false};
+    bool init{false};
+};
+}
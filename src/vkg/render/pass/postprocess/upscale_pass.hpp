@@ -0,0 +1,135 @@
+#pragma once
+#include "vkg/base/base.hpp"
+#include "vkg/render/graph/frame_graph.hpp"
+#include "vkg/render/model/dynamic_resolution.hpp"
+#include "postprocess/upscale_comp.hpp"
+
+namespace vkg {
+struct UpscalePassIn {
+    FrameGraphResource<Texture *> img;
+    /** part of `img` that was rendered to, from its origin. */
+    FrameGraphResource<vk::Extent2D> renderExtent;
+    FrameGraphResource<DynamicResolutionSetting> setting;
+};
+struct UpscalePassOut {
+    FrameGraphResource<Texture *> img;
+};
+/**
+ * Upscales the rendered part of the image to an image of the same size with a sharpened bilinear
+ * filter. The image is passed through untouched when it was rendered at full size.
+ */
+class UpscalePass: public Pass<UpscalePassIn, UpscalePassOut> {
+public:
+    void setup(PassBuilder &builder) override {
+        builder.read(passIn);
+        passOut = {
+            .img = builder.create<Texture *>("img"),
+        };
+    }
+    void compile(RenderContext &ctx, Resources &resources) override {
+        if(!init) {
+            init = true;
+
+            setDef.init(ctx.device);
+            pipeDef.set(setDef);
+            pipeDef.init(ctx.device);
+
+            pipe = ComputePipelineMaker(ctx.device)
+                       .layout(pipeDef.layout())
+                       .shader(Shader{shader::postprocess::upscale_comp_span, local_size_x, local_size_y, 1})
+                       .createUnique();
+
+            descriptorPool = DescriptorPoolMaker().pipelineLayout(pipeDef, ctx.numFrames).createUnique(ctx.device);
+
+            frames.resize(ctx.numFrames);
+            for(auto &frame: frames)
+                frame.set = setDef.createSet(*descriptorPool);
+        }
+        auto &frame = frames[ctx.frameIndex];
+
+        auto *img = resources.get(passIn.img);
+        auto renderExtent = resources.get(passIn.renderExtent);
+        upscale = renderExtent != vk::Extent2D{img->extent().width, img->extent().height};
+        if(!upscale) {
+            resources.set(passOut.img, img);
+            return;
+        }
+
+        if(img != frame.img) {
+            frame.img = img;
+            using vkUsage = vk::ImageUsageFlagBits;
+            frame.toImg = image::make2DTex(
+                "upscaledImg", ctx.device, img->extent().width, img->extent().height,
+                vkUsage::eSampled | vkUsage::eStorage | vkUsage::eTransferSrc | vkUsage::eTransferDst |
+                    vkUsage::eColorAttachment,
+                img->format());
+            frame.toImg->setSampler({{}, vk::Filter::eLinear, vk::Filter::eLinear, vk::SamplerMipmapMode::eLinear});
+            setDef.src(*img);
+            setDef.dst(frame.toImg->imageView());
+            setDef.update(frame.set);
+        }
+
+        pushConstant = {
+            .srcExtent = {renderExtent.width, renderExtent.height},
+            .dstExtent = {img->extent().width, img->extent().height},
+            .sharpness = resources.get(passIn.setting).sharpness(),
+        };
+        resources.set(passOut.img, frame.toImg.get());
+    }
+    void execute(RenderContext &ctx, Resources &resources) override {
+        if(!upscale) return;
+        auto &frame = frames[ctx.frameIndex];
+
+        auto cb = ctx.cb;
+        ctx.device.begin(cb, name);
+
+        image::transitTo(
+            cb, *frame.img, vk::ImageLayout::eShaderReadOnlyOptimal, vk::AccessFlagBits::eShaderRead,
+            vk::PipelineStageFlagBits::eComputeShader);
+        image::transitTo(
+            cb, *frame.toImg, vk::ImageLayout::eGeneral, vk::AccessFlagBits::eShaderWrite,
+            vk::PipelineStageFlagBits::eComputeShader);
+
+        cb.bindPipeline(vk::PipelineBindPoint::eCompute, *pipe);
+        cb.bindDescriptorSets(vk::PipelineBindPoint::eCompute, pipeDef.layout(), pipeDef.set.set(), frame.set, nullptr);
+        cb.pushConstants<PushConstant>(pipeDef.layout(), vk::ShaderStageFlagBits::eCompute, 0, pushConstant);
+        auto dx = (pushConstant.dstExtent.x + local_size_x - 1) / local_size_x;
+        auto dy = (pushConstant.dstExtent.y + local_size_y - 1) / local_size_y;
+        cb.dispatch(dx, dy, 1);
+
+        ctx.device.end(cb);
+    }
+
+private:
+    struct UpscaleSetDef: DescriptorSetDef {
+        __sampler2D__(src, vkStage::eCompute);
+        __image2D__(dst, vkStage::eCompute);
+    } setDef;
+
+    struct PushConstant {
+        glm::uvec2 srcExtent;
+        glm::uvec2 dstExtent;
+        float sharpness;
+    } pushConstant;
+
+    struct UpscalePipeDef: PipelineLayoutDef {
+        __push_constant__(constant, vkStage::eCompute, PushConstant);
+        __set__(set, UpscaleSetDef);
+    } pipeDef;
+
+    vk::UniquePipeline pipe;
+    const uint32_t local_size_x = 8;
+    const uint32_t local_size_y = 8;
+
+    vk::UniqueDescriptorPool descriptorPool;
+
+    struct FrameResource {
+        vk::DescriptorSet set;
+        Texture *img{nullptr};
+        std::unique_ptr<Texture> toImg;
+    };
+    std::vector<FrameResource> frames;
+    bool upscale{false};
+    bool init{false};
+};
+}
@@ -4,10 +4,14 @@
 
 namespace vkg {
 void CompTLASPass::setup(PassBuilder &builder) {
+  builder.queue(QueueType::eCompute);
   builder.read(passIn);
+  builder.read(passIn.meshInstances, AccessType::eComputeRead);
+  builder.read(passIn.primitives, AccessType::eComputeRead);
+  builder.read(passIn.matrices, AccessType::eComputeRead);
   passOut = {
     .tlasCount = builder.create<uint32_t>("tlasInstanceCount"),
-    .tlas = builder.create<BufferInfo>("tlasInstances"),
+    .tlas = builder.create<BufferInfo>("tlasInstances", AccessType::eComputeStorageWrite),
   };
 }
 void CompTLASPass::compile(RenderContext &ctx, Resources &resources) {
@@ -97,14 +101,6 @@ void CompTLASPass::execute(RenderContext &ctx, Resources &resources) {
   cb.pushConstants<PushConstant>(
     pipeDef.layout(), vk::ShaderStageFlagBits::eCompute, 0, pushConstant);
   cb.dispatch(dx, dy, dz);
-
-  cb.pipelineBarrier(
-    vk::PipelineStageFlagBits::eComputeShader,
-    vk::PipelineStageFlagBits::eAccelerationStructureBuildNV, {},
-    vk::MemoryBarrier{
-      vk::AccessFlagBits::eShaderWrite,
-      vk::AccessFlagBits::eAccelerationStructureWriteNV},
-    nullptr, nullptr);
   ctx.device.end(cb);
 }
 }
\ No newline at end of file
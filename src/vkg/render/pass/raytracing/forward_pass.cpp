@@ -28,6 +28,9 @@ void ForwardPass::setup(vkg::PassBuilder &builder) {
                   .out();
 
   builder.read(cullPassOut);
+  builder.read(cullPassOut.cmdBuf, AccessType::eIndirectRead);
+  builder.read(cullPassOut.countBuf, AccessType::eIndirectRead);
+  builder.read(cullPassOut.instanceIds, AccessType::eVertexRead);
   builder.read(passIn.traceRays);
   builder.read(passIn.camFrustum.camBuffer);
   builder.read(passIn.sceneConfig);
@@ -37,7 +40,7 @@ void ForwardPass::setup(vkg::PassBuilder &builder) {
   builder.read(passIn.normals);
   builder.read(passIn.uvs);
   builder.read(passIn.indices);
-  builder.read(passIn.matrices);
+  builder.read(passIn.matrices, AccessType::eVertexRead);
   builder.read(passIn.materials);
   builder.read(passIn.samplers);
   builder.read(passIn.numValidSampler);
@@ -53,7 +56,8 @@ void ForwardPass::compile(vkg::RenderContext &ctx, vkg::Resources &resources) {
     init = true;
 
     auto sceneConfig = resources.get(passIn.sceneConfig);
-    sceneSetDef.textures.descriptorCount() = sceneConfig.maxNumTextures;
+    sceneSetDef.textures.array(
+      sceneConfig.maxNumTextures, resources.device.supported().descriptorIndexing);
     sceneSetDef.init(resources.device);
     transSetDef.init(resources.device);
     pipeDef.scene(sceneSetDef);
@@ -80,6 +84,7 @@ void ForwardPass::compile(vkg::RenderContext &ctx, vkg::Resources &resources) {
         ctx.device.name(frames[i].sceneSet, name + toString("sceneSet", i));
         sceneSetDef.textures(0, uint32_t(samplers.size()), samplers.data());
         sceneSetDef.update(frames[i].sceneSet);
+        frames[i].lastNumValidSampler = numValidSampler;
       }
     }
   }
@@ -122,6 +127,7 @@ void ForwardPass::compile(vkg::RenderContext &ctx, vkg::Resources &resources) {
   sceneSetDef.primitives(resources.get(passIn.primitives));
   sceneSetDef.matrices(resources.get(passIn.matrices));
   sceneSetDef.materials(resources.get(passIn.materials));
+  sceneSetDef.instanceIds(resources.get(cullPassOut.drawCMDs).instanceIds);
   sceneSetDef.update(frame.sceneSet);
 
   transSetDef.color(frame.transColorAtt->imageView());
@@ -210,7 +216,7 @@ void ForwardPass::createRenderPass(Device &device, vk::Format format) {
   renderPass = maker.createUnique(device.vkDevice());
 }
 void ForwardPass::createCopyDepthPass(Device &device, SceneConfig &sceneConfig) {
-  GraphicsPipelineMaker maker(device.vkDevice());
+  GraphicsPipelineMaker maker(device);
 
   maker.layout(pipeDef.layout())
     .renderPass(*renderPass)
@@ -237,7 +243,7 @@ void ForwardPass::createCopyDepthPass(Device &device, SceneConfig &sceneConfig)
   device.name(*copyDepthPipe, "copy depth pipe");
 }
 void ForwardPass::createOpaquePass(Device &device, SceneConfig &sceneConfig) {
-  GraphicsPipelineMaker maker(device.vkDevice());
+  GraphicsPipelineMaker maker(device);
 
   maker.layout(pipeDef.layout())
     .renderPass(*renderPass)
@@ -273,7 +279,7 @@ void ForwardPass::createOpaquePass(Device &device, SceneConfig &sceneConfig) {
   device.name(*opaqueLinesPipe, "opaqueLinesPipe");
 }
 void ForwardPass::createTransparentPass(Device &device, SceneConfig &sceneConfig) {
-  GraphicsPipelineMaker maker(device.vkDevice());
+  GraphicsPipelineMaker maker(device);
 
   maker.layout(pipeDef.layout())
     .renderPass(*renderPass)
@@ -334,7 +340,7 @@ void ForwardPass::createTransparentPass(Device &device, SceneConfig &sceneConfig
   device.name(*transparentLinesPipe, "transparentLinesPipe");
 }
 void ForwardPass::createCompositePass(Device &device, SceneConfig &sceneConfig) {
-  GraphicsPipelineMaker maker(device.vkDevice());
+  GraphicsPipelineMaker maker(device);
 
   maker.layout(pipeDef.layout())
     .renderPass(*renderPass)
@@ -370,7 +376,7 @@ void ForwardPass::createCompositePass(Device &device, SceneConfig &sceneConfig)
 }
 
 void ForwardPass::execute(vkg::RenderContext &ctx, vkg::Resources &resources) {
-  auto drawInfos = resources.get(cullPassOut.drawCMDs);
+  auto &drawInfos = resources.get(cullPassOut.drawCMDs);
   auto &frame = frames[ctx.frameIndex];
 
   auto cb = ctx.cb;
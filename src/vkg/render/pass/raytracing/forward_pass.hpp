@@ -53,6 +53,7 @@ private:
     __buffer__(matrices, vkStage::eVertex);
     __buffer__(materials, vkStage::eFragment);
     __sampler2D__(textures, vkStage::eFragment);
+    __buffer__(instanceIds, vkStage::eVertex);
   } sceneSetDef;
 
   struct TransparentSetDef: DescriptorSetDef {
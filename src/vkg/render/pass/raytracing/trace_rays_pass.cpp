@@ -14,6 +14,7 @@
 namespace vkg {
 void RayTracingPass::setup(PassBuilder &builder) {
   builder.read(passIn);
+  builder.read(passIn.compTlasPassOut.tlas, AccessType::eAccelerationStructureBuildRead);
   passOut = {
     .backImg = builder.write(passIn.backImg),
     .depthImg = builder.create<Texture *>("depthImg"),
@@ -28,7 +29,8 @@ void RayTracingPass::compile(RenderContext &ctx, Resources &resources) {
     init = true;
 
     auto sceneConfig = resources.get(passIn.sceneConfig);
-    rtSetDef.textures.descriptorCount() = sceneConfig.maxNumTextures;
+    rtSetDef.textures.array(
+      sceneConfig.maxNumTextures, resources.device.supported().descriptorIndexing);
     rtSetDef.init(ctx.device);
     atmosphereSetDef.init(ctx.device);
     pipeDef.rt(rtSetDef);
@@ -86,6 +88,7 @@ void RayTracingPass::compile(RenderContext &ctx, Resources &resources) {
       frame.atmosphereSet = atmosphereSetDef.createSet(*descriptorPool);
       rtSetDef.textures(0, uint32_t(samplers.size()), samplers.data());
       rtSetDef.update(frame.rtSet);
+      frame.lastNumValidSampler = numValidSampler;
     }
   }
   auto &frame = frames[ctx.frameIndex];
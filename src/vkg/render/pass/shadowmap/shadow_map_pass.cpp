@@ -1,9 +1,14 @@
 #include "shadow_map_pass.hpp"
-#include "vkg/render/model/aabb.hpp"
 #include "vkg/render/model/vertex.hpp"
 #include "deferred/csm/csm_vert.hpp"
+#include "deferred/csm/csm_multiview_vert.hpp"
 
 namespace vkg {
+/** whether every cascade is rendered as a view of one multiview render pass. */
+static auto multiviewCascades(Device &device, const ShadowMapSetting &setting) -> bool {
+    return device.supported().multiview && setting.numCascades() <= 32 &&
+           setting.numCascades() <= device.multiviewProperties().maxMultiviewViewCount;
+}
 
 struct CSMFrustumPassIn {
     FrameGraphResource<AtmosphereSetting> atmosSetting;
@@ -23,11 +28,12 @@ class CSMFrustumPass: public Pass<CSMFrustumPassIn, CSMFrustumPassOut> {
     };
 
 public:
+    explicit CSMFrustumPass(StaticShadowCache &cache): cache{cache} {}
     void setup(PassBuilder &builder) override {
         builder.read(passIn);
         passOut = {
             .frustums = builder.create<std::span<Frustum>>("CSMFrustums"),
-            .cascades = builder.create<BufferInfo>("cascades")};
+            .cascades = builder.create<BufferInfo>("cascades", AccessType::eTransferDst)};
     }
     void compile(RenderContext &ctx, Resources &resources) override {
         auto atmos = resources.get(passIn.atmosSetting);
@@ -40,8 +46,10 @@ public:
         if(!init) {
             init = true;
 
-            frustums.resize(numCascades);
+            // the static casters of every cascade, then the dynamic ones.
+            frustums.resize(2 * numCascades);
             cascades.resize(numCascades);
+            cache.cascades.resize(numCascades);
             cascadesBuffers.resize(ctx.numFrames);
             for(auto i = 0u; i < ctx.numFrames; ++i)
                 cascadesBuffers[i] =
@@ -60,6 +68,12 @@ public:
         auto fov = camera->fov();
         auto camView = camera->view();
 
+        auto cacheStatic = setting.cacheStaticCasters();
+        // the dynamic casters of all cascades are drawn together, once per instance.
+        auto mergeInto = multiviewCascades(ctx.device, setting) ? numCascades : ~0u;
+        auto sunChanged = sunDir != cache.sunDir;
+        auto staticChanged = setting.staticCastersVersion() != cache.staticCastersVersion;
+
         auto lambda = 0.5f;
         for(auto i = 0u; i < numCascades; ++i) {
             auto n = lambda * zNear * glm::pow(zFar / zNear, float(i) / numCascades) +
@@ -98,31 +112,65 @@ public:
             if(glm::all(glm::epsilonEqual(cross(sunDir, lUp), glm::vec3{}, std::numeric_limits<float>::epsilon())))
                 lUp = {0, 0, 1};
 
-            auto lightView = viewMatrix(center, center + sunDir, lUp);
-            auto lightViewInv = glm::inverse(lightView);
-
-            AABB aabb;
-            aabb.merge(lightView * glm::vec4(cam0, 1));
-            aabb.merge(lightView * glm::vec4(cam1, 1));
-            aabb.merge(lightView * glm::vec4(cam2, 1));
-            aabb.merge(lightView * glm::vec4(cam3, 1));
-            aabb.merge(lightView * glm::vec4(cam4, 1));
-            aabb.merge(lightView * glm::vec4(cam5, 1));
-            aabb.merge(lightView * glm::vec4(cam6, 1));
-            aabb.merge(lightView * glm::vec4(cam7, 1));
-
-            center = lightViewInv * glm::vec4(aabb.center(), 1);
-            auto range = aabb.range();
-            lightView = viewMatrix(center - sunDir * zFar / 2.f, center, lUp);
+            // the cascade covers the bounding sphere of the camera slice so its size doesn't change
+            // with the camera's direction, rounded up to keep it stable against float noise.
+            auto radius = 0.f;
+            for(auto &corner: {cam0, cam1, cam2, cam3, cam4, cam5, cam6, cam7})
+                radius = glm::max(radius, glm::distance(corner, center));
+            radius = glm::ceil(radius * 16.f) / 16.f;
+            auto halfExtent = radius * (1 + (cacheStatic ? cacheMargin : 0.f));
+            auto halfDepth = glm::max(zFar / 2, halfExtent);
+
+            auto lightRot = viewMatrix({}, sunDir, lUp);
+            auto lightCenter = glm::vec3(lightRot * glm::vec4(center, 1));
+
+            // the cached bounds are kept as long as they still contain the camera slice.
+            auto &cached = cache.cascades[i];
+            auto moved = glm::abs(lightCenter - cached.center);
+            auto invalid = !cacheStatic || sunChanged || staticChanged || cached.halfExtent != halfExtent ||
+                           cached.halfDepth != halfDepth || glm::max(moved.x, moved.y) > halfExtent - radius ||
+                           moved.z > halfDepth - radius;
+            if(invalid) {
+                // snapped to texels so the static casters rasterize the same way after moving.
+                auto texel = 2 * halfExtent / float(setting.textureSize());
+                lightCenter = glm::vec3(glm::round(glm::vec2(lightCenter) / texel) * texel, lightCenter.z);
+                auto worldCenter = glm::vec3(glm::inverse(lightRot) * glm::vec4(lightCenter, 1));
+                auto lightView = viewMatrix(worldCenter - sunDir * halfDepth, worldCenter, lUp);
+                auto lightProj = orthoMatrix(-halfExtent, halfExtent, -halfExtent, halfExtent, 0, 2 * halfDepth);
+                cached.lightViewProj = lightProj * lightView;
+                cached.center = lightCenter;
+                cached.halfExtent = halfExtent;
+                cached.halfDepth = halfDepth;
+                cached.refresh = true;
+            }
+            cascades[i] = {cached.lightViewProj, sunDir, f};
+
+            // casters are rendered orthographically, their size doesn't depend on the distance.
+            auto pixelScale = float(setting.textureSize()) / (2 * halfExtent);
+
+            // static casters are drawn into the cache over the whole light box, independent of the camera.
+            auto &staticFrustum = frustums[i];
+            staticFrustum = Frustum{cached.lightViewProj};
+            staticFrustum.pixelScale = pixelScale;
+            staticFrustum.minPixels = setting.cullMinTexels();
+            staticFrustum.perspective = 0;
+            staticFrustum.casters =
+                cacheStatic && cached.refresh ? FrustumCasters::eStatic : FrustumCasters::eNone;
 
-            auto lightProj = orthoMatrix(-range.x / 2, range.x / 2, -range.y / 2, range.y / 2, 0, zFar);
-
-            auto lightViewProj = lightProj * lightView;
-            cascades[i] = {lightViewProj, sunDir, f};
             //cull using camera near far frustum
             auto camFruProj = perspectiveMatrix(fov, a, n, f);
-            frustums[i] = Frustum{camFruProj * camView};
+            auto &frustum = frustums[numCascades + i];
+            frustum = Frustum{camFruProj * camView};
+            frustum.eye = p;
+            frustum.pixelScale = pixelScale;
+            frustum.minPixels = setting.cullMinTexels();
+            frustum.maxDistance = setting.cullMaxDistance();
+            frustum.perspective = 0;
+            frustum.casters = cacheStatic ? FrustumCasters::eDynamic : FrustumCasters::eAll;
+            frustum.mergeInto = mergeInto;
         }
+        cache.sunDir = sunDir;
+        cache.staticCastersVersion = setting.staticCastersVersion();
         resources.set(passOut.cascades, cascadesBuffers[ctx.frameIndex]->bufferInfo());
     }
     void execute(RenderContext &ctx, Resources &resources) override {
@@ -132,13 +180,13 @@ public:
         auto bufInfo = cascadesBuffers[ctx.frameIndex]->bufferInfo();
         cb.updateBuffer(bufInfo.buffer, bufInfo.offset, sizeof(CascadeDesc) * cascades.size(), cascades.data());
         ctx.device.end(cb);
-
-        cb.pipelineBarrier(
-            vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eAllGraphics, {},
-            vk::MemoryBarrier{vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eShaderRead}, nullptr, nullptr);
     }
 
 private:
+    StaticShadowCache &cache;
+    /** fraction of a cascade's radius the camera can move before the cached static depth is re-rendered. */
+    const float cacheMargin = 0.25f;
+
     std::vector<Frustum> frustums;
     std::vector<CascadeDesc> cascades;
     std::vector<std::unique_ptr<Buffer>> cascadesBuffers;
@@ -147,7 +195,7 @@ private:
 
 void ShadowMapPass::setup(PassBuilder &builder) {
     auto &frustum = builder.newPass<CSMFrustumPass>(
-        "CSMFrustumPass", {passIn.atmosSetting, passIn.shadowMapSetting, passIn.camera});
+        "CSMFrustumPass", {passIn.atmosSetting, passIn.shadowMapSetting, passIn.camera}, cache);
 
     auto &cull = builder.newPass<ComputeCullDrawCMD>(
         "ShadowMapCull",
@@ -172,9 +220,13 @@ void ShadowMapPass::setup(PassBuilder &builder) {
     builder.read(passIn.normals);
     builder.read(passIn.uvs);
     builder.read(passIn.indices);
-    builder.read(passIn.matrices);
-    builder.read(cascades);
+    builder.read(passIn.matrices, AccessType::eVertexRead);
+    builder.read(cascades, AccessType::eVertexRead);
     builder.read(cullPassOut);
+    builder.read(cullPassOut.cmdBuf, AccessType::eIndirectRead);
+    builder.read(cullPassOut.countBuf, AccessType::eIndirectRead);
+    builder.read(cullPassOut.instanceIds, AccessType::eVertexRead);
+    builder.read(cullPassOut.viewMasks, AccessType::eVertexRead);
     passOut = {
         .settingBuffer = builder.create<BufferInfo>("ShadowMapSetting"),
         .cascades = frustum.out().cascades,
@@ -190,16 +242,22 @@ void ShadowMapPass::compile(RenderContext &ctx, Resources &resources) {
         init = true;
         shadowMapSetting = buffer::hostUniformBuffer(ctx.device, sizeof(UBOShadowMapSetting));
         shadowMapSetting->ptr<UBOShadowMapSetting>()->numCascades = setting.numCascades();
+        multiview = multiviewCascades(ctx.device, setting);
         createPipeline(ctx.device, setting);
         createTextures(ctx.device, setting, ctx.numFrames);
 
         resources.set(passOut.settingBuffer, shadowMapSetting->bufferInfo());
     }
 
+    // the static cache is rendered by one frame and copied by the following ones, submitted to other queues.
+    if(setting.cacheStaticCasters()) afterPreviousFrame();
+
     auto &frame = frames[ctx.frameIndex];
 
     calcSetDef.cascades(resources.get(cascades));
     calcSetDef.matrices(resources.get(passIn.matrices));
+    calcSetDef.instanceIds(resources.get(cullPassOut.drawCMDs).instanceIds);
+    calcSetDef.viewMasks(resources.get(cullPassOut.drawCMDs).viewMasks);
     calcSetDef.update(frame.calcSet);
 
     resources.set(passOut.shadowMaps, frame.shadowMaps.get());
@@ -214,15 +272,19 @@ void ShadowMapPass::createTextures(Device &device, ShadowMapSetting &setting, ui
 
         frame.shadowMaps = image::make2DArrayTex(
             "shadowMaps", device, setting.textureSize(), setting.textureSize(), setting.numCascades(),
-            vk::ImageUsageFlagBits::eDepthStencilAttachment | vk::ImageUsageFlagBits::eSampled, vk::Format::eD32Sfloat,
-            vk::SampleCountFlagBits::e1, vk::ImageAspectFlagBits::eDepth, false);
+            vk::ImageUsageFlagBits::eDepthStencilAttachment | vk::ImageUsageFlagBits::eSampled |
+                vk::ImageUsageFlagBits::eTransferDst,
+            vk::Format::eD32Sfloat, vk::SampleCountFlagBits::e1, vk::ImageAspectFlagBits::eDepth, false);
         frame.shadowMaps->setSampler({{}, vk::Filter::eLinear, vk::Filter::eLinear, vk::SamplerMipmapMode::eLinear});
 
-        frame.shadowMapLayerViews.resize(setting.numCascades());
-        std::vector<vk::ImageView> attachments(setting.numCascades());
-        for(auto c = 0u; c < setting.numCascades(); ++c) {
-            frame.shadowMapLayerViews[c] = frame.shadowMaps->createLayerImageView(c);
-            attachments[c] = *frame.shadowMapLayerViews[c];
+        std::vector<vk::ImageView> attachments;
+        if(multiview) attachments.push_back(frame.shadowMaps->imageView());
+        else {
+            frame.shadowMapLayerViews.resize(setting.numCascades());
+            for(auto c = 0u; c < setting.numCascades(); ++c) {
+                frame.shadowMapLayerViews[c] = frame.shadowMaps->createLayerImageView(c);
+                attachments.push_back(*frame.shadowMapLayerViews[c]);
+            }
         }
         vk::FramebufferCreateInfo info{{},
                                        *renderPass,
@@ -233,6 +295,19 @@ void ShadowMapPass::createTextures(Device &device, ShadowMapSetting &setting, ui
                                        1};
         frame.framebuffer = device.vkDevice().createFramebufferUnique(info);
     }
+
+    staticShadowMaps = image::make2DArrayTex(
+        "staticShadowMaps", device, setting.textureSize(), setting.textureSize(), setting.numCascades(),
+        vk::ImageUsageFlagBits::eDepthStencilAttachment | vk::ImageUsageFlagBits::eTransferSrc,
+        vk::Format::eD32Sfloat, vk::SampleCountFlagBits::e1, vk::ImageAspectFlagBits::eDepth, false);
+    staticLayerViews.resize(setting.numCascades());
+    staticFramebuffers.resize(setting.numCascades());
+    for(auto c = 0u; c < setting.numCascades(); ++c) {
+        staticLayerViews[c] = staticShadowMaps->createLayerImageView(c);
+        vk::FramebufferCreateInfo info{
+            {}, *staticRenderPass, 1, &*staticLayerViews[c], setting.textureSize(), setting.textureSize(), 1};
+        staticFramebuffers[c] = device.vkDevice().createFramebufferUnique(info);
+    }
 }
 
 auto ShadowMapPass::createPipeline(Device &device, ShadowMapSetting &setting) -> void {
@@ -240,38 +315,77 @@ auto ShadowMapPass::createPipeline(Device &device, ShadowMapSetting &setting) ->
     {
         RenderPassMaker maker;
 
-        std::vector<uint32_t> depths;
-
-        depths.resize(setting.numCascades());
-        subpasses.resize(setting.numCascades());
-        for(auto i = 0u; i < setting.numCascades(); ++i) {
-            depths[i] = maker.attachment(vk::Format::eD32Sfloat)
-                            .samples(vk::SampleCountFlagBits::e1)
-                            .loadOp(vk::AttachmentLoadOp::eClear)
-                            .storeOp(vk::AttachmentStoreOp::eStore)
-                            .stencilLoadOp(vk::AttachmentLoadOp::eDontCare)
-                            .stencilStoreOp(vk::AttachmentStoreOp::eDontCare)
-                            .initialLayout(vk::ImageLayout::eUndefined)
-                            .finalLayout(vk::ImageLayout::eShaderReadOnlyOptimal)
-                            .index();
-            subpasses[i] = maker.subpass(vk::PipelineBindPoint::eGraphics).depthStencil(depths[i]).index();
-            maker.dependency(VK_SUBPASS_EXTERNAL, subpasses[i])
-                .srcStage(vk::PipelineStageFlagBits::eFragmentShader)
+        // the static casters were copied in or the layers were cleared before the render pass.
+        auto addDepth = [&]() {
+            return maker.attachment(vk::Format::eD32Sfloat)
+                .samples(vk::SampleCountFlagBits::e1)
+                .loadOp(vk::AttachmentLoadOp::eLoad)
+                .storeOp(vk::AttachmentStoreOp::eStore)
+                .stencilLoadOp(vk::AttachmentLoadOp::eDontCare)
+                .stencilStoreOp(vk::AttachmentStoreOp::eDontCare)
+                .initialLayout(vk::ImageLayout::eTransferDstOptimal)
+                .finalLayout(vk::ImageLayout::eShaderReadOnlyOptimal)
+                .index();
+        };
+        auto addDependencies = [&](uint32_t subpass) {
+            maker.dependency(VK_SUBPASS_EXTERNAL, subpass)
+                .srcStage(vk::PipelineStageFlagBits::eTransfer)
                 .dstStage(vk::PipelineStageFlagBits::eEarlyFragmentTests)
-                .srcAccess(vk::AccessFlagBits::eShaderRead)
-                .dstAccess(vk::AccessFlagBits::eDepthStencilAttachmentWrite)
-                .flags(vk::DependencyFlagBits::eByRegion);
-            maker.dependency(subpasses[i], VK_SUBPASS_EXTERNAL)
+                .srcAccess(vk::AccessFlagBits::eTransferWrite)
+                .dstAccess(
+                    vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite);
+            maker.dependency(subpass, VK_SUBPASS_EXTERNAL)
                 .srcStage(vk::PipelineStageFlagBits::eLateFragmentTests)
                 .dstStage(vk::PipelineStageFlagBits::eFragmentShader)
                 .srcAccess(vk::AccessFlagBits::eDepthStencilAttachmentWrite)
                 .dstAccess(vk::AccessFlagBits::eShaderRead)
                 .flags(vk::DependencyFlagBits::eByRegion);
+        };
+
+        if(multiview) {
+            // one view per cascade, rendering into the layers of a single attachment.
+            auto depth = addDepth();
+            auto viewMask = (1u << setting.numCascades()) - 1;
+            subpasses = {maker.subpass(vk::PipelineBindPoint::eGraphics, viewMask).depthStencil(depth).index()};
+            addDependencies(subpasses[0]);
+        } else {
+            subpasses.resize(setting.numCascades());
+            for(auto i = 0u; i < setting.numCascades(); ++i) {
+                auto depth = addDepth();
+                subpasses[i] = maker.subpass(vk::PipelineBindPoint::eGraphics).depthStencil(depth).index();
+                addDependencies(subpasses[i]);
+            }
         }
 
         renderPass = maker.createUnique(device.vkDevice());
     }
 
+    {
+        RenderPassMaker maker;
+        auto depth = maker.attachment(vk::Format::eD32Sfloat)
+                         .samples(vk::SampleCountFlagBits::e1)
+                         .loadOp(vk::AttachmentLoadOp::eClear)
+                         .storeOp(vk::AttachmentStoreOp::eStore)
+                         .stencilLoadOp(vk::AttachmentLoadOp::eDontCare)
+                         .stencilStoreOp(vk::AttachmentStoreOp::eDontCare)
+                         .initialLayout(vk::ImageLayout::eUndefined)
+                         .finalLayout(vk::ImageLayout::eTransferSrcOptimal)
+                         .index();
+        auto subpass = maker.subpass(vk::PipelineBindPoint::eGraphics).depthStencil(depth).index();
+        // the previous copy into the frame's shadow maps read the layer.
+        maker.dependency(VK_SUBPASS_EXTERNAL, subpass)
+            .srcStage(vk::PipelineStageFlagBits::eTransfer)
+            .dstStage(vk::PipelineStageFlagBits::eEarlyFragmentTests)
+            .srcAccess(vk::AccessFlagBits::eTransferRead)
+            .dstAccess(vk::AccessFlagBits::eDepthStencilAttachmentWrite);
+        maker.dependency(subpass, VK_SUBPASS_EXTERNAL)
+            .srcStage(vk::PipelineStageFlagBits::eLateFragmentTests)
+            .dstStage(vk::PipelineStageFlagBits::eTransfer)
+            .srcAccess(vk::AccessFlagBits::eDepthStencilAttachmentWrite)
+            .dstAccess(vk::AccessFlagBits::eTransferRead);
+        staticRenderPass = maker.createUnique(device.vkDevice());
+    }
+
     {
         calcSetDef.init(device);
 
@@ -280,7 +394,7 @@ auto ShadowMapPass::createPipeline(Device &device, ShadowMapSetting &setting) ->
     }
 
     {
-        GraphicsPipelineMaker maker(device.vkDevice());
+        GraphicsPipelineMaker maker(device);
 
         maker.layout(calcPipeDef.layout())
             .renderPass(*renderPass)
@@ -301,41 +415,41 @@ auto ShadowMapPass::createPipeline(Device &device, ShadowMapSetting &setting) ->
             .dynamicState(vk::DynamicState::eViewport)
             .dynamicState(vk::DynamicState::eScissor);
 
+        if(multiview) {
+            maker.shader(vk::ShaderStageFlagBits::eVertex, Shader{shader::deferred::csm::csm_multiview_vert_span});
+            pipes.resize(1);
+            pipes[0] = maker.subpass(subpasses[0]).createUnique();
+        }
+
         maker.shader(
             vk::ShaderStageFlagBits::eVertex, Shader{shader::deferred::csm::csm_vert_span, setting.numCascades()});
-
-        pipes.resize(setting.numCascades());
-        for(auto i = 0u; i < setting.numCascades(); ++i) {
-            maker.subpass(subpasses[i]);
-            pipes[i] = maker.createUnique();
+        if(!multiview) {
+            pipes.resize(setting.numCascades());
+            for(auto i = 0u; i < setting.numCascades(); ++i) {
+                maker.subpass(subpasses[i]);
+                pipes[i] = maker.createUnique();
+            }
         }
+        maker.renderPass(*staticRenderPass).subpass(0);
+        staticPipe = maker.createUnique();
     }
 }
 
 void ShadowMapPass::execute(RenderContext &ctx, Resources &resources) {
     auto cb = ctx.cb;
 
-    auto drawInfos = resources.get(cullPassOut.drawCMDs);
+    auto &drawInfos = resources.get(cullPassOut.drawCMDs);
     auto setting = resources.get(passIn.shadowMapSetting);
+    auto numCascades = setting.numCascades();
+    auto cacheStatic = setting.cacheStaticCasters();
 
     auto &frame = frames[ctx.frameIndex];
 
-    std::vector<vk::ClearValue> clearValues(setting.numCascades());
-    for(auto i = 0u; i < setting.numCascades(); ++i)
-        clearValues[i] = vk::ClearDepthStencilValue{1.0f, 0};
-    vk::RenderPassBeginInfo renderPassBeginInfo{
-        *renderPass, *frame.framebuffer, vk::Rect2D{{0, 0}, {setting.textureSize(), setting.textureSize()}},
-        uint32_t(clearValues.size()), clearValues.data()};
-
+    vk::Rect2D renderArea{{0, 0}, {setting.textureSize(), setting.textureSize()}};
     vk::Viewport viewport{0, 0, float(setting.textureSize()), float(setting.textureSize()), 0.0f, 1.0f};
-    vk::Rect2D scissor{{0, 0}, {setting.textureSize(), setting.textureSize()}};
 
     ctx.device.begin(cb, toString("shadow map frame ", ctx.frameIndex));
 
-    cb.beginRenderPass(renderPassBeginInfo, vk::SubpassContents::eInline);
-    cb.setViewport(0, viewport);
-    cb.setScissor(0, scissor);
-
     cb.bindDescriptorSets(
         vk::PipelineBindPoint::eGraphics, calcPipeDef.layout(), calcPipeDef.set.set(), frame.calcSet, nullptr);
     auto bufInfo = resources.get(passIn.positions);
@@ -355,17 +469,76 @@ void ShadowMapPass::execute(RenderContext &ctx, Resources &resources) {
             drawInfo.cmdBuf.buffer, drawInfo.cmdBuf.offset, drawInfo.countBuf.buffer, drawInfo.countBuf.offset,
             drawInfo.maxCount, drawInfo.stride);
     };
-    for(auto i = 0u; i < setting.numCascades(); ++i) {
-        pushContant.cascadeIndex = i;
+    auto drawCasters = [&](uint32_t frustumIdx, uint32_t cascadeIdx) {
+        pushContant.cascadeIndex = cascadeIdx;
+        pushContant.viewMaskOffset = frustumIdx * resources.get(passIn.meshInstancesCount);
         cb.pushConstants<PushContant>(calcPipeDef.layout(), vk::ShaderStageFlagBits::eVertex, 0, pushContant);
+        draw(frustumIdx, ShadeModel::BRDF);
+        draw(frustumIdx, ShadeModel::Reflective);
+        draw(frustumIdx, ShadeModel::Refractive);
+    };
 
-        cb.bindPipeline(vk::PipelineBindPoint::eGraphics, *pipes[i]);
-        draw(i, ShadeModel::BRDF);
-        draw(i, ShadeModel::Reflective);
-        draw(i, ShadeModel::Refractive);
-        if(i + 1 < setting.numCascades()) cb.nextSubpass(vk::SubpassContents::eInline);
+    if(cacheStatic) {
+        vk::ClearValue clearValue{vk::ClearDepthStencilValue{1.0f, 0}};
+        for(auto i = 0u; i < numCascades; ++i) {
+            auto &cached = cache.cascades[i];
+            if(!cached.refresh) continue;
+            cb.beginRenderPass(
+                vk::RenderPassBeginInfo{*staticRenderPass, *staticFramebuffers[i], renderArea, 1, &clearValue},
+                vk::SubpassContents::eInline);
+            cb.setViewport(0, viewport);
+            cb.setScissor(0, renderArea);
+            cb.bindPipeline(vk::PipelineBindPoint::eGraphics, *staticPipe);
+            drawCasters(i, i);
+            cb.endRenderPass();
+            cached.refresh = false;
+        }
     }
+
+    // the lighting of the last frame using these shadow maps has to be done reading them.
+    vk::ImageSubresourceRange range{vk::ImageAspectFlagBits::eDepth, 0, 1, 0, numCascades};
+    vk::ImageMemoryBarrier barrier{
+        {},
+        vk::AccessFlagBits::eTransferWrite,
+        vk::ImageLayout::eUndefined,
+        vk::ImageLayout::eTransferDstOptimal,
+        VK_QUEUE_FAMILY_IGNORED,
+        VK_QUEUE_FAMILY_IGNORED,
+        frame.shadowMaps->image(),
+        range};
+    cb.pipelineBarrier(
+        vk::PipelineStageFlagBits::eFragmentShader, vk::PipelineStageFlagBits::eTransfer, {}, nullptr, nullptr,
+        barrier);
+    if(cacheStatic)
+        cb.copyImage(
+            staticShadowMaps->image(), vk::ImageLayout::eTransferSrcOptimal, frame.shadowMaps->image(),
+            vk::ImageLayout::eTransferDstOptimal,
+            vk::ImageCopy{
+                {vk::ImageAspectFlagBits::eDepth, 0, 0, numCascades},
+                {},
+                {vk::ImageAspectFlagBits::eDepth, 0, 0, numCascades},
+                {},
+                {setting.textureSize(), setting.textureSize(), 1}});
+    else
+        cb.clearDepthStencilImage(
+            frame.shadowMaps->image(), vk::ImageLayout::eTransferDstOptimal, vk::ClearDepthStencilValue{1.0f, 0},
+            range);
+
+    // the dynamic casters, or every caster without the cache, are drawn on top.
+    cb.beginRenderPass(
+        vk::RenderPassBeginInfo{*renderPass, *frame.framebuffer, renderArea}, vk::SubpassContents::eInline);
+    cb.setViewport(0, viewport);
+    cb.setScissor(0, renderArea);
+    if(multiview) {
+        cb.bindPipeline(vk::PipelineBindPoint::eGraphics, *pipes[0]);
+        drawCasters(numCascades, 0);
+    } else
+        for(auto i = 0u; i < numCascades; ++i) {
+            cb.bindPipeline(vk::PipelineBindPoint::eGraphics, *pipes[i]);
+            drawCasters(numCascades + i, i);
+            if(i + 1 < numCascades) cb.nextSubpass(vk::SubpassContents::eInline);
+        }
     cb.endRenderPass();
     ctx.device.end(cb);
 }
-}
\ No newline at end of file
+}
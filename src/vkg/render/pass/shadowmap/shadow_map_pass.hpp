@@ -10,6 +10,25 @@
 #include "vkg/render/pass/atmosphere/atmosphere_pass.hpp"
 
 namespace vkg {
+/**
+ * Light space bounds of the static caster depth kept per cascade, shared by the pass computing
+ * the cascades and the `ShadowMapPass` rendering them. A cascade's bounds only move when the
+ * camera slice leaves them, which is when its static depth is re-rendered.
+ */
+struct StaticShadowCache {
+    struct Cascade {
+        glm::mat4 lightViewProj{1};
+        /** light space center and half sizes of the cascade's box. */
+        glm::vec3 center{0};
+        float halfExtent{0}, halfDepth{0};
+        /** the static depth has to be re-rendered, cleared once it is. */
+        bool refresh{true};
+    };
+    std::vector<Cascade> cascades;
+    glm::vec3 sunDir{0};
+    uint64_t staticCastersVersion{0};
+};
+
 /**
  * TODO shouldn't cull the shadow caster out of the view frustum.
  */
@@ -47,10 +66,14 @@ private:
     struct CalcSetDef: DescriptorSetDef {
         __buffer__(cascades, vk::ShaderStageFlagBits::eVertex);
         __buffer__(matrices, vk::ShaderStageFlagBits::eVertex);
+        __buffer__(instanceIds, vk::ShaderStageFlagBits::eVertex);
+        __buffer__(viewMasks, vk::ShaderStageFlagBits::eVertex);
     } calcSetDef;
 
     struct PushContant {
         uint32_t cascadeIndex;
+        /** offset of the drawn frustum's view masks, only read by the multiview shader. */
+        uint32_t viewMaskOffset;
     } pushContant;
     struct CalcPipeDef: PipelineLayoutDef {
         __push_constant__(cascadeIndex, vk::ShaderStageFlagBits::eVertex, PushContant);
@@ -61,11 +84,24 @@ private:
         uint32_t numCascades;
     };
 
+    StaticShadowCache cache;
+    /**
+     * depth of the static casters, copied into the frame's shadow maps before the dynamic casters. Shared by
+     * the frames, which are ordered by waiting on the previous one while the cache is used.
+     */
+    std::unique_ptr<Texture> staticShadowMaps;
+    std::vector<vk::UniqueImageView> staticLayerViews;
+    std::vector<vk::UniqueFramebuffer> staticFramebuffers;
+    vk::UniqueRenderPass staticRenderPass;
+    vk::UniquePipeline staticPipe;
+
     ComputeCullDrawCMDPassOut cullPassOut;
     FrameGraphResource<BufferInfo> cascades;
 
     vk::UniqueDescriptorPool descriptorPool;
 
+    /** the dynamic casters of every cascade are drawn in one subpass, a view per cascade. */
+    bool multiview{false};
     vk::UniqueRenderPass renderPass;
     std::vector<uint32_t> subpasses{};
     std::vector<vk::UniquePipeline> pipes;
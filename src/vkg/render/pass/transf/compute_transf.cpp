@@ -1,57 +1,109 @@
 #include "compute_transf.hpp"
 
 #include "common/transform_comp.hpp"
+#include "common/transform_set_comp.hpp"
 
 namespace vkg {
 
 void ComputeTransf::setup(PassBuilder &builder) {
-    builder.read(passIn.transforms);
-    builder.read(passIn.meshInstances);
+    builder.queue(QueueType::eCompute);
+    builder.read(passIn.transforms, AccessType::eComputeRead);
+    builder.read(passIn.meshInstances, AccessType::eComputeRead);
     builder.read(passIn.meshInstancesCount);
     builder.read(passIn.sceneConfig);
+    builder.read(passIn.temporalAA);
     passOut = {
-        .matrices = builder.create<BufferInfo>("matrices"),
+        .matrices = builder.create<BufferInfo>("matrices", AccessType::eComputeStorageWrite),
+        .prevMatrices = builder.create<BufferInfo>("prevMatrices", AccessType::eComputeStorageWrite),
     };
 }
 void ComputeTransf::compile(RenderContext &ctx, Resources &resources) {
     if(!init) {
         init = true;
 
-        setDef.init(ctx.device);
-        pipeDef.transf(setDef);
-        pipeDef.init(ctx.device);
+        useHeap = ctx.device.supported().descriptorIndexing;
+        if(useHeap) {
+            PipelineLayoutMaker layoutMaker;
+            layoutMaker.add(ctx.device.descriptorHeap().setLayout());
+            layoutMaker.pushConstantAuto<PushConstant>(vk::ShaderStageFlagBits::eCompute);
+            pipeLayout = layoutMaker.createUnique(ctx.device);
+            layout = *pipeLayout;
+        } else {
+            setDef.init(ctx.device);
+            pipeDef.transf(setDef);
+            pipeDef.init(ctx.device);
+            layout = pipeDef.layout();
+            descriptorPool = DescriptorPoolMaker().pipelineLayout(pipeDef, ctx.numFrames).createUnique(ctx.device);
+        }
 
         pipe = ComputePipelineMaker(ctx.device)
-                   .layout(pipeDef.layout())
-                   .shader(Shader{shader::common::transform_comp_span, local_size, 1, 1})
+                   .layout(layout)
+                   .shader(
+                       useHeap ? Shader{shader::common::transform_comp_span, local_size, 1, 1} :
+                                 Shader{shader::common::transform_set_comp_span, local_size, 1, 1})
                    .createUnique();
 
-        descriptorPool = DescriptorPoolMaker().pipelineLayout(pipeDef, ctx.numFrames).createUnique(ctx.device);
-
         auto sceneConfig = resources.get(passIn.sceneConfig);
 
         frames.resize(ctx.numFrames);
         for(auto i = 0u; i < ctx.numFrames; ++i) {
             auto &frame = frames[i];
-            frame.matrices = buffer::devStorageBuffer(
-                resources.device, sizeof(glm::mat4) * sceneConfig.maxNumMeshInstances, name + "_matrices");
-            frame.set = setDef.createSet(*descriptorPool);
+            frame.matrices = buffer::devBuffer(
+                resources.device, vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferSrc,
+                sizeof(glm::mat4) * sceneConfig.maxNumMeshInstances, name + "_matrices");
+            frame.prevMatrices = buffer::devStorageBuffer(
+                resources.device, sizeof(glm::mat4) * sceneConfig.maxNumMeshInstances, name + "_prevMatrices");
+            if(!useHeap) frame.set = setDef.createSet(*descriptorPool);
         }
     }
     auto &frame = frames[ctx.frameIndex];
 
-    setDef.transforms(resources.get(passIn.transforms));
-    setDef.meshInstances(resources.get(passIn.meshInstances));
-    setDef.matrices(frame.matrices->bufferInfo());
-    setDef.update(frame.set);
+    // the matrices of the previous frame are copied.
+    copyPrevMatrices = resources.get(passIn.temporalAA).isEnabled();
+    if(copyPrevMatrices) afterPreviousFrame();
+
+    if(useHeap) {
+        // only buffers the heap hasn't seen before are written.
+        auto &heap = ctx.device.descriptorHeap();
+        frame.transformsSlot = heap.buffer(resources.get(passIn.transforms));
+        frame.meshInstancesSlot = heap.buffer(resources.get(passIn.meshInstances));
+        frame.matricesSlot = heap.buffer(frame.matrices->bufferInfo());
+    } else {
+        setDef.transforms(resources.get(passIn.transforms));
+        setDef.meshInstances(resources.get(passIn.meshInstances));
+        setDef.matrices(frame.matrices->bufferInfo());
+        setDef.update(frame.set);
+    }
 
     resources.set(passOut.matrices, frame.matrices->bufferInfo());
+    resources.set(passOut.prevMatrices, frame.prevMatrices->bufferInfo());
 }
 void ComputeTransf::execute(RenderContext &ctx, Resources &resources) {
     auto total = resources.get(passIn.meshInstancesCount);
-    if(total == 0) return;
-
     auto &frame = frames[ctx.frameIndex];
+    auto cb = ctx.cb;
+
+    // the first frame has no previous matrices and copies its own after computing them.
+    auto copyPrev = [&](Buffer &src) {
+        if(total == 0) return;
+        ctx.device.begin(cb, "copy previous matrices");
+        cb.pipelineBarrier(
+            vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eTransfer, {},
+            vk::MemoryBarrier{vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eTransferRead}, nullptr, nullptr);
+        auto srcInfo = src.bufferInfo(), dstInfo = frame.prevMatrices->bufferInfo();
+        cb.copyBuffer(
+            srcInfo.buffer, dstInfo.buffer, vk::BufferCopy{srcInfo.offset, dstInfo.offset, sizeof(glm::mat4) * total});
+        // the readers of the previous matrices are ordered after this pass's compute shaders.
+        cb.pipelineBarrier(
+            vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader, {},
+            vk::MemoryBarrier{
+                vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite},
+            nullptr, nullptr);
+        ctx.device.end(cb);
+    };
+    if(copyPrevMatrices && hasPrevMatrices) copyPrev(*frames[prevFrameIndex].matrices);
+    prevFrameIndex = ctx.frameIndex;
+    if(total == 0) return;
 
     auto maxCG = ctx.device.limits().maxComputeWorkGroupCount;
     auto totalGroup = uint32_t(std::ceil(total / double(local_size)));
@@ -61,27 +113,23 @@ void ComputeTransf::execute(RenderContext &ctx, Resources &resources) {
     totalGroup = uint32_t(totalGroup / double(dy));
     auto dz = std::min(std::max(totalGroup, 1u), maxCG[2]);
 
-    auto cb = ctx.cb;
     ctx.device.begin(cb, "compute transform");
     cb.bindPipeline(vk::PipelineBindPoint::eCompute, *pipe);
-    cb.bindDescriptorSets(vk::PipelineBindPoint::eCompute, pipeDef.layout(), pipeDef.transf.set(), frame.set, nullptr);
-    pushConstant = {total, ctx.frameIndex};
-    cb.pushConstants<PushConstant>(pipeDef.layout(), vk::ShaderStageFlagBits::eCompute, 0, pushConstant);
+    auto set = useHeap ? ctx.device.descriptorHeap().set() : frame.set;
+    cb.bindDescriptorSets(vk::PipelineBindPoint::eCompute, layout, 0, set, nullptr);
+    pushConstant = {
+        .totalMeshInstances = total,
+        .frame = ctx.frameIndex,
+        .meshInstances = frame.meshInstancesSlot,
+        .transforms = frame.transformsSlot,
+        .matrices = frame.matricesSlot,
+    };
+    cb.pushConstants<PushConstant>(layout, vk::ShaderStageFlagBits::eCompute, 0, pushConstant);
     cb.dispatch(dx, dy, dz);
-
-    auto bufInfo = frame.matrices->bufferInfo();
-    vk::BufferMemoryBarrier barrier{
-        vk::AccessFlagBits::eShaderWrite,
-        vk::AccessFlagBits::eShaderRead,
-        VK_QUEUE_FAMILY_IGNORED,
-        VK_QUEUE_FAMILY_IGNORED,
-        bufInfo.buffer,
-        bufInfo.offset,
-        bufInfo.size};
-    cb.pipelineBarrier(
-        vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader, {}, nullptr, barrier,
-        nullptr);
     ctx.device.end(cb);
+
+    if(copyPrevMatrices && !hasPrevMatrices) copyPrev(*frame.matrices);
+    hasPrevMatrices = true;
 }
 
 }
\ No newline at end of file
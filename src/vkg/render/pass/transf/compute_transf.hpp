@@ -1,6 +1,7 @@
 #pragma once
 #include "vkg/base/base.hpp"
 #include "vkg/render/scene_config.hpp"
+#include "vkg/render/model/temporal_aa.hpp"
 #include "vkg/render/graph/frame_graph.hpp"
 #include "vkg/math/glm_common.hpp"
 
@@ -10,9 +11,13 @@ struct ComputeTransfPassIn {
     FrameGraphResource<BufferInfo> meshInstances;
     FrameGraphResource<uint32_t> meshInstancesCount;
     FrameGraphResource<SceneConfig> sceneConfig;
+    /** the previous matrices are only kept while the TAA is enabled. */
+    FrameGraphResource<TemporalAASetting> temporalAA;
 };
 struct ComputeTransfPassOut {
     FrameGraphResource<BufferInfo> matrices;
+    /** the matrices of the previous frame for motion vectors, stale while the TAA is disabled. */
+    FrameGraphResource<BufferInfo> prevMatrices;
 };
 
 class ComputeTransf: public Pass<ComputeTransfPassIn, ComputeTransfPassOut> {
@@ -22,10 +27,15 @@ public:
     void execute(RenderContext &ctx, Resources &resources) override;
 
 private:
+    /** the buffers are slots of the device's descriptor heap, unused by the fallback. */
     struct PushConstant {
         uint32_t totalMeshInstances;
         uint32_t frame;
+        uint32_t meshInstances;
+        uint32_t transforms;
+        uint32_t matrices;
     } pushConstant{};
+    /** fallback for devices without update-after-bind descriptor indexing, which the heap requires. */
     struct ComputeTransfSetDef: DescriptorSetDef {
         __buffer__(meshInstances, vkStage::eCompute);
         __buffer__(transforms, vkStage::eCompute);
@@ -35,16 +45,29 @@ private:
         __push_constant__(constant, vkStage::eCompute, PushConstant);
         __set__(transf, ComputeTransfSetDef);
     } pipeDef;
+    vk::UniqueDescriptorPool descriptorPool;
+    bool useHeap{false};
+
+    vk::UniquePipelineLayout pipeLayout;
+    vk::PipelineLayout layout;
     vk::UniquePipeline pipe;
     const uint32_t local_size = 64;
 
-    vk::UniqueDescriptorPool descriptorPool;
-
     struct FrameResource {
         std::unique_ptr<Buffer> matrices;
+        /**
+         * copied from the previous frame's matrices, as the frame reusing the previous frame's index may
+         * overwrite those while this frame is still drawing. The previous frame is submitted to another
+         * queue, so the pass waits for it to finish. Only copied while the TAA is enabled.
+         */
+        std::unique_ptr<Buffer> prevMatrices;
+        uint32_t meshInstancesSlot{0}, transformsSlot{0}, matricesSlot{0};
         vk::DescriptorSet set;
     };
     std::vector<FrameResource> frames;
+    uint32_t prevFrameIndex{~0u};
+    bool hasPrevMatrices{false};
+    bool copyPrevMatrices{false};
     bool init{false};
 };
 
@@ -8,21 +8,25 @@ struct RendererSetupPassOut {
     FrameGraphResource<vk::Extent2D> swapchainExtent;
     FrameGraphResource<vk::Format> swapchainFormat;
     FrameGraphResource<uint64_t> swapchainVersion;
+    FrameGraphResource<double> gpuFrameTime;
 };
 class RendererSetupPass: public Pass<RendererSetupPassIn, RendererSetupPassOut> {
 public:
     explicit RendererSetupPass(Renderer &renderer): renderer(renderer) {}
     void setup(PassBuilder &builder) override {
+        builder.compileSerially();
         passOut = {
             .swapchainExtent = builder.create<vk::Extent2D>("swapchainExtent"),
             .swapchainFormat = builder.create<vk::Format>("swapchainFormat"),
             .swapchainVersion = builder.create<uint64_t>("swapchainVersion"),
+            .gpuFrameTime = builder.create<double>("gpuFrameTime"),
         };
     }
     void compile(RenderContext &ctx, Resources &resources) override {
         resources.set(passOut.swapchainExtent, renderer.swapchain().imageExtent());
         resources.set(passOut.swapchainFormat, renderer.swapchain().format());
         resources.set(passOut.swapchainVersion, renderer.swapchain().version());
+        resources.set(passOut.gpuFrameTime, renderer.frameGraph->gpuFrameTime());
     }
 
 private:
@@ -33,7 +37,9 @@ struct RendererPresentPassIn {
     std::vector<FrameGraphResource<Texture *>> backImgs;
     std::vector<FrameGraphResource<vk::Rect2D>> renderAreas;
 };
-struct RendererPresentPassOut {};
+struct RendererPresentPassOut {
+    FrameGraphResource<uint32_t> presentImage;
+};
 
 class RendererPresentPass: public Pass<RendererPresentPassIn, RendererPresentPassOut> {
 public:
@@ -44,6 +50,12 @@ public:
             builder.read(passIn.backImgs[i]);
             builder.read(passIn.renderAreas[i]);
         }
+        passOut = {
+            .presentImage = builder.create<uint32_t>("presentImage"),
+        };
+    }
+    void compile(RenderContext &ctx, Resources &resources) override {
+        resources.set(passOut.presentImage, ctx.swapchainIndex);
     }
     void execute(RenderContext &ctx, Resources &resources) override {
         auto cb = ctx.cb;
@@ -71,9 +83,10 @@ public:
                 {vk::Offset3D{}, vk::Offset3D{int32_t(renderArea.extent.width), int32_t(renderArea.extent.height), 1}});
             ctx.device.end(cb);
         }
+        // headless images are left as transfer sources so they can be read back.
         ctx.device.begin(cb, toString("barrier present frame ", ctx.frameIndex));
         image::setLayout(
-            cb, present, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::ePresentSrcKHR,
+            cb, present, vk::ImageLayout::eTransferDstOptimal, renderer.swapchain().presentLayout(),
             vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eMemoryRead);
         ctx.device.end(cb);
     }
@@ -90,27 +103,47 @@ auto Renderer::addScene(SceneConfig sceneConfig, const std::string &name) -> Sce
     return *scenes[name];
 }
 
+auto Renderer::barrierStats() const -> BarrierStats { return frameGraph->barrierStats(); }
+auto Renderer::frameStats() const -> FrameStats { return frameGraph->frameStats(); }
+auto Renderer::setFrameReadback(FrameReadbackConfig config) -> void {
+    errorIf(frameGraph != nullptr, "frame readback must be set before the first frame");
+    readbackConfig = std::move(config);
+}
+
 void Renderer::onInit() {
-    frameGraph = std::make_unique<FrameGraph>(*device_);
+    frameGraph = std::make_unique<FrameGraph>(*device_, featureConfig_.recordThreads);
 
     auto &pass = frameGraph->newPass<RendererSetupPass>("RendererSetup", {}, *this);
 
     RendererPresentPassIn presentPassIn;
     for(auto &[name, scene]: scenes) {
         auto &scenePass = frameGraph->addPass(
-            name, ScenePassIn{pass.out().swapchainExtent, pass.out().swapchainFormat, pass.out().swapchainVersion},
+            name,
+            ScenePassIn{
+                pass.out().swapchainExtent, pass.out().swapchainFormat, pass.out().swapchainVersion,
+                pass.out().gpuFrameTime},
             *scene);
         presentPassIn.backImgs.push_back(scenePass.out().backImg);
         presentPassIn.renderAreas.push_back(scenePass.out().renderArea);
     }
 
-    frameGraph->newPass<RendererPresentPass>("RendererPresent", presentPassIn, *this);
+    auto &presentPass = frameGraph->newPass<RendererPresentPass>("RendererPresent", presentPassIn, *this);
+    if(readbackConfig.callback)
+        frameGraph->newPass<FrameReadbackPass>(
+            "FrameReadback", {presentPass.out().presentImage}, *this, std::move(readbackConfig));
 
     frameGraph->build();
 }
 
 void Renderer::onFrame(uint32_t imageIndex, float elapsed) {
-    RenderContext ctx{*device_, imageIndex, frameIndex, uint32_t(device_->queues().size()), cmdBuffers[frameIndex]};
+    RenderContext ctx{
+        *device_, imageIndex, frameIndex, uint32_t(device_->queues().size()), cmdBuffers[frameIndex],
+        previousFrameTimeline()};
+    frameGraph->resizeTransients(swapchain_->imageExtent());
     frameGraph->onFrame(ctx);
+    auto waits = frameGraph->frameWaits();
+    frameWaits.assign(waits.begin(), waits.end());
+    auto cbs = frameGraph->frameCmdBuffers();
+    frameCmdBuffers.assign(cbs.begin(), cbs.end());
 }
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 #include "vkg/base/base.hpp"
 #include "scene.hpp"
+#include "pass/common/frame_readback_pass.hpp"
 #include <map>
 
 namespace vkg {
@@ -13,6 +14,20 @@ public:
   auto addScene(SceneConfig sceneConfig = {}, const std::string &name = "Scene")
     -> Scene &;
 
+  /**
+   * barriers generated by the frame graph during the last frame.
+   */
+  auto barrierStats() const -> BarrierStats;
+  /**
+   * per pass GPU and CPU timings over the recent frames.
+   */
+  auto frameStats() const -> FrameStats;
+  /**
+   * capture every presented frame into a ring of readback buffers and hand them to
+   * `config.callback` on a readback thread. Must be set before the first frame.
+   */
+  auto setFrameReadback(FrameReadbackConfig config) -> void;
+
 protected:
   auto onInit() -> void override;
 
@@ -23,5 +38,6 @@ private:
   std::map<std::string, std::unique_ptr<Scene>> scenes;
 
   std::unique_ptr<FrameGraph> frameGraph;
+  FrameReadbackConfig readbackConfig;
 };
 }
@@ -47,17 +47,17 @@ Scene::Scene(Renderer &renderer, SceneConfig sceneConfig, std::string name)
     0, *Dev.textures.back(), {reinterpret_cast<std::byte *>(&color), sizeof(color)});
   Dev.textures.back()->setSampler({});
 
+  // reserved so the span handed to the passes stays valid while textures are added.
   Dev.sampler2Ds.reserve(sceneConfig.maxNumTextures);
-  auto i = 0u;
-  for(; i < Dev.textures.size(); ++i)
-    Dev.sampler2Ds.emplace_back(
-      Dev.textures[i]->sampler(), Dev.textures[i]->imageView(),
-      Dev.textures[i]->layout());
-  // bind unused textures to empty texture;
-  for(; i < sceneConfig.maxNumTextures; ++i)
-    Dev.sampler2Ds.emplace_back(
-      Dev.textures[0]->sampler(), Dev.textures[0]->imageView(),
-      Dev.textures[0]->layout());
+  for(auto i = 0u; i < Dev.textures.size(); ++i)
+    setSampler2D(i);
+  // without partially bound descriptors every element of the texture arrays must be valid,
+  // so unused textures are bound to the empty texture.
+  if(!device.supported().descriptorIndexing)
+    for(auto i = uint32_t(Dev.textures.size()); i < sceneConfig.maxNumTextures; ++i)
+      Dev.sampler2Ds.emplace_back(
+        Dev.textures[0]->sampler(), Dev.textures[0]->imageView(),
+        Dev.textures[0]->layout());
 
   Dev.lastUsedSampler2DIndex = uint32_t(Dev.textures.size());
 
@@ -111,6 +111,13 @@ auto Scene::newMaterial(MaterialType type, bool perFrame) -> uint32_t {
   Host.materials.emplace_back(*this, id, type, perFrame ? featureConfig.numFrames : 1);
   return id;
 }
+auto Scene::setSampler2D(uint32_t index) -> void {
+  auto &tex = *Dev.textures[index];
+  vk::DescriptorImageInfo info{tex.sampler(), tex.imageView(), tex.layout()};
+  if(index < Dev.sampler2Ds.size()) Dev.sampler2Ds[index] = info;
+  else
+    Dev.sampler2Ds.push_back(info);
+}
 auto Scene::ensureTextures(uint32_t toAdd) const -> void {
   errorIf(
     Dev.textures.size() + toAdd > sceneConfig.maxNumTextures,
@@ -130,8 +137,7 @@ auto Scene::newTexture(
     sampler.maxAnisotropy = device.limits().maxSamplerAnisotropy;
   }
   tex->setSampler(sampler);
-  Dev.sampler2Ds[Dev.textures.size() - 1] = {
-    tex->sampler(), tex->imageView(), tex->layout()};
+  setSampler2D(uint32_t(Dev.textures.size() - 1));
   return uint32_t(Dev.textures.size() - 1);
 }
 
@@ -149,8 +155,7 @@ auto Scene::newTexture(
     sampler.maxAnisotropy = device.limits().maxSamplerAnisotropy;
   }
   tex->setSampler(sampler);
-  Dev.sampler2Ds[Dev.textures.size() - 1] = {
-    tex->sampler(), tex->imageView(), tex->layout()};
+  setSampler2D(uint32_t(Dev.textures.size() - 1));
   return uint32_t(Dev.textures.size() - 1);
 }
 
@@ -169,8 +174,7 @@ auto Scene::newTexture(
     sampler.maxAnisotropy = device.limits().maxSamplerAnisotropy;
   }
   tex->setSampler(sampler);
-  Dev.sampler2Ds[Dev.textures.size() - 1] = {
-    tex->sampler(), tex->imageView(), tex->layout()};
+  setSampler2D(uint32_t(Dev.textures.size() - 1));
   return uint32_t(Dev.textures.size() - 1);
 }
 auto Scene::newMesh(uint32_t primitive, uint32_t material) -> uint32_t {
@@ -226,6 +230,11 @@ auto Scene::lighting() -> Lighting & { return *Host.lighting; }
 
 auto Scene::atmosphere() -> AtmosphereSetting & { return Host.atmosphere; }
 auto Scene::shadowmap() -> ShadowMapSetting & { return Host.shadowMap; }
+auto Scene::dynamicResolution() -> DynamicResolutionSetting & {
+  return Host.dynamicResolution;
+}
+auto Scene::temporalAA() -> TemporalAASetting & { return Host.temporalAA; }
+auto Scene::cullStats() const -> const CullStats & { return Host.cullStats; }
 
 auto Scene::allocateLightingDesc() const -> Allocation<Lighting::Desc> {
   return Dev.lighting->allocate();
@@ -276,15 +285,21 @@ auto Scene::addToDrawGroup(uint32_t meshId, ShadeModel oldShadeModelID) -> Shade
   if(oldShadeModelID != ShadeModel::Unknown)
     Host.shadeModelCount[value(oldShadeModelID)]--;
   Host.shadeModelCount[value(smID)]++;
+  // an instance was added or its meshes changed, which may be static shadow casters.
+  Host.shadowMap.invalidateStaticCasters();
   return smID;
 }
 
 void Scene::setVisible(ShadeModel shadeModel, bool visible) {
   Host.shadeModelCount[value(shadeModel)] += visible ? 1 : -1;
+  Host.shadowMap.invalidateStaticCasters();
 }
 
 void Scene::scheduleFrameUpdate(
   Update::Type type, uint32_t id, uint32_t frames, uint32_t &ticket) {
+  // instances and primitives created per frame are dynamic casters, drawn every frame anyway.
+  if(frames == 1 && (type == Update::Type::Instance || type == Update::Type::Primitive))
+    Host.shadowMap.invalidateStaticCasters();
   auto size = uint32_t(Host.updates.size());
   if(ticket < size) Host.updates[ticket].frames = frames;
   else {
@@ -16,6 +16,9 @@
 #include "shade_model.hpp"
 #include "model/atmosphere.hpp"
 #include "model/shadow_map.hpp"
+#include "model/dynamic_resolution.hpp"
+#include "model/temporal_aa.hpp"
+#include "pass/cull/compute_cull_drawcmd.hpp"
 #include <span>
 
 namespace vkg {
@@ -26,6 +29,7 @@ struct ScenePassIn {
   FrameGraphResource<vk::Extent2D> swapchainExtent;
   FrameGraphResource<vk::Format> swapchainFormat;
   FrameGraphResource<uint64_t> swapchainVersion;
+  FrameGraphResource<double> gpuFrameTime;
 };
 struct ScenePassOut {
   FrameGraphResource<Texture *> backImg;
@@ -98,6 +102,10 @@ public:
   auto lighting() -> Lighting &;
   auto atmosphere() -> AtmosphereSetting &;
   auto shadowmap() -> ShadowMapSetting &;
+  auto dynamicResolution() -> DynamicResolutionSetting &;
+  auto temporalAA() -> TemporalAASetting &;
+  /** per shade model counts of the camera cull, a few frames behind. */
+  auto cullStats() const -> const CullStats &;
 
   auto allocateLightingDesc() const -> Allocation<Lighting::Desc>;
   auto allocateLightDesc() const -> Allocation<Light::Desc>;
@@ -119,6 +127,7 @@ public:
 
 private:
   auto ensureTextures(uint32_t toAdd) const -> void;
+  auto setSampler2D(uint32_t index) -> void;
 
   Device &device;
   const FeatureConfig &featureConfig;
@@ -160,6 +169,9 @@ private:
     std::unique_ptr<Camera> camera_;
     AtmosphereSetting atmosphere;
     ShadowMapSetting shadowMap;
+    DynamicResolutionSetting dynamicResolution;
+    TemporalAASetting temporalAA;
+    CullStats cullStats;
 
     std::vector<Update> updates;
   } Host;
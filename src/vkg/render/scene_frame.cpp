@@ -4,6 +4,11 @@
 #include "vkg/render/pass/raytracing/raytracing_setup.hpp"
 #include "vkg/render/pass/postprocess/tonemap_pass.hpp"
 #include "vkg/render/pass/postprocess/fxaa_pass.hpp"
+#include "vkg/render/pass/postprocess/upscale_pass.hpp"
+#include "vkg/render/pass/postprocess/taa_pass.hpp"
+#include "vkg/util/trace_recorder.hpp"
+#include <algorithm>
+#include <cmath>
 
 namespace vkg {
 
@@ -11,9 +16,12 @@ struct SceneSetupPassIn {
   FrameGraphResource<vk::Extent2D> swapchainExtent;
   FrameGraphResource<vk::Format> swapchainFormat;
   FrameGraphResource<uint64_t> swapchainVersion;
+  FrameGraphResource<double> gpuFrameTime;
 };
 struct SceneSetupPassOut {
   FrameGraphResource<Texture *> backImg;
+  /** part of `backImg` the scene is rendered to, scaled by the dynamic resolution. */
+  FrameGraphResource<vk::Extent2D> renderExtent;
   FrameGraphResource<SceneConfig> sceneConfig;
   FrameGraphResource<BufferInfo> positions;
   FrameGraphResource<BufferInfo> normals;
@@ -32,6 +40,8 @@ struct SceneSetupPassOut {
   FrameGraphResource<std::span<uint32_t>> maxPerShadeModel;
   FrameGraphResource<AtmosphereSetting> atmosphereSetting;
   FrameGraphResource<ShadowMapSetting> shadowMapSetting;
+  FrameGraphResource<DynamicResolutionSetting> dynamicResolution;
+  FrameGraphResource<TemporalAASetting> temporalAA;
 };
 
 class SceneSetupPass: public Pass<SceneSetupPassIn, SceneSetupPassOut> {
@@ -39,9 +49,11 @@ public:
   explicit SceneSetupPass(Scene &scene): scene(scene) {}
 
   void setup(PassBuilder &builder) override {
+    builder.compileSerially();
     builder.read(passIn);
     passOut = {
       .backImg = builder.create<Texture *>("backImg"),
+      .renderExtent = builder.create<vk::Extent2D>("renderExtent"),
       .sceneConfig = builder.create<SceneConfig>("sceneConfig"),
       .positions = builder.create<BufferInfo>("positions"),
       .normals = builder.create<BufferInfo>("normals"),
@@ -60,6 +72,8 @@ public:
       .maxPerShadeModel = builder.create<std::span<uint32_t>>("drawGroupCount"),
       .atmosphereSetting = builder.create<AtmosphereSetting>("atmosphere"),
       .shadowMapSetting = builder.create<ShadowMapSetting>("shadowMapSetting"),
+      .dynamicResolution = builder.create<DynamicResolutionSetting>("dynamicResolution"),
+      .temporalAA = builder.create<TemporalAASetting>("temporalAA"),
     };
   }
   void compile(RenderContext &ctx, Resources &resources) override {
@@ -77,8 +91,9 @@ public:
       resources.set(passOut.lighting, scene.Dev.lighting->bufferInfo());
       resources.set(passOut.lights, scene.Dev.lights->bufferInfo());
       resources.set(passOut.camera, scene.Host.camera_.get());
-      resources.set(passOut.samplers, {scene.Dev.sampler2Ds});
     }
+    // republished as textures are added; the passes only write the new ones to their sets.
+    resources.set(passOut.samplers, {scene.Dev.sampler2Ds});
     resources.set(passOut.numValidSampler, uint32_t(scene.Dev.textures.size()));
     resources.set(passOut.atmosphereSetting, scene.atmosphere());
     resources.set(passOut.shadowMapSetting, scene.shadowmap());
@@ -103,7 +118,32 @@ public:
       }
     }
 
+    // render targets keep the swapchain extent, only the render extent is rendered to.
+    auto renderExtent = extent;
+    auto &dynamicResolution = scene.Host.dynamicResolution;
+    if(dynamicResolution.isEnabled() && !scene.featureConfig.rayTrace) {
+      dynamicResolution.update(resources.get<double>(passIn.gpuFrameTime));
+      auto scale = dynamicResolution.scale();
+      renderExtent = {
+        std::clamp(uint32_t(std::lround(extent.width * scale)), 1u, extent.width),
+        std::clamp(uint32_t(std::lround(extent.height * scale)), 1u, extent.height)};
+    }
     scene.Host.camera_->resize(extent.width, extent.height);
+    scene.Host.camera_->setRenderExtent(renderExtent.width, renderExtent.height);
+    resources.set(passOut.renderExtent, renderExtent);
+    resources.set(passOut.dynamicResolution, dynamicResolution);
+
+    // the ray tracer has no TAA, so neither velocity nor jitter.
+    auto temporalAA = scene.Host.temporalAA;
+    if(scene.featureConfig.rayTrace) temporalAA.enable(false);
+    // a new sub pixel offset around the pixel center every frame, accumulated by the TAA.
+    glm::vec2 jitter{0};
+    if(temporalAA.isEnabled()) {
+      jitterIndex = jitterIndex % numJitterSamples + 1;
+      jitter = {halton(jitterIndex, 2) - 0.5f, halton(jitterIndex, 3) - 0.5f};
+    }
+    scene.Host.camera_->setJitter(jitter);
+    resources.set(passOut.temporalAA, temporalAA);
 
     if(!scene.Host.updates.empty()) {
       /**
@@ -125,6 +165,7 @@ public:
         return updatable;
       };
 
+      TraceScope trace("scene update", "scene");
       ctx.device.begin(ctx.cb, "scene update");
       auto &updates = scene.Host.updates;
       uint32_t i = 0;
@@ -156,8 +197,19 @@ public:
   }
 
 private:
+  static auto halton(uint32_t index, uint32_t base) -> float {
+    float f = 1, r = 0;
+    for(; index > 0; index /= base) {
+      f /= float(base);
+      r += f * float(index % base);
+    }
+    return r;
+  }
+
   Scene &scene;
   bool boundPassData{false};
+  static constexpr uint32_t numJitterSamples = 8;
+  uint32_t jitterIndex{0};
   std::vector<Texture *> backImgs;
 };
 
@@ -166,15 +218,18 @@ void Scene::setup(PassBuilder &builder) {
     builder
       .newPass<SceneSetupPass>(
         "SceneSetup",
-        {passIn.swapchainExtent, passIn.swapchainFormat, passIn.swapchainVersion}, *this)
+        {passIn.swapchainExtent, passIn.swapchainFormat, passIn.swapchainVersion,
+         passIn.gpuFrameTime},
+        *this)
       .out();
 
   auto &transf = builder.newPass<ComputeTransf>(
     "Transf", {sceneSetupOut.transforms, sceneSetupOut.meshInstances,
-               sceneSetupOut.meshInstancesCount, sceneSetupOut.sceneConfig});
+               sceneSetupOut.meshInstancesCount, sceneSetupOut.sceneConfig,
+               sceneSetupOut.temporalAA});
 
-  auto &atmosphere =
-    builder.newPass<AtmospherePass>("Atmosphere", {sceneSetupOut.atmosphereSetting});
+  auto &atmosphere = builder.newPass<AtmospherePass>(
+    "Atmosphere", {sceneSetupOut.atmosphereSetting}, featureConfig.atmosphereCacheDir);
 
   FrameGraphResource<Texture *> backImg;
   if(featureConfig.rayTrace) {
@@ -222,6 +277,7 @@ void Scene::setup(PassBuilder &builder) {
 
     auto &deferred = builder.newPass<DeferredSetupPass>(
       "Deferred", {sceneSetupOut.backImg,
+                   sceneSetupOut.renderExtent,
                    sceneSetupOut.camera,
                    sceneSetupOut.sceneConfig,
                    sceneSetupOut.meshInstances,
@@ -232,6 +288,8 @@ void Scene::setup(PassBuilder &builder) {
                    sceneSetupOut.indices,
                    sceneSetupOut.primitives,
                    transf.out().matrices,
+                   transf.out().prevMatrices,
+                   sceneSetupOut.temporalAA,
                    sceneSetupOut.materials,
                    sceneSetupOut.samplers,
                    sceneSetupOut.numValidSampler,
@@ -241,12 +299,28 @@ void Scene::setup(PassBuilder &builder) {
                    sceneSetupOut.atmosphereSetting,
                    atmosphere.out(),
                    sceneSetupOut.shadowMapSetting,
-                   shadowMap.out()});
+                   shadowMap.out()},
+      Host.cullStats);
 
-    backImg = deferred.out().backImg;
+    auto taa = builder
+                 .newPass<TemporalAAPass>(
+                   "TemporalAA", {deferred.out().backImg, deferred.out().depth,
+                                  deferred.out().velocity, sceneSetupOut.camera,
+                                  sceneSetupOut.renderExtent, sceneSetupOut.temporalAA})
+                 .out();
+
+    backImg = builder
+                .newPass<UpscalePass>(
+                  "Upscale",
+                  {taa.img, sceneSetupOut.renderExtent, sceneSetupOut.dynamicResolution})
+                .out()
+                .img;
   }
   auto tonemap = builder.newPass<ToneMapPass>("ToneMap", {backImg}).out();
-  auto fxaa = builder.newPass<FxaaPass>("FXAA", {tonemap.img}).out();
+  auto taaEnabled = [&]() {
+    return !featureConfig.rayTrace && Host.temporalAA.isEnabled();
+  };
+  auto fxaa = builder.newPass<FxaaPass>("FXAA", {tonemap.img}, taaEnabled).out();
   auto &last = fxaa;
 
   builder.read(passIn.swapchainExtent);
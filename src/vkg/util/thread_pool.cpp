@@ -0,0 +1,71 @@
+#include "thread_pool.hpp"
+
+namespace vkg {
+ThreadPool::ThreadPool(uint32_t numThreads) {
+    for(auto i = 1u; i < numThreads; ++i)
+        workers.emplace_back([this, i]() { work(i); });
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(mutex);
+        stop = true;
+    }
+    wakeUp.notify_all();
+    for(auto &worker: workers)
+        worker.join();
+}
+
+auto ThreadPool::numThreads() const -> uint32_t { return uint32_t(workers.size() + 1); }
+
+auto ThreadPool::run(uint32_t thread) -> void {
+    for(auto i = next_++; i < count_; i = next_++)
+        try {
+            (*task_)(i, thread);
+        } catch(...) {
+            std::lock_guard lock(mutex);
+            if(!exception) exception = std::current_exception();
+        }
+}
+
+auto ThreadPool::work(uint32_t thread) -> void {
+    uint64_t seen{0};
+    while(true) {
+        {
+            std::unique_lock lock(mutex);
+            wakeUp.wait(lock, [&]() { return stop || generation != seen; });
+            if(stop) return;
+            seen = generation;
+        }
+        run(thread);
+        {
+            std::lock_guard lock(mutex);
+            --busy;
+        }
+        finished.notify_one();
+    }
+}
+
+auto ThreadPool::parallelFor(uint32_t count, const Task &task) -> void {
+    if(count == 0) return;
+    if(workers.empty() || count == 1) {
+        for(auto i = 0u; i < count; ++i)
+            task(i, 0);
+        return;
+    }
+    {
+        std::lock_guard lock(mutex);
+        task_ = &task;
+        count_ = count;
+        next_ = 0;
+        busy = uint32_t(workers.size());
+        exception = nullptr;
+        ++generation;
+    }
+    wakeUp.notify_all();
+    run(0);
+    std::unique_lock lock(mutex);
+    finished.wait(lock, [&]() { return busy == 0; });
+    if(exception) std::rethrow_exception(exception);
+}
+}
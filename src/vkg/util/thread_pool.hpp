@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vkg {
+/**
+ * Fixed set of worker threads that run the tasks of one `parallelFor` at a time. The calling thread
+ * takes part as thread 0.
+ */
+class ThreadPool {
+public:
+    using Task = std::function<void(uint32_t task, uint32_t thread)>;
+
+    explicit ThreadPool(uint32_t numThreads);
+    ~ThreadPool();
+
+    auto numThreads() const -> uint32_t;
+    /**
+     * run task 0..count-1 and return when all of them are finished. Exceptions thrown by tasks are
+     * rethrown here.
+     */
+    auto parallelFor(uint32_t count, const Task &task) -> void;
+
+private:
+    auto work(uint32_t thread) -> void;
+    auto run(uint32_t thread) -> void;
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wakeUp, finished;
+
+    const Task *task_{nullptr};
+    uint32_t count_{0};
+    std::atomic<uint32_t> next_{0};
+    uint32_t busy{0};
+    uint64_t generation{0};
+    bool stop{false};
+    std::exception_ptr exception;
+};
+}
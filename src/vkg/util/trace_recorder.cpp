@@ -0,0 +1,105 @@
+#include "trace_recorder.hpp"
+#include <chrono>
+#include <fstream>
+#include <algorithm>
+#include "syntactic_sugar.hpp"
+
+namespace vkg {
+namespace {
+auto threadId() -> uint32_t {
+    static std::atomic<uint32_t> next{0};
+    thread_local uint32_t id = next++;
+    return id;
+}
+
+auto escape(const std::string &str) -> std::string {
+    std::string escaped;
+    for(auto c: str) {
+        if(c == '"' || c == '\\') escaped += '\\';
+        if(uint8_t(c) < 0x20) continue;
+        escaped += c;
+    }
+    return escaped;
+}
+}
+
+auto TraceRecorder::instance() -> TraceRecorder & {
+    static TraceRecorder recorder;
+    return recorder;
+}
+
+auto TraceRecorder::now() -> uint64_t {
+    return uint64_t(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+auto TraceRecorder::start(const std::string &path_, uint32_t numFrames) -> void {
+    std::lock_guard lock(mutex);
+    path = path_;
+    framesLeft = numFrames;
+    events.clear();
+    recording_ = true;
+}
+
+auto TraceRecorder::stop() -> void {
+    std::lock_guard lock(mutex);
+    if(!recording_) return;
+    recording_ = false;
+    write();
+}
+
+auto TraceRecorder::recording() const -> bool { return recording_.load(std::memory_order_relaxed); }
+
+auto TraceRecorder::endFrame() -> void {
+    if(!recording()) return;
+    std::lock_guard lock(mutex);
+    if(framesLeft == 0 || --framesLeft > 0) return;
+    recording_ = false;
+    write();
+}
+
+auto TraceRecorder::span(const std::string &name, const char *category, uint64_t beginNs, uint64_t endNs)
+    -> void {
+    span(name, category, beginNs, endNs, kCPU, threadId());
+}
+
+auto TraceRecorder::span(
+    const std::string &name, const char *category, uint64_t beginNs, uint64_t endNs, uint32_t pid, uint32_t tid)
+    -> void {
+    if(!recording()) return;
+    std::lock_guard lock(mutex);
+    events.push_back({name, category, beginNs, endNs, pid, tid});
+}
+
+auto TraceRecorder::write() -> void {
+    std::ofstream file(path);
+    if(!file) {
+        debugLog("failed to write trace to ", path);
+        return;
+    }
+    uint64_t base = ~0ull;
+    for(auto &e: events)
+        base = std::min(base, e.begin);
+    file << R"({"displayTimeUnit":"ms","traceEvents":[)";
+    file << R"({"name":"process_name","ph":"M","pid":)" << kCPU << R"(,"args":{"name":"CPU"}},)";
+    file << R"({"name":"process_name","ph":"M","pid":)" << kGPU << R"(,"args":{"name":"GPU"}})";
+    for(auto &e: events) {
+        file << R"(,{"name":")" << escape(e.name) << R"(","cat":")" << e.category << R"(","ph":"X","ts":)"
+             << double(e.begin - base) / 1e3 << R"(,"dur":)" << double(e.end - e.begin) / 1e3 << R"(,"pid":)" << e.pid
+             << R"(,"tid":)" << e.tid << "}";
+    }
+    file << "]}\n";
+    debugLog("trace with ", events.size(), " spans written to ", path);
+    events.clear();
+}
+
+TraceScope::TraceScope(const char *name, const char *category): name{name}, category{category} {
+    if(TraceRecorder::instance().recording()) begin = TraceRecorder::now();
+}
+TraceScope::~TraceScope() {
+    if(begin == 0) return;
+    auto &recorder = TraceRecorder::instance();
+    recorder.span(name, category, begin, TraceRecorder::now());
+}
+}
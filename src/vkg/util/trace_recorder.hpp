@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace vkg {
+/**
+ * Records spans in the Chrome trace event format, which can be opened in chrome://tracing or
+ * ui.perfetto.dev. Nothing is recorded until `start`; the file is written by `stop`.
+ */
+class TraceRecorder {
+public:
+    /** process id of the spans recorded on the CPU. */
+    static const uint32_t kCPU{0};
+    /** process id of the spans recorded on the GPU, the thread id is the queue. */
+    static const uint32_t kGPU{1};
+
+    static auto instance() -> TraceRecorder &;
+    /** steady clock in nanoseconds, the time base of all spans. */
+    static auto now() -> uint64_t;
+
+    /**
+     * @param numFrames stop and write the file automatically after this many frames, 0 means until `stop`.
+     */
+    auto start(const std::string &path, uint32_t numFrames = 0) -> void;
+    auto stop() -> void;
+    auto recording() const -> bool;
+    auto endFrame() -> void;
+
+    /** record a span on the calling thread. */
+    auto span(const std::string &name, const char *category, uint64_t beginNs, uint64_t endNs) -> void;
+    auto span(
+        const std::string &name, const char *category, uint64_t beginNs, uint64_t endNs, uint32_t pid, uint32_t tid)
+        -> void;
+
+private:
+    auto write() -> void;
+
+    struct Event {
+        std::string name;
+        const char *category;
+        uint64_t begin, end;
+        uint32_t pid, tid;
+    };
+
+    std::atomic<bool> recording_{false};
+    std::mutex mutex;
+    std::string path;
+    uint32_t framesLeft{0};
+    std::vector<Event> events;
+};
+
+/**
+ * Records a CPU span from construction to destruction if a trace is being recorded.
+ */
+class TraceScope {
+public:
+    TraceScope(const char *name, const char *category);
+    ~TraceScope();
+
+private:
+    const char *name;
+    const char *category;
+    uint64_t begin{0};
+};
+}